@@ -21,6 +21,7 @@
 #include <asm/cache.h>
 #include <asm/armv7.h>
 #include <linux/compiler.h>
+#include <worker.h>
 
 void __weak cpu_cache_initialization(void){}
 
@@ -36,6 +37,8 @@ int cleanup_before_linux(void)
 	disable_interrupts();
 #endif
 
+	worker_stop();
+
 	/*
 	 * Turn off I-cache and invalidate it
 	 */
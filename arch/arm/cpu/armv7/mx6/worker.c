@@ -0,0 +1,177 @@
+/*
+ * Worker cores on i.MX6: release cores 1-3 from the SRC into
+ * worker_entry, each with its own stack and, when core 0 runs with the
+ * MMU and D-cache on, sharing core 0's page table inside the SCU
+ * coherency domain.
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+#include <common.h>
+#include <worker.h>
+#include <asm/errno.h>
+#include <asm/io.h>
+#include <asm/system.h>
+#include <asm/arch/imx-regs.h>
+#include <asm/arch/sys_proto.h>
+#include <linux/sizes.h>
+
+DECLARE_GLOBAL_DATA_PTR;
+
+#ifndef CONFIG_SYS_WORKER_STACK_SIZE
+#define CONFIG_SYS_WORKER_STACK_SIZE	SZ_16K
+#endif
+
+#define MAX_CPUS	4
+
+/* Read by worker_entry with the caches still off, see worker_entry.S */
+struct worker_boot {
+	u32 stack[MAX_CPUS];
+	u32 gd;
+	u32 ttbr;		/* 0 when core 0 runs without D-cache */
+	u32 entry;
+	volatile u32 parked[MAX_CPUS];
+} __aligned(ARCH_DMA_MINALIGN);
+
+struct worker_boot worker_boot;
+
+static u8 worker_stacks[MAX_CPUS - 1][CONFIG_SYS_WORKER_STACK_SIZE]
+	__aligned(16);
+
+static struct src *const src = (struct src *)SRC_BASE_ADDR;
+
+static const u32 cpu_reset_mask[MAX_CPUS] = {
+	0,
+	SRC_SCR_CORE_1_RESET_MASK,
+	SRC_SCR_CORE_2_RESET_MASK,
+	SRC_SCR_CORE_3_RESET_MASK
+};
+
+static const u32 cpu_ctrl_mask[MAX_CPUS] = {
+	0,
+	SRC_SCR_CORE_1_ENABLE_MASK,
+	SRC_SCR_CORE_2_ENABLE_MASK,
+	SRC_SCR_CORE_3_ENABLE_MASK
+};
+
+void worker_entry(void);
+
+static void worker_boot_flush(void)
+{
+	flush_dcache_range((ulong)&worker_boot,
+			   (ulong)&worker_boot +
+			   roundup(sizeof(worker_boot), ARCH_DMA_MINALIGN));
+}
+
+/* Called from worker_entry on the secondary core */
+void worker_secondary_main(int cpu)
+{
+	u32 reg;
+
+	((void (*)(int))worker_boot.entry)(cpu);
+
+	/* Hand back any dirty lines before the core is switched off */
+	if (worker_boot.ttbr) {
+		flush_dcache_all();
+		reg = get_cr();
+		set_cr(reg & ~(CR_C | CR_M));
+		asm volatile("mrc p15, 0, %0, c1, c0, 1" : "=r" (reg));
+		reg &= ~0x41;
+		asm volatile("mcr p15, 0, %0, c1, c0, 1" : : "r" (reg));
+	}
+
+	worker_boot.parked[cpu] = 1;
+	for (;;)
+		asm volatile("dsb\n"
+			     "wfi\n" : : : "memory");
+}
+
+/* Shareable bit of a first level section descriptor */
+#define TTB_SECT_S_MASK		(1 << 16)
+
+/*
+ * Core 0 has to join the SCU coherency domain too, and the SCU only
+ * keeps shareable memory coherent. The SMP bit may only be changed with
+ * the D-cache off, and re-enabling the D-cache rebuilds the page table,
+ * so DRAM is switched to shareable afterwards.
+ */
+static void worker_smp_enable(void)
+{
+	u32 actlr, scu_ctrl;
+	int i;
+
+	scu_ctrl = readl(SCU_BASE_ADDR);
+	if (!(scu_ctrl & 1))
+		writel(scu_ctrl | 1, SCU_BASE_ADDR);
+
+	if (!dcache_status())
+		return;
+
+	dcache_disable();
+	asm volatile("mrc p15, 0, %0, c1, c0, 1" : "=r" (actlr));
+	actlr |= 0x41;
+	asm volatile("mcr p15, 0, %0, c1, c0, 1" : : "r" (actlr));
+	dcache_enable();
+
+	for (i = 0; i < CONFIG_NR_DRAM_BANKS; i++)
+		mmu_set_region_dcache_behaviour(gd->bd->bi_dram[i].start,
+						gd->bd->bi_dram[i].size,
+						DCACHE_WRITEBACK |
+						TTB_SECT_S_MASK);
+	/* Lines allocated before the switch carry the old attributes */
+	flush_dcache_all();
+}
+
+int arch_worker_start(int cpu, void (*entry)(int cpu))
+{
+	u32 *jump = &src->gpr1 + cpu * 2;
+
+	/* get_nr_cpus() is the core count minus one */
+	if (cpu >= MAX_CPUS || cpu > get_nr_cpus())
+		return -ENODEV;
+
+	BUILD_BUG_ON(offsetof(struct worker_boot, gd) != 16);
+	BUILD_BUG_ON(offsetof(struct worker_boot, ttbr) != 20);
+
+	if (cpu == 1)
+		worker_smp_enable();
+
+	worker_boot.stack[cpu] = (u32)worker_stacks[cpu - 1] +
+				 CONFIG_SYS_WORKER_STACK_SIZE;
+	worker_boot.gd = (u32)gd;
+	worker_boot.ttbr = dcache_status() ? gd->arch.tlb_addr : 0;
+	worker_boot.entry = (u32)entry;
+	worker_boot.parked[cpu] = 0;
+	worker_boot_flush();
+
+	writel((u32)worker_entry, jump);
+	setbits_le32(&src->scr, cpu_reset_mask[cpu] | cpu_ctrl_mask[cpu]);
+
+	return 0;
+}
+
+void arch_worker_stop(int cpu)
+{
+	ulong start = get_timer(0);
+
+	/* Give the core a chance to clean its cache first */
+	while (!worker_boot.parked[cpu] && get_timer(start) < 10)
+		invalidate_dcache_range((ulong)&worker_boot,
+					(ulong)&worker_boot +
+					roundup(sizeof(worker_boot),
+						ARCH_DMA_MINALIGN));
+
+	clrbits_le32(&src->scr, cpu_ctrl_mask[cpu]);
+	writel(0, &src->gpr1 + cpu * 2);
+}
+
+void arch_worker_idle(void)
+{
+	asm volatile("wfe" : : : "memory");
+}
+
+void arch_worker_kick(void)
+{
+	asm volatile("dsb\n"
+		     "sev\n" : : : "memory");
+}
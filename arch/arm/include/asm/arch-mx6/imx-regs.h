@@ -522,8 +522,11 @@ struct cspi_regs {
 #define MXC_CSPICTRL_MAXBITS	0xfff
 #define MXC_CSPICTRL_TC		(1 << 7)
 #define MXC_CSPICTRL_RXOVF	(1 << 6)
+#define MXC_CSPISTAT_RR		(1 << 3)
 #define MXC_CSPIPERIOD_32KHZ	(1 << 15)
 #define MAX_SPI_BYTES	32
+#define MXC_CSPI_FIFO_WORDS	64
+#define MAX_SPI_BURST_BYTES	512	/* burst length is 12 bits */
 #define SPI_MAX_NUM	4
 
 /* Bit position inside CTRL register to be associated with SS */
@@ -0,0 +1,20 @@
+/*
+ * SHA-1 and SHA-256 blocks with the ARMv7 NEON unit, the backends that
+ * lib/sha1.c and lib/sha256.c list first when CONFIG_ARMV7_NEON is set
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+#ifndef __ASM_ARM_SHA_NEON_H
+#define __ASM_ARM_SHA_NEON_H
+
+/* Non-zero if NEON is enabled on this core, see cpu_init_cp15 */
+int sha_neon_usable(void);
+
+/* @data need not be aligned, @blocks is at least 1 */
+void sha1_neon_blocks(uint32_t state[5], const unsigned char *data,
+		      unsigned int blocks);
+void sha256_neon_blocks(uint32_t state[8], const uint8_t *data,
+			unsigned int blocks);
+
+#endif /* __ASM_ARM_SHA_NEON_H */
@@ -6,6 +6,7 @@
 #include <common.h>
 #include <dm/root.h>
 #include <os.h>
+#include <worker.h>
 #include <asm/state.h>
 
 DECLARE_GLOBAL_DATA_PTR;
@@ -40,6 +41,18 @@ unsigned long __attribute__((no_instrument_function)) timer_get_us(void)
 	return os_get_nsec() / 1000;
 }
 
+/* bootstage times in microseconds, not the generic milliseconds * 1000 */
+ulong timer_get_boot_us(void)
+{
+	static uint64_t base_ns;
+	uint64_t now = os_get_nsec();
+
+	if (!base_ns)
+		base_ns = now;
+
+	return (now - base_ns) / 1000;
+}
+
 int do_bootm_linux(int flag, int argc, char *argv[], bootm_headers_t *images)
 {
 	if (flag & (BOOTM_STATE_OS_GO | BOOTM_STATE_OS_FAKE_GO)) {
@@ -54,9 +67,32 @@ int do_bootm_linux(int flag, int argc, char *argv[], bootm_headers_t *images)
 
 int cleanup_before_linux(void)
 {
+	worker_stop();
+
 	return 0;
 }
 
+#ifdef CONFIG_WORKER
+/* Worker cores are host threads */
+int arch_worker_start(int cpu, void (*entry)(int cpu))
+{
+	return os_thread_start(entry, cpu);
+}
+
+void arch_worker_stop(int cpu)
+{
+}
+
+void arch_worker_idle(void)
+{
+	os_thread_yield();
+}
+
+void arch_worker_kick(void)
+{
+}
+#endif
+
 void *map_physmem(phys_addr_t paddr, unsigned long len, unsigned long flags)
 {
 	return (void *)(gd->arch.ram_buf + paddr);
@@ -7,6 +7,8 @@
 #include <errno.h>
 #include <fcntl.h>
 #include <getopt.h>
+#include <pthread.h>
+#include <sched.h>
 #include <stdio.h>
 #include <stdint.h>
 #include <stdlib.h>
@@ -184,6 +186,49 @@ void os_usleep(unsigned long usec)
 	usleep(usec);
 }
 
+#define OS_MAX_THREADS	8
+
+struct os_thread {
+	pthread_t tid;
+	void (*fn)(int arg);
+	int arg;
+};
+
+static struct os_thread os_threads[OS_MAX_THREADS];
+static int os_thread_count;
+
+static void *os_thread_main(void *data)
+{
+	struct os_thread *thread = data;
+
+	thread->fn(thread->arg);
+
+	return NULL;
+}
+
+int os_thread_start(void (*fn)(int arg), int arg)
+{
+	struct os_thread *thread;
+
+	if (os_thread_count == OS_MAX_THREADS)
+		return -1;
+
+	thread = &os_threads[os_thread_count];
+	thread->fn = fn;
+	thread->arg = arg;
+	if (pthread_create(&thread->tid, NULL, os_thread_main, thread))
+		return -1;
+	pthread_detach(thread->tid);
+	os_thread_count++;
+
+	return 0;
+}
+
+void os_thread_yield(void)
+{
+	sched_yield();
+}
+
 uint64_t __attribute__((no_instrument_function)) os_get_nsec(void)
 {
 #if defined(CLOCK_MONOTONIC) && defined(_POSIX_MONOTONIC_CLOCK)
@@ -41,36 +41,111 @@
 #include <part.h>
 #include <sparse_format.h>
 
-void write_sparse_image(block_dev_desc_t *dev_desc,
-		disk_partition_t *info, const char *part_name,
-		void *data, unsigned sz)
+/*
+ * Output data is gathered in a staging buffer of this size and written
+ * in one go. It has to hold at least one block of the target device.
+ */
+#ifndef CONFIG_FASTBOOT_SPARSE_BUF_SIZE
+#define CONFIG_FASTBOOT_SPARSE_BUF_SIZE	(1024 * 1024)
+#endif
+
+enum {
+	SPARSE_FILE_HDR,	/* collecting the file header */
+	SPARSE_CHUNK_HDR,	/* collecting a chunk header */
+	SPARSE_RAW,		/* copying the data of a raw chunk */
+	SPARSE_FILL,		/* collecting the value of a fill chunk */
+	SPARSE_IMAGE,		/* not a sparse image, copying everything */
+	SPARSE_DONE,		/* all chunks seen */
+	SPARSE_ERROR,
+};
+
+static int sparse_fail(struct sparse_stream *ss, const char *s)
 {
-	lbaint_t blk;
-	lbaint_t blkcnt;
+	ss->state = SPARSE_ERROR;
+	fastboot_fail(s);
+	return -1;
+}
+
+/* Fail unless @blkcnt more blocks fit behind the written and staged data */
+static int sparse_check_room(struct sparse_stream *ss, lbaint_t blkcnt)
+{
+	lbaint_t blk = ss->blk + ss->buf_len / ss->info.blksz;
+
+	if (blk + blkcnt > ss->info.start + ss->info.size) {
+		printf("%s: Request would exceed partition size!\n", __func__);
+		return sparse_fail(ss, "Request would exceed partition size!");
+	}
+
+	return 0;
+}
+
+/* Write out the whole blocks in the staging buffer */
+static int sparse_flush(struct sparse_stream *ss)
+{
+	lbaint_t blkcnt = ss->buf_len / ss->info.blksz;
 	lbaint_t blks;
-	uint32_t bytes_written = 0;
-	unsigned int chunk;
-	unsigned int chunk_data_sz;
-	uint32_t *fill_buf = NULL;
-	uint32_t fill_val;
-	sparse_header_t *sparse_header;
-	chunk_header_t *chunk_header;
-	uint32_t total_blocks = 0;
-	int i;
-
-	/* Read and skip over sparse image header */
-	sparse_header = (sparse_header_t *) data;
-
-	data += sparse_header->file_hdr_sz;
-	if (sparse_header->file_hdr_sz > sizeof(sparse_header_t))
-	{
-		/*
-		 * Skip the remaining bytes in a header that is longer than
-		 * we expected.
-		 */
-		data += (sparse_header->file_hdr_sz - sizeof(sparse_header_t));
+
+	if (!blkcnt)
+		return 0;
+
+	if (sparse_check_room(ss, 0))
+		return -1;
+
+	blks = ss->dev_desc->block_write(ss->dev_desc->dev, ss->blk, blkcnt,
+					 ss->buf);
+	if (blks != blkcnt) {
+		printf("%s: Write failed " LBAFU "\n", __func__, blks);
+		return sparse_fail(ss, "flash write failure");
+	}
+
+	ss->blk += blkcnt;
+	ss->bytes_written += blkcnt * ss->info.blksz;
+	ss->buf_len = 0;
+
+	return 0;
+}
+
+static int sparse_stage(struct sparse_stream *ss, const u8 *data,
+			unsigned int len)
+{
+	unsigned int n;
+
+	while (len) {
+		n = min(len, ss->buf_size - ss->buf_len);
+		memcpy(ss->buf + ss->buf_len, data, n);
+		ss->buf_len += n;
+		ss->fill_len = 0;
+		data += n;
+		len -= n;
+
+		if (ss->buf_len == ss->buf_size && sparse_flush(ss))
+			return -1;
+	}
+
+	return 0;
+}
+
+static void sparse_next_chunk(struct sparse_stream *ss)
+{
+	ss->chunk++;
+	if (ss->chunk == ss->sparse_header.total_chunks)
+		ss->state = SPARSE_DONE;
+	else
+		ss->state = SPARSE_CHUNK_HDR;
+}
+
+static int sparse_file_hdr(struct sparse_stream *ss)
+{
+	sparse_header_t *sparse_header = &ss->sparse_header;
+
+	if (!is_sparse_image(ss->hdr)) {
+		puts("Flashing Raw Image\n");
+		ss->state = SPARSE_IMAGE;
+		return sparse_stage(ss, ss->hdr, sizeof(sparse_header_t));
 	}
 
+	memcpy(sparse_header, ss->hdr, sizeof(sparse_header_t));
+
 	debug("=== Sparse Image Header ===\n");
 	debug("magic: 0x%x\n", sparse_header->magic);
 	debug("major_version: 0x%x\n", sparse_header->major_version);
@@ -81,163 +156,351 @@ void write_sparse_image(block_dev_desc_t *dev_desc,
 	debug("total_blks: %d\n", sparse_header->total_blks);
 	debug("total_chunks: %d\n", sparse_header->total_chunks);
 
+	if (sparse_header->file_hdr_sz < sizeof(sparse_header_t) ||
+	    sparse_header->chunk_hdr_sz < sizeof(chunk_header_t))
+		return sparse_fail(ss, "Bogus sparse image header");
+
 	/* verify sparse_header->blk_sz is an exact multiple of info->blksz */
-	if (sparse_header->blk_sz !=
-	    (sparse_header->blk_sz & ~(info->blksz - 1))) {
+	if (!sparse_header->blk_sz ||
+	    sparse_header->blk_sz !=
+	    (sparse_header->blk_sz & ~(ss->info.blksz - 1))) {
 		printf("%s: Sparse image block size issue [%u]\n",
 		       __func__, sparse_header->blk_sz);
-		fastboot_fail("sparse image block size issue");
-		return;
+		return sparse_fail(ss, "sparse image block size issue");
 	}
 
 	puts("Flashing Sparse Image\n");
 
-	/* Start processing chunks */
-	blk = info->start;
-	for (chunk=0; chunk<sparse_header->total_chunks; chunk++)
-	{
-		/* Read and skip over chunk header */
-		chunk_header = (chunk_header_t *) data;
-		data += sizeof(chunk_header_t);
-
-		if (chunk_header->chunk_type != CHUNK_TYPE_RAW) {
-			debug("=== Chunk Header ===\n");
-			debug("chunk_type: 0x%x\n", chunk_header->chunk_type);
-			debug("chunk_data_sz: 0x%x\n", chunk_header->chunk_sz);
-			debug("total_size: 0x%x\n", chunk_header->total_sz);
+	/* Skip the remaining bytes of a header longer than we expected */
+	ss->skip = sparse_header->file_hdr_sz - sizeof(sparse_header_t);
+	if (sparse_header->total_chunks)
+		ss->state = SPARSE_CHUNK_HDR;
+	else
+		ss->state = SPARSE_DONE;
+
+	return 0;
+}
+
+static int sparse_chunk_hdr(struct sparse_stream *ss)
+{
+	sparse_header_t *sparse_header = &ss->sparse_header;
+	chunk_header_t *chunk_header = &ss->chunk_header;
+	u64 chunk_data_sz;
+	lbaint_t blkcnt;
+
+	memcpy(chunk_header, ss->hdr, sizeof(chunk_header_t));
+
+	if (chunk_header->chunk_type != CHUNK_TYPE_RAW) {
+		debug("=== Chunk Header ===\n");
+		debug("chunk_type: 0x%x\n", chunk_header->chunk_type);
+		debug("chunk_data_sz: 0x%x\n", chunk_header->chunk_sz);
+		debug("total_size: 0x%x\n", chunk_header->total_sz);
+	}
+
+	if (chunk_header->total_sz < sparse_header->chunk_hdr_sz)
+		return sparse_fail(ss, "Bogus chunk size");
+
+	/* Skip the remaining bytes of a header longer than we expected */
+	ss->skip = sparse_header->chunk_hdr_sz - sizeof(chunk_header_t);
+
+	chunk_data_sz = (u64)sparse_header->blk_sz * chunk_header->chunk_sz;
+	blkcnt = chunk_data_sz / ss->info.blksz;
+
+	switch (chunk_header->chunk_type) {
+	case CHUNK_TYPE_RAW:
+		if (chunk_header->total_sz !=
+		    sparse_header->chunk_hdr_sz + chunk_data_sz)
+			return sparse_fail(ss,
+					   "Bogus chunk size for chunk type Raw");
+		if (sparse_check_room(ss, blkcnt))
+			return -1;
+
+		ss->remaining = chunk_data_sz;
+		ss->total_blocks += chunk_header->chunk_sz;
+		if (ss->remaining)
+			ss->state = SPARSE_RAW;
+		else
+			sparse_next_chunk(ss);
+		break;
+
+	case CHUNK_TYPE_FILL:
+		if (chunk_header->total_sz !=
+		    sparse_header->chunk_hdr_sz + sizeof(uint32_t))
+			return sparse_fail(ss,
+					   "Bogus chunk size for chunk type FILL");
+		if (sparse_check_room(ss, blkcnt))
+			return -1;
+
+		ss->state = SPARSE_FILL;
+		break;
+
+	case CHUNK_TYPE_DONT_CARE:
+		if (sparse_check_room(ss, blkcnt) || sparse_flush(ss))
+			return -1;
+
+		ss->blk += blkcnt;
+		ss->total_blocks += chunk_header->chunk_sz;
+		ss->skip += chunk_header->total_sz - sparse_header->chunk_hdr_sz;
+		sparse_next_chunk(ss);
+		break;
+
+	case CHUNK_TYPE_CRC32:
+		/* The checksum itself is not verified */
+		ss->total_blocks += chunk_header->chunk_sz;
+		ss->skip += chunk_header->total_sz - sparse_header->chunk_hdr_sz;
+		sparse_next_chunk(ss);
+		break;
+
+	default:
+		printf("%s: Unknown chunk type: %x\n", __func__,
+		       chunk_header->chunk_type);
+		return sparse_fail(ss, "Unknown chunk type");
+	}
+
+	return 0;
+}
+
+static int sparse_fill(struct sparse_stream *ss, uint32_t fill_val)
+{
+	block_dev_desc_t *dev_desc = ss->dev_desc;
+	lbaint_t blkcnt, blks, n;
+	uint32_t *fill_buf = ss->buf;
+	unsigned int i, len;
+
+	if (sparse_flush(ss))
+		return -1;
+
+	blkcnt = (u64)ss->sparse_header.blk_sz * ss->chunk_header.chunk_sz /
+		 ss->info.blksz;
+
+	/* Let the device zero the blocks itself if it can */
+	if (!fill_val && dev_desc->block_zero &&
+	    dev_desc->block_zero(dev_desc->dev, ss->blk, blkcnt) == blkcnt) {
+		debug("%s: zeroed " LBAFU " blocks at " LBAFU "\n", __func__,
+		      blkcnt, ss->blk);
+		ss->blk += blkcnt;
+		ss->bytes_written += (u64)blkcnt * ss->info.blksz;
+		goto done;
+	}
+
+	/*
+	 * The staging buffer is empty now. Fill it with the pattern, unless
+	 * an earlier fill chunk left the same pattern there.
+	 */
+	n = min(blkcnt, (lbaint_t)(ss->buf_size / ss->info.blksz));
+	len = n * ss->info.blksz;
+	if (ss->fill_val != fill_val)
+		ss->fill_len = 0;
+	for (i = ss->fill_len / sizeof(fill_val);
+	     i < len / sizeof(fill_val); i++)
+		fill_buf[i] = fill_val;
+	ss->fill_val = fill_val;
+	ss->fill_len = max(ss->fill_len, len);
+
+	while (blkcnt) {
+		n = min(blkcnt, (lbaint_t)(ss->buf_size / ss->info.blksz));
+		blks = dev_desc->block_write(dev_desc->dev, ss->blk, n,
+					     fill_buf);
+		if (blks != n) {
+			printf("%s: Write failed, block # " LBAFU "\n",
+			       __func__, ss->blk);
+			return sparse_fail(ss, "flash write failure");
 		}
+		ss->blk += n;
+		ss->bytes_written += n * ss->info.blksz;
+		blkcnt -= n;
+	}
+
+done:
+	ss->total_blocks += ss->chunk_header.chunk_sz;
+	sparse_next_chunk(ss);
+
+	return 0;
+}
+
+/* Collect header bytes in ss->hdr, returns the number of bytes used */
+static unsigned int sparse_gather(struct sparse_stream *ss, const u8 *data,
+				  unsigned int len, unsigned int want)
+{
+	unsigned int n = min(len, want - ss->hdr_len);
+
+	memcpy(ss->hdr + ss->hdr_len, data, n);
+	ss->hdr_len += n;
+
+	return n;
+}
 
-		if (sparse_header->chunk_hdr_sz > sizeof(chunk_header_t))
-		{
-			/*
-			 * Skip the remaining bytes in a header that is longer
-			 * than we expected.
-			 */
-			data += (sparse_header->chunk_hdr_sz -
-				 sizeof(chunk_header_t));
+int sparse_stream_init(struct sparse_stream *ss, block_dev_desc_t *dev_desc,
+		       disk_partition_t *info, const char *part_name)
+{
+	memset(ss, 0, sizeof(*ss));
+	ss->dev_desc = dev_desc;
+	ss->info = *info;
+	strncpy(ss->part_name, part_name, sizeof(ss->part_name) - 1);
+	ss->blk = info->start;
+	ss->state = SPARSE_FILE_HDR;
+
+	ss->buf_size = CONFIG_FASTBOOT_SPARSE_BUF_SIZE & ~(info->blksz - 1);
+	if (ss->buf_size < info->blksz)
+		ss->buf_size = info->blksz;
+	ss->buf = memalign(ARCH_DMA_MINALIGN, ss->buf_size);
+	if (!ss->buf)
+		return sparse_fail(ss, "Malloc failed for sparse buffer");
+
+	return 0;
+}
+
+int sparse_stream_write(struct sparse_stream *ss, const void *buf,
+			unsigned int len)
+{
+	const u8 *data = buf;
+	unsigned int n;
+	int ret = 0;
+
+	if (ss->state == SPARSE_ERROR)
+		return -1;
+
+	while (len && !ret) {
+		if (ss->skip) {
+			n = min(len, ss->skip);
+			ss->skip -= n;
+			data += n;
+			len -= n;
+			continue;
 		}
 
-		chunk_data_sz = sparse_header->blk_sz * chunk_header->chunk_sz;
-		blkcnt = chunk_data_sz / info->blksz;
-		switch (chunk_header->chunk_type)
-		{
-			case CHUNK_TYPE_RAW:
-			if (chunk_header->total_sz !=
-			    (sparse_header->chunk_hdr_sz + chunk_data_sz))
-			{
-				fastboot_fail(
-					"Bogus chunk size for chunk type Raw");
-				return;
+		switch (ss->state) {
+		case SPARSE_FILE_HDR:
+			n = sparse_gather(ss, data, len, sizeof(sparse_header_t));
+			if (ss->hdr_len == sizeof(sparse_header_t)) {
+				ss->hdr_len = 0;
+				ret = sparse_file_hdr(ss);
 			}
+			break;
 
-			if (blk + blkcnt > info->start + info->size) {
-				printf(
-				    "%s: Request would exceed partition size!\n",
-				    __func__);
-				fastboot_fail(
-				    "Request would exceed partition size!");
-				return;
+		case SPARSE_CHUNK_HDR:
+			n = sparse_gather(ss, data, len, sizeof(chunk_header_t));
+			if (ss->hdr_len == sizeof(chunk_header_t)) {
+				ss->hdr_len = 0;
+				ret = sparse_chunk_hdr(ss);
 			}
+			break;
 
-			blks = dev_desc->block_write(dev_desc->dev, blk, blkcnt,
-						     data);
-			if (blks != blkcnt) {
-				printf("%s: Write failed " LBAFU "\n",
-				       __func__, blks);
-				fastboot_fail("flash write failure");
-				return;
+		case SPARSE_FILL:
+			n = sparse_gather(ss, data, len, sizeof(uint32_t));
+			if (ss->hdr_len == sizeof(uint32_t)) {
+				ss->hdr_len = 0;
+				ret = sparse_fill(ss, *(uint32_t *)ss->hdr);
 			}
-			blk += blkcnt;
-			bytes_written += blkcnt * info->blksz;
-			total_blocks += chunk_header->chunk_sz;
-			data += chunk_data_sz;
 			break;
 
-			case CHUNK_TYPE_FILL:
-			if (chunk_header->total_sz !=
-			    (sparse_header->chunk_hdr_sz + sizeof(uint32_t)))
-			{
-				fastboot_fail(
-					"Bogus chunk size for chunk type FILL");
-				return;
-			}
+		case SPARSE_RAW:
+			n = min((u64)len, ss->remaining);
+			ret = sparse_stage(ss, data, n);
+			ss->remaining -= n;
+			if (!ss->remaining)
+				sparse_next_chunk(ss);
+			break;
 
-			fill_buf = (uint32_t *)
-				   memalign(ARCH_DMA_MINALIGN,
-					    ROUNDUP(info->blksz,
-						    ARCH_DMA_MINALIGN));
-			if (!fill_buf)
-			{
-				fastboot_fail(
-					"Malloc failed for: CHUNK_TYPE_FILL");
-				return;
-			}
+		case SPARSE_IMAGE:
+			n = len;
+			ret = sparse_stage(ss, data, n);
+			break;
 
-			fill_val = *(uint32_t *)data;
-			data = (char *) data + sizeof(uint32_t);
+		default:
+			/* Anything behind the last chunk is ignored */
+			n = len;
+			break;
+		}
 
-			for (i = 0; i < (info->blksz / sizeof(fill_val)); i++)
-				fill_buf[i] = fill_val;
+		data += n;
+		len -= n;
+	}
 
-			if (blk + blkcnt > info->start + info->size) {
-				printf(
-				    "%s: Request would exceed partition size!\n",
-				    __func__);
-				fastboot_fail(
-				    "Request would exceed partition size!");
-				return;
-			}
+	return ret;
+}
 
-			for (i = 0; i < blkcnt; i++) {
-				blks = dev_desc->block_write(dev_desc->dev,
-							     blk, 1, fill_buf);
-				if (blks != 1) {
-					printf(
-					    "%s: Write failed, block # " LBAFU "\n",
-					    __func__, blkcnt);
-					fastboot_fail("flash write failure");
-					free(fill_buf);
-					return;
-				}
-				blk++;
-			}
-			bytes_written += blkcnt * info->blksz;
-			total_blocks += chunk_data_sz / sparse_header->blk_sz;
+int sparse_stream_finish(struct sparse_stream *ss)
+{
+	sparse_header_t *sparse_header = &ss->sparse_header;
+	unsigned int pad;
+	int ret = -1;
 
-			free(fill_buf);
+	switch (ss->state) {
+	case SPARSE_FILE_HDR:
+		/* Too short for a sparse image header */
+		if (!ss->hdr_len) {
+			fastboot_fail("empty image");
+			break;
+		}
+		puts("Flashing Raw Image\n");
+		ss->state = SPARSE_IMAGE;
+		if (sparse_stage(ss, ss->hdr, ss->hdr_len))
 			break;
+		/* fall through */
 
-			case CHUNK_TYPE_DONT_CARE:
-			total_blocks += chunk_header->chunk_sz;
+	case SPARSE_IMAGE:
+		/* Pad the tail of the image to a whole block */
+		pad = ss->buf_len & (ss->info.blksz - 1);
+		if (pad) {
+			pad = ss->info.blksz - pad;
+			memset(ss->buf + ss->buf_len, 0, pad);
+			ss->buf_len += pad;
+		}
+		if (sparse_flush(ss))
 			break;
 
-			case CHUNK_TYPE_CRC32:
-			if (chunk_header->total_sz !=
-			    sparse_header->chunk_hdr_sz)
-			{
-				fastboot_fail(
-					"Bogus chunk size for chunk type Dont Care");
-				return;
-			}
-			total_blocks += chunk_header->chunk_sz;
-			data += chunk_data_sz;
+		printf("........ wrote %llu bytes to '%s'\n",
+		       ss->bytes_written, ss->part_name);
+		fastboot_okay("");
+		ret = 0;
+		break;
+
+	case SPARSE_DONE:
+		if (ss->skip) {
+			fastboot_fail("sparse image truncated");
+			break;
+		}
+		if (sparse_flush(ss))
 			break;
 
-			default:
-			printf("%s: Unknown chunk type: %x\n", __func__,
-			       chunk_header->chunk_type);
-			fastboot_fail("Unknown chunk type");
-			return;
+		debug("Wrote %d blocks, expected to write %d blocks\n",
+		      ss->total_blocks, sparse_header->total_blks);
+		printf("........ wrote %llu bytes to '%s'\n",
+		       ss->bytes_written, ss->part_name);
+
+		if (ss->total_blocks != sparse_header->total_blks) {
+			fastboot_fail("sparse image write failure");
+			break;
 		}
+
+		fastboot_okay("");
+		ret = 0;
+		break;
+
+	case SPARSE_ERROR:
+		break;
+
+	default:
+		fastboot_fail("sparse image truncated");
+		break;
 	}
 
-	debug("Wrote %d blocks, expected to write %d blocks\n",
-	      total_blocks, sparse_header->total_blks);
-	printf("........ wrote %u bytes to '%s'\n", bytes_written, part_name);
+	free(ss->buf);
+	ss->buf = NULL;
 
-	if (total_blocks != sparse_header->total_blks)
-		fastboot_fail("sparse image write failure");
+	return ret;
+}
+
+void write_sparse_image(block_dev_desc_t *dev_desc,
+		disk_partition_t *info, const char *part_name,
+		void *data, unsigned sz)
+{
+	struct sparse_stream ss;
+
+	if (sparse_stream_init(&ss, dev_desc, info, part_name))
+		return;
 
-	fastboot_okay("");
-	return;
+	sparse_stream_write(&ss, data, sz);
+	sparse_stream_finish(&ss);
 }
@@ -14,6 +14,7 @@
 #include <malloc.h>
 #include <asm/io.h>
 #include <linux/lzo.h>
+#include <lz4.h>
 #include <lzma/LzmaTypes.h>
 #include <lzma/LzmaDec.h>
 #include <lzma/LzmaTools.h>
@@ -344,6 +345,24 @@ static int decomp_image(int comp, ulong load, ulong image_start, int type,
 		break;
 	}
 #endif /* CONFIG_LZO */
+#ifdef CONFIG_LZ4
+	case IH_COMP_LZ4: {
+		size_t size = unc_len;
+		int ret;
+
+		printf("   Uncompressing %s ... ", type_name);
+
+		ret = lz4_decompress(image_buf, image_len, load_buf, &size);
+		if (ret) {
+			printf("LZ4: uncompress or overwrite error %d - must RESET board to recover\n",
+			       ret);
+			return BOOTM_ERR_RESET;
+		}
+
+		*load_end = load + size;
+		break;
+	}
+#endif /* CONFIG_LZ4 */
 	default:
 		printf("Unimplemented compression type %d\n", comp);
 		return BOOTM_ERR_UNIMPLEMENTED;
@@ -355,6 +374,29 @@ static int decomp_image(int comp, ulong load, ulong image_start, int type,
 }
 
 #ifndef USE_HOSTCC
+#if defined(CONFIG_FIT)
+/*
+ * Copy an uncompressed FIT kernel to its load address, checking the hashes
+ * that fit_image_load() left for the copy
+ */
+static int bootm_copy_verify_os(bootm_headers_t *images, void *load_buf,
+				ulong *load_end)
+{
+	printf("   Loading %s ... ", genimg_get_type_name(images->os.type));
+	if (!fit_image_copy_verify(images->fit_hdr_os, images->fit_noffset_os,
+				   load_buf)) {
+		puts("Bad Data Hash\n");
+		bootstage_error(BOOTSTAGE_ID_FIT_KERNEL_START +
+				BOOTSTAGE_SUB_HASH);
+		return -EACCES;
+	}
+	puts("OK\n");
+	*load_end = images->os.load + images->os.image_len;
+
+	return 0;
+}
+#endif
+
 static int bootm_load_os(bootm_headers_t *images, unsigned long *load_end,
 			 int boot_progress)
 {
@@ -370,8 +412,13 @@ static int bootm_load_os(bootm_headers_t *images, unsigned long *load_end,
 
 	load_buf = map_sysmem(load, 0);
 	image_buf = map_sysmem(os.image_start, image_len);
-	err = decomp_image(os.comp, load, os.image_start, os.type, load_buf,
-			   image_buf, image_len, load_end);
+#if defined(CONFIG_FIT)
+	if (images->fit_os_copy_verify)
+		err = bootm_copy_verify_os(images, load_buf, load_end);
+	else
+#endif
+		err = decomp_image(os.comp, load, os.image_start, os.type,
+				   load_buf, image_buf, image_len, load_end);
 	if (err) {
 		bootstage_error(BOOTSTAGE_ID_DECOMP_IMAGE);
 		return err;
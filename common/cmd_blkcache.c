@@ -0,0 +1,69 @@
+/*
+ * Show and tune the block read cache, see drivers/block/blkcache.c
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+#include <common.h>
+#include <command.h>
+#include <part.h>
+
+static int do_blkcache_show(cmd_tbl_t *cmdtp, int flag, int argc,
+			    char * const argv[])
+{
+	struct blkcache_stats stats;
+
+	blkcache_stats(&stats);
+	printf("    hits: %u\n"
+	       "    misses: %u\n"
+	       "    entries: %u\n"
+	       "    max blocks/entry: %u\n"
+	       "    max cache entries: %u\n",
+	       stats.hits, stats.misses, stats.entries,
+	       stats.max_blocks_per_entry, stats.max_entries);
+
+	return 0;
+}
+
+static int do_blkcache_configure(cmd_tbl_t *cmdtp, int flag, int argc,
+				 char * const argv[])
+{
+	if (argc != 3)
+		return CMD_RET_USAGE;
+
+	blkcache_configure(simple_strtoul(argv[1], NULL, 0),
+			   simple_strtoul(argv[2], NULL, 0));
+
+	return 0;
+}
+
+static cmd_tbl_t cmd_blkcache_sub[] = {
+	U_BOOT_CMD_MKENT(show, 1, 0, do_blkcache_show, "", ""),
+	U_BOOT_CMD_MKENT(configure, 3, 0, do_blkcache_configure, "", ""),
+};
+
+static int do_blkcache(cmd_tbl_t *cmdtp, int flag, int argc,
+		       char * const argv[])
+{
+	cmd_tbl_t *c;
+
+	/* Skip past 'blkcache' */
+	argc--;
+	argv++;
+
+	c = find_cmd_tbl(argv[0], cmd_blkcache_sub,
+			 ARRAY_SIZE(cmd_blkcache_sub));
+
+	if (c)
+		return c->cmd(cmdtp, flag, argc, argv);
+	else
+		return CMD_RET_USAGE;
+}
+
+U_BOOT_CMD(
+	blkcache,	4,	0,	do_blkcache,
+	"block cache diagnostics and control",
+	"show - show and reset the hit/miss counters\n"
+	"blkcache configure <blocks> <entries> - set the largest read cached\n"
+	"    and the number of entries, drops the cache"
+);
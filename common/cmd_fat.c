@@ -52,6 +52,24 @@ U_BOOT_CMD(
 	"      be printed and performance will suffer for the load."
 );
 
+#ifdef CONFIG_DECOMP_STREAM
+static int do_fat_fsloadz(cmd_tbl_t *cmdtp, int flag, int argc,
+			  char * const argv[])
+{
+	return do_loadz(cmdtp, flag, argc, argv, FS_TYPE_FAT);
+}
+
+U_BOOT_CMD(
+	fatloadz,	5,	0,	do_fat_fsloadz,
+	"load a file from a dos filesystem, decompressing it on the fly",
+	"<interface> [<dev[:part]> [<addr> [<filename>]]]\n"
+	"    - Load file 'filename' from 'dev' on 'interface' to address\n"
+	"      'addr', like fatload. A legacy image with a compressed\n"
+	"      payload becomes an uncompressed image at 'addr', gzip and\n"
+	"      lzop files are unpacked to 'addr'."
+);
+#endif
+
 static int do_fat_ls(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
 {
 	return do_ls(cmdtp, flag, argc, argv, FS_TYPE_FAT);
@@ -51,6 +51,25 @@ U_BOOT_CMD(
 	"      If 'pos' is 0 or omitted, the file is read from the start."
 )
 
+#ifdef CONFIG_DECOMP_STREAM
+static int do_loadz_wrapper(cmd_tbl_t *cmdtp, int flag, int argc,
+				char * const argv[])
+{
+	return do_loadz(cmdtp, flag, argc, argv, FS_TYPE_ANY);
+}
+
+U_BOOT_CMD(
+	loadz,	5,	0,	do_loadz_wrapper,
+	"load a file from a filesystem, decompressing it on the fly",
+	"<interface> [<dev[:part]> [<addr> [<filename>]]]\n"
+	"    - Load file 'filename' from partition 'part' on device\n"
+	"       type 'interface' instance 'dev' to address 'addr' in memory.\n"
+	"      A legacy image with a compressed payload is unpacked to an\n"
+	"      uncompressed image at 'addr', gzip and lzop files are\n"
+	"      unpacked to 'addr', other files are loaded as they are."
+)
+#endif
+
 static int do_ls_wrapper(cmd_tbl_t *cmdtp, int flag, int argc,
 				char * const argv[])
 {
@@ -7,6 +7,7 @@
 
 #include <common.h>
 #include <command.h>
+#include <malloc.h>
 #include <mmc.h>
 #include <packimg.h>
 
@@ -641,6 +642,99 @@ static int do_mmc_packimg(cmd_tbl_t *cmdtp, int flag,
 }
 #endif
 
+#ifdef CONFIG_CMD_MMC_BENCH
+static void mmc_bench_report(const char *what, ulong bytes, ulong ms)
+{
+	ulong rate;
+
+	if (!ms)
+		ms = 1;
+	/* bytes per ms is KB/s */
+	rate = bytes / ms;
+	printf("  %-8s %lu KiB in %lu ms, %lu.%02lu MB/s\n", what,
+	       bytes >> 10, ms, rate / 1000, (rate % 1000) / 10);
+}
+
+static int do_mmc_bench(cmd_tbl_t *cmdtp, int flag,
+			int argc, char * const argv[])
+{
+	struct mmc_sg sg[MMC_SG_MAX];
+	struct mmc *mmc;
+	u32 blk, cnt, n, per;
+	ulong start, bytes;
+	int write, i, ret = CMD_RET_FAILURE;
+	char *buf;
+
+	if (argc != 3 && argc != 4)
+		return CMD_RET_USAGE;
+	write = argc == 4 && !strcmp(argv[3], "write");
+	if (argc == 4 && !write)
+		return CMD_RET_USAGE;
+
+	blk = simple_strtoul(argv[1], NULL, 16);
+	cnt = simple_strtoul(argv[2], NULL, 16);
+
+	mmc = init_mmc_device(curr_device, false);
+	if (!mmc)
+		return CMD_RET_FAILURE;
+
+	if (write && mmc_getwp(mmc) == 1) {
+		printf("Error: card is write protected!\n");
+		return CMD_RET_FAILURE;
+	}
+
+	bytes = (ulong)cnt * mmc->read_bl_len;
+	buf = memalign(ARCH_DMA_MINALIGN, bytes);
+	if (!buf) {
+		printf("Can't allocate %lu bytes\n", bytes);
+		return CMD_RET_FAILURE;
+	}
+
+	printf("MMC bench: dev # %d (%s), b_max %u, %s\n", curr_device,
+	       mmc->cfg->name, mmc->cfg->b_max,
+	       mmc->cfg->host_caps & MMC_MODE_SG ? "scatter/gather" :
+						   "single buffer");
+
+	start = get_timer(0);
+	n = mmc->block_dev.block_read(curr_device, blk, cnt, buf);
+	if (n != cnt)
+		goto out;
+	mmc_bench_report("read", bytes, get_timer(start));
+
+	/* Write back what was just read, so the test leaves the card as is */
+	if (write) {
+		start = get_timer(0);
+		n = mmc->block_dev.block_write(curr_device, blk, cnt, buf);
+		if (n != cnt)
+			goto out;
+		mmc_bench_report("write", bytes, get_timer(start));
+	}
+
+	/* Same blocks, scattered over the buffer in reverse order */
+	per = cnt / MMC_SG_MAX;
+	if (per) {
+		for (i = 0; i < MMC_SG_MAX; i++) {
+			sg[i].addr = buf + (MMC_SG_MAX - 1 - i) * per *
+				     mmc->read_bl_len;
+			sg[i].len = per * mmc->read_bl_len;
+		}
+		start = get_timer(0);
+		n = mmc_bread_sg(curr_device, blk, sg, MMC_SG_MAX);
+		if (n != per * MMC_SG_MAX)
+			goto out;
+		mmc_bench_report("read sg", (ulong)n * mmc->read_bl_len,
+				 get_timer(start));
+	}
+
+	ret = CMD_RET_SUCCESS;
+out:
+	if (ret)
+		printf("MMC bench: transfer failed\n");
+	free(buf);
+	return ret;
+}
+#endif
+
 static cmd_tbl_t cmd_mmc[] = {
 	U_BOOT_CMD_MKENT(info, 1, 0, do_mmcinfo, "", ""),
 	U_BOOT_CMD_MKENT(read, 4, 1, do_mmc_read, "", ""),
@@ -663,6 +757,9 @@ static cmd_tbl_t cmd_mmc[] = {
 #ifdef CONFIG_CMD_MMC_PACKIMG
 	U_BOOT_CMD_MKENT(packimg, 7, 1, do_mmc_packimg, "", ""),
 #endif
+#ifdef CONFIG_CMD_MMC_BENCH
+	U_BOOT_CMD_MKENT(bench, 4, 0, do_mmc_bench, "", ""),
+#endif
 };
 
 static int do_mmcops(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
@@ -722,6 +819,9 @@ U_BOOT_CMD(
 	"mmc setdsr <value> - set DSR register value\n"
 #ifdef CONFIG_CMD_MMC_PACKIMG
 	"mmc packimg blk# [file1] [file2] ...\n"
+#endif
+#ifdef CONFIG_CMD_MMC_BENCH
+	"mmc bench blk# cnt [write] - measure read [and write back] speed\n"
 #endif
 	);
 
@@ -18,6 +18,15 @@
 static int sata_curr_device = -1;
 block_dev_desc_t sata_dev_desc[CONFIG_SYS_SATA_MAX_DEVICE];
 
+/* sata_write() is up to the controller driver, drop cached blocks here */
+static ulong sata_bwrite(int dev, lbaint_t blknr, lbaint_t blkcnt,
+			 const void *buffer)
+{
+	blkcache_invalidate(IF_TYPE_SATA, dev);
+
+	return sata_write(dev, blknr, blkcnt, buffer);
+}
+
 int __sata_initialize(void)
 {
 	int rc;
@@ -33,7 +42,7 @@ int __sata_initialize(void)
 		sata_dev_desc[i].blksz = 512;
 		sata_dev_desc[i].log2blksz = LOG2(sata_dev_desc[i].blksz);
 		sata_dev_desc[i].block_read = sata_read;
-		sata_dev_desc[i].block_write = sata_write;
+		sata_dev_desc[i].block_write = sata_bwrite;
 
 		rc = init_sata(i);
 		if (!rc) {
@@ -168,7 +177,8 @@ static int do_sata(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
 			printf("\nSATA write: device %d block # %ld, count %ld ... ",
 				sata_curr_device, blk, cnt);
 
-			n = sata_write(sata_curr_device, blk, cnt, (u32 *)addr);
+			n = sata_bwrite(sata_curr_device, blk, cnt,
+					(u32 *)addr);
 
 			printf("%ld blocks written: %s\n",
 				n, (n == cnt) ? "OK" : "ERROR");
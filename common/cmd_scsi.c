@@ -420,6 +420,7 @@ static ulong scsi_write(int device, lbaint_t blknr,
 	unsigned short smallblks;
 	ccb* pccb = (ccb *)&tempccb;
 	device &= 0xff;
+	blkcache_invalidate(IF_TYPE_SCSI, device);
 	/* Setup  device
 	 */
 	pccb->target = scsi_dev_desc[device].target;
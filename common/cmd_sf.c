@@ -10,6 +10,7 @@
 #include <div64.h>
 #include <malloc.h>
 #include <spi_flash.h>
+#include <decomp_stream.h>
 
 #include <asm/io.h>
 
@@ -121,96 +122,305 @@ static int do_spi_flash_probe(int argc, char * const argv[])
 	return 0;
 }
 
+#define SF_NO_MANIFEST		(~0UL)
+#define SF_MANIFEST_MAGIC	0x464d4653	/* "SFMF" */
+
+/*
+ * What 'sf update' wrote to an area of the flash: the CRC32 of the data in
+ * each erase block. The next update of the area compares the hashes of the
+ * new image with these instead of reading the blocks back.
+ */
+struct sf_manifest {
+	u32 magic;
+	u32 crc;		/* CRC32 of the manifest with crc zero */
+	u32 offset;		/* flash offset of the area */
+	u32 size;		/* bytes written to the area */
+	u32 erase_size;
+	u32 nblock;
+	u32 hash[];		/* CRC32 of the data in each erase block */
+};
+
+static size_t sf_manifest_size(u32 nblock)
+{
+	return sizeof(struct sf_manifest) + nblock * sizeof(u32);
+}
+
+/* Number of bytes of a 'size' byte area in erase block 'i' */
+static size_t sf_block_len(size_t size, u32 i, u32 erase_size)
+{
+	return min(size - (size_t)i * erase_size, (size_t)erase_size);
+}
+
+static u32 sf_manifest_crc(struct sf_manifest *m)
+{
+	u32 crc = m->crc, ret;
+
+	m->crc = 0;
+	ret = crc32(0, (uchar *)m, sf_manifest_size(m->nblock));
+	m->crc = crc;
+
+	return ret;
+}
+
 /**
- * Write a block of data to SPI flash, first checking if it is different from
- * what is already there.
+ * Read the manifest of an area of SPI flash
  *
- * If the data being written is the same, then *skipped is incremented by len.
+ * @param flash		flash context pointer
+ * @param moffset	flash offset of the manifest
+ * @param offset	flash offset of the area it must describe
+ * @return the manifest, or NULL if there is no valid one for the area
+ */
+static struct sf_manifest *sf_manifest_read(struct spi_flash *flash,
+		u32 moffset, u32 offset)
+{
+	struct sf_manifest hdr, *m;
+
+	if (spi_flash_read(flash, moffset, sizeof(hdr), &hdr) ||
+	    hdr.magic != SF_MANIFEST_MAGIC || hdr.offset != offset ||
+	    hdr.erase_size != flash->erase_size ||
+	    hdr.size > flash->size - offset ||
+	    hdr.nblock != DIV_ROUND_UP(hdr.size, hdr.erase_size))
+		return NULL;
+
+	m = malloc(sf_manifest_size(hdr.nblock));
+	if (!m)
+		return NULL;
+	if (spi_flash_read(flash, moffset, sf_manifest_size(hdr.nblock), m) ||
+	    m->crc != sf_manifest_crc(m)) {
+		free(m);
+		return NULL;
+	}
+
+	return m;
+}
+
+/**
+ * Check whether an erase block of SPI flash already holds the new data
+ *
+ * Without a manifest of the old data the block is read back and compared.
  *
  * @param flash		flash context pointer
- * @param offset	flash offset to write
- * @param len		number of bytes to write
- * @param buf		buffer to write from
- * @param cmp_buf	read buffer to use to compare data
- * @param skipped	Count of skipped data (incremented by this function)
+ * @param old		manifest of the data on flash, or NULL
+ * @param new		manifest of the new data
+ * @param i		erase block in the area
+ * @param buf		new data of the block
+ * @param cmp_buf	read buffer of one erase block
+ * @return 1 if the block is unchanged, 0 if it changes, -1 on read error
+ */
+static int sf_block_unchanged(struct spi_flash *flash,
+		struct sf_manifest *old, struct sf_manifest *new, u32 i,
+		const char *buf, char *cmp_buf)
+{
+	size_t len = sf_block_len(new->size, i, new->erase_size);
+
+	if (old)
+		return i < old->nblock && old->hash[i] == new->hash[i] &&
+		       sf_block_len(old->size, i, old->erase_size) == len;
+
+	if (spi_flash_read(flash, new->offset + i * new->erase_size, len,
+			   cmp_buf))
+		return -1;
+
+	return memcmp(cmp_buf, buf, len) == 0;
+}
+
+/**
+ * Erase and write a run of contiguous erase blocks, then read them back and
+ * check them against the hashes in the manifest.
+ *
+ * If the run ends in a partial block, the rest of that block is kept.
+ *
+ * @param flash		flash context pointer
+ * @param new		manifest of the new data
+ * @param first		first erase block of the run
+ * @param end		erase block after the run
+ * @param buf		buffer holding the whole new area
+ * @param cmp_buf	read buffer of one erase block
  * @return NULL if OK, else a string containing the stage which failed
  */
-static const char *spi_flash_update_block(struct spi_flash *flash, u32 offset,
-		size_t len, const char *buf, char *cmp_buf, size_t *skipped)
+static const char *spi_flash_update_run(struct spi_flash *flash,
+		struct sf_manifest *new, u32 first, u32 end, const char *buf,
+		char *cmp_buf)
 {
-	debug("offset=%#x, sector_size=%#x, len=%#zx\n",
-	      offset, flash->sector_size, len);
-	/* Read the entire sector so to allow for rewriting */
-	if (spi_flash_read(flash, offset, flash->sector_size, cmp_buf))
+	const u32 erase_size = new->erase_size;
+	size_t start = (size_t)first * erase_size;
+	size_t len = min((size_t)new->size, (size_t)end * erase_size) - start;
+	size_t tail = (size_t)(end - first) * erase_size - len;
+	u32 offset = new->offset + start;
+	u32 i;
+
+	debug("offset=%#x, blocks=%u, len=%#zx\n", offset, end - first, len);
+	/* Read the end of a partial block so to allow for rewriting */
+	if (tail && spi_flash_read(flash, offset + len, tail, cmp_buf))
 		return "read";
-	/* Compare only what is meaningful (len) */
-	if (memcmp(cmp_buf, buf, len) == 0) {
-		debug("Skip region %x size %zx: no change\n",
-		      offset, len);
-		*skipped += len;
-		return NULL;
-	}
-	/* Erase the entire sector */
-	if (spi_flash_erase(flash, offset, flash->sector_size))
+	if (spi_flash_erase(flash, offset, len + tail))
 		return "erase";
-	/* Write the initial part of the block from the source */
-	if (spi_flash_write(flash, offset, len, buf))
+	if (spi_flash_write(flash, offset, len, buf + start))
+		return "write";
+	if (tail && spi_flash_write(flash, offset + len, tail, cmp_buf))
 		return "write";
-	/* If it's a partial sector, rewrite the existing part */
-	if (len != flash->sector_size) {
-		/* Rewrite the original data to the end of the sector */
-		if (spi_flash_write(flash, offset + len,
-				    flash->sector_size - len, &cmp_buf[len]))
-			return "write";
+
+	for (i = first; i < end; i++) {
+		len = sf_block_len(new->size, i, erase_size);
+		if (spi_flash_read(flash, new->offset + i * erase_size, len,
+				   cmp_buf))
+			return "read";
+		if (crc32(0, (uchar *)cmp_buf, len) != new->hash[i])
+			return "verify";
+	}
+
+	return NULL;
+}
+
+/**
+ * Write the manifest of an area of SPI flash and read it back
+ *
+ * @param flash		flash context pointer
+ * @param moffset	flash offset of the manifest, its erase blocks are
+ *			already erased
+ * @param new		manifest to write
+ * @return NULL if OK, else a string containing the stage which failed
+ */
+static const char *sf_manifest_write(struct spi_flash *flash, u32 moffset,
+		struct sf_manifest *new)
+{
+	struct sf_manifest *m;
+
+	if (spi_flash_write(flash, moffset, sf_manifest_size(new->nblock), new))
+		return "manifest write";
+	m = sf_manifest_read(flash, moffset, new->offset);
+	if (!m || m->crc != new->crc) {
+		free(m);
+		return "manifest verify";
 	}
+	free(m);
 
 	return NULL;
 }
 
 /**
- * Update an area of SPI flash by erasing and writing any blocks which need
- * to change. Existing blocks with the correct data are left unchanged.
+ * Update an area of SPI flash by erasing and writing any erase blocks which
+ * need to change. Existing blocks with the correct data are left unchanged,
+ * each run of contiguous changed blocks is erased and written in one go and
+ * checked against the CRC32 of the new data.
+ *
+ * With a manifest, the blocks are compared with the hashes it recorded at
+ * the last update of the area instead of being read back. It is erased
+ * before the first block changes and written again once all of them are
+ * done, an interrupted update leaves no manifest and the next one compares
+ * every block. Writing the area by other means leaves a stale manifest.
  *
  * @param flash		flash context pointer
- * @param offset	flash offset to write
+ * @param offset	flash offset to write, aligned to the erase size
  * @param len		number of bytes to write
  * @param buf		buffer to write from
+ * @param moffset	flash offset of the manifest, or SF_NO_MANIFEST
  * @return 0 if ok, 1 on error
  */
 static int spi_flash_update(struct spi_flash *flash, u32 offset,
-		size_t len, const char *buf)
+		size_t len, const char *buf, ulong moffset)
 {
+	const u32 erase_size = flash->erase_size;
+	const u32 nblock = DIV_ROUND_UP(len, erase_size);
+	const size_t msize = ROUND(sf_manifest_size(nblock), erase_size);
+	struct sf_manifest *old = NULL, *new;
 	const char *err_oper = NULL;
 	char *cmp_buf;
-	const char *end = buf + len;
-	size_t todo;		/* number of bytes to do in this pass */
 	size_t skipped = 0;	/* statistics */
 	const ulong start_time = get_timer(0);
-	size_t scale = 1;
-	const char *start_buf = buf;
+	ulong last_update = start_time;
+	size_t scale = 1, done;
+	int merased = 0;
+	u32 i, first;
 	ulong delta;
+	int ret;
+
+	if (offset % erase_size) {
+		printf("ERROR: offset %#x is not aligned to the erase size %#x\n",
+		       offset, erase_size);
+		return 1;
+	}
+	if (moffset != SF_NO_MANIFEST &&
+	    (moffset % erase_size || moffset > flash->size - msize ||
+	     (moffset + msize > offset &&
+	      moffset < offset + (size_t)nblock * erase_size))) {
+		printf("ERROR: manifest at %#lx does not fit there\n", moffset);
+		return 1;
+	}
+
+	if (len >= 200)
+		scale = len / 100;
+	new = malloc(sf_manifest_size(nblock));
+	cmp_buf = malloc(erase_size);
+	if (!new || !cmp_buf) {
+		err_oper = "malloc";
+		goto out;
+	}
+
+	new->magic = SF_MANIFEST_MAGIC;
+	new->offset = offset;
+	new->size = len;
+	new->erase_size = erase_size;
+	new->nblock = nblock;
+	for (i = 0; i < nblock; i++)
+		new->hash[i] = crc32(0, (uchar *)buf + i * erase_size,
+				     sf_block_len(len, i, erase_size));
+	new->crc = sf_manifest_crc(new);
+
+	if (moffset != SF_NO_MANIFEST) {
+		old = sf_manifest_read(flash, moffset, offset);
+		if (!old)
+			puts("No manifest of the flash data, comparing it\n");
+	}
 
-	if (end - buf >= 200)
-		scale = (end - buf) / 100;
-	cmp_buf = malloc(flash->sector_size);
-	if (cmp_buf) {
-		ulong last_update = get_timer(0);
-
-		for (; buf < end && !err_oper; buf += todo, offset += todo) {
-			todo = min(end - buf, flash->sector_size);
-			if (get_timer(last_update) > 100) {
-				printf("   \rUpdating, %zu%% %lu B/s",
-				       100 - (end - buf) / scale,
-					bytes_per_second(buf - start_buf,
-							 start_time));
-				last_update = get_timer(0);
+	/* Look for runs of changed blocks, update each one as it ends */
+	for (first = i = 0; i <= nblock && !err_oper; i++) {
+		if (get_timer(last_update) > 100) {
+			done = min((size_t)i * erase_size, len);
+			printf("   \rUpdating, %zu%% %lu B/s", done / scale,
+			       bytes_per_second(done, start_time));
+			last_update = get_timer(0);
+		}
+
+		if (i < nblock) {
+			ret = sf_block_unchanged(flash, old, new, i,
+						 buf + (size_t)i * erase_size,
+						 cmp_buf);
+			if (ret < 0) {
+				err_oper = "read";
+				break;
 			}
-			err_oper = spi_flash_update_block(flash, offset, todo,
-					buf, cmp_buf, &skipped);
+			if (!ret)
+				continue;
+			skipped += sf_block_len(len, i, erase_size);
 		}
-	} else {
-		err_oper = "malloc";
+
+		if (first < i) {
+			if (moffset != SF_NO_MANIFEST && !merased) {
+				if (spi_flash_erase(flash, moffset, msize)) {
+					err_oper = "manifest erase";
+					break;
+				}
+				merased = 1;
+			}
+			err_oper = spi_flash_update_run(flash, new, first, i, buf,
+							cmp_buf);
+		}
+		first = i + 1;
 	}
+
+	if (!err_oper && moffset != SF_NO_MANIFEST &&
+	    (!old || old->nblock != nblock ||
+	     memcmp(old, new, sf_manifest_size(nblock)))) {
+		if (!merased && spi_flash_erase(flash, moffset, msize))
+			err_oper = "manifest erase";
+		else
+			err_oper = sf_manifest_write(flash, moffset, new);
+	}
+
+out:
+	free(old);
+	free(new);
 	free(cmp_buf);
 	putc('\r');
 	if (err_oper) {
@@ -227,11 +437,56 @@ static int spi_flash_update(struct spi_flash *flash, u32 offset,
 	return 0;
 }
 
+#ifdef CONFIG_DECOMP_STREAM
+/*
+ * Read up to len bytes at offset and decompress them to buf on the fly,
+ * see decomp_stream_init_image(). Reading stops at the end of the
+ * compressed data, so len only needs to be an upper bound.
+ */
+static int spi_flash_read_stream(u32 offset, size_t len, void *buf)
+{
+	struct decomp_stream ds;
+	size_t done, chunk;
+	ulong size;
+	void *cbuf;
+	int ret = 0;
+
+	cbuf = malloc(CONFIG_DECOMP_STREAM_CHUNK);
+	if (!cbuf) {
+		puts("SF: out of memory\n");
+		return 1;
+	}
+
+	decomp_stream_init_image(&ds, buf, DECOMP_STREAM_ROOM);
+	for (done = 0; !ret && done < len; done += chunk) {
+		chunk = min(len - done, (size_t)CONFIG_DECOMP_STREAM_CHUNK);
+		if (spi_flash_read(flash, offset + done, chunk, cbuf)) {
+			ret = -1;
+			break;
+		}
+		ret = decomp_stream_feed(&ds, cbuf, chunk);
+	}
+	if (ret > 0)
+		ret = 0;
+	if (decomp_stream_finish(&ds, &size))
+		ret = -1;
+	free(cbuf);
+
+	printf("SF: %zu bytes @ %#x Read, %lu bytes unpacked: %s\n", done,
+	       offset, size, ret ? "ERROR" : "OK");
+	if (!ret)
+		setenv_hex("filesize", size);
+
+	return ret;
+}
+#endif
+
 static int do_spi_flash_read_write(int argc, char * const argv[])
 {
 	unsigned long addr;
 	unsigned long offset;
 	unsigned long len;
+	unsigned long moffset = SF_NO_MANIFEST;
 	void *buf;
 	char *endp;
 	int ret = 1;
@@ -248,6 +503,13 @@ static int do_spi_flash_read_write(int argc, char * const argv[])
 	len = simple_strtoul(argv[3], &endp, 16);
 	if (*argv[3] == 0 || *endp != 0)
 		return -1;
+	if (argc > 4) {
+		if (strcmp(argv[0], "update") != 0)
+			return -1;
+		moffset = simple_strtoul(argv[4], &endp, 16);
+		if (*argv[4] == 0 || *endp != 0)
+			return -1;
+	}
 
 	/* Consistency checking */
 	if (offset + len > flash->size) {
@@ -263,7 +525,11 @@ static int do_spi_flash_read_write(int argc, char * const argv[])
 	}
 
 	if (strcmp(argv[0], "update") == 0) {
-		ret = spi_flash_update(flash, offset, len, buf);
+		ret = spi_flash_update(flash, offset, len, buf, moffset);
+#ifdef CONFIG_DECOMP_STREAM
+	} else if (strcmp(argv[0], "read.z") == 0) {
+		ret = spi_flash_read_stream(offset, len, buf);
+#endif
 	} else if (strncmp(argv[0], "read", 4) == 0 ||
 			strncmp(argv[0], "write", 5) == 0) {
 		int read;
@@ -500,7 +766,7 @@ static int do_spi_flash(cmd_tbl_t *cmdtp, int flag, int argc,
 	}
 
 	if (strcmp(cmd, "read") == 0 || strcmp(cmd, "write") == 0 ||
-	    strcmp(cmd, "update") == 0)
+	    strcmp(cmd, "update") == 0 || strcmp(cmd, "read.z") == 0)
 		ret = do_spi_flash_read_write(argc, argv);
 	else if (strcmp(cmd, "erase") == 0)
 		ret = do_spi_flash_erase(argc, argv);
@@ -526,8 +792,16 @@ usage:
 #define SF_TEST_HELP
 #endif
 
+#ifdef CONFIG_DECOMP_STREAM
+#define SF_READZ_HELP "\nsf read.z addr offset len	" \
+		"- read at most `len' bytes starting at\n" \
+		"				  `offset', decompressing them to `addr'"
+#else
+#define SF_READZ_HELP
+#endif
+
 U_BOOT_CMD(
-	sf,	5,	1,	do_spi_flash,
+	sf,	6,	1,	do_spi_flash,
 	"SPI flash sub-system",
 	"probe [[bus:]cs] [hz] [mode]	- init flash device on given SPI bus\n"
 	"				  and chip select\n"
@@ -537,7 +811,11 @@ U_BOOT_CMD(
 	"				  at `addr' to flash at `offset'\n"
 	"sf erase offset [+]len		- erase `len' bytes from `offset'\n"
 	"				  `+len' round up `len' to block size\n"
-	"sf update addr offset len	- erase and write `len' bytes from memory\n"
-	"				  at `addr' to flash at `offset'"
+	"sf update addr offset len [manifest]\n"
+	"				- erase and write `len' bytes from memory\n"
+	"				  at `addr' to flash at `offset', skipping\n"
+	"				  unchanged erase blocks; `manifest' is a\n"
+	"				  flash offset to keep block hashes at"
+	SF_READZ_HELP
 	SF_TEST_HELP
 );
@@ -22,6 +22,7 @@
 #include <linux/err.h>
 #include <ubi_uboot.h>
 #include <asm/errno.h>
+#include <asm/io.h>
 #include <jffs2/load_kernel.h>
 
 #undef ubi_msg
@@ -613,15 +614,17 @@ static int do_ubi(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
 		    strncmp(argv[1] + 5, ".part", 5) == 0) {
 			if (argc < 6) {
 				ret = ubi_volume_continue_write(argv[3],
-						(void *)addr, size);
+						map_sysmem(addr, size), size);
 			} else {
 				size_t full_size;
 				full_size = simple_strtoul(argv[5], NULL, 16);
 				ret = ubi_volume_begin_write(argv[3],
-						(void *)addr, size, full_size);
+						map_sysmem(addr, size), size,
+						full_size);
 			}
 		} else {
-			ret = ubi_volume_write(argv[3], (void *)addr, size);
+			ret = ubi_volume_write(argv[3], map_sysmem(addr, size),
+					       size);
 		}
 		if (!ret) {
 			printf("%lld bytes written to volume %s\n", size,
@@ -650,7 +653,8 @@ static int do_ubi(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[])
 			printf("Read %lld bytes from volume %s to %lx\n", size,
 			       argv[3], addr);
 
-			return ubi_volume_read(argv[3], (char *)addr, size);
+			return ubi_volume_read(argv[3], map_sysmem(addr, size),
+					       size);
 		}
 	}
 
@@ -0,0 +1,257 @@
+/*
+ * Streaming decompression, see include/decomp_stream.h
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+#include <common.h>
+#include <decomp_stream.h>
+#include <errno.h>
+#include <linux/lzo.h>
+#include <lzma/LzmaTypes.h>
+#include <lzma/LzmaTools.h>
+
+struct decomp_ops {
+	int comp;
+	void *(*init)(void *dst, unsigned long dstlen);
+	int (*feed)(void *state, const void *src, unsigned long len,
+		    unsigned long *outlen);
+	int (*finish)(void *state);
+};
+
+static const struct decomp_ops decomp_ops[] = {
+#ifdef CONFIG_GZIP
+	{ IH_COMP_GZIP, gzip_stream_init, gzip_stream_feed,
+	  gzip_stream_finish },
+#endif
+#ifdef CONFIG_LZMA
+	{ IH_COMP_LZMA, lzmaStreamInit, lzmaStreamFeed, lzmaStreamFinish },
+#endif
+#ifdef CONFIG_LZO
+	{ IH_COMP_LZO, lzop_stream_init, lzop_stream_feed,
+	  lzop_stream_finish },
+#endif
+};
+
+static const struct decomp_ops *decomp_get_ops(int comp)
+{
+	int i;
+
+	for (i = 0; i < ARRAY_SIZE(decomp_ops); i++)
+		if (decomp_ops[i].comp == comp)
+			return &decomp_ops[i];
+
+	return NULL;
+}
+
+int decomp_stream_supported(int comp)
+{
+	return comp == IH_COMP_NONE || decomp_get_ops(comp) != NULL;
+}
+
+static int decomp_stream_start(struct decomp_stream *ds, int comp, void *dst,
+			       ulong dst_len)
+{
+	const struct decomp_ops *ops = decomp_get_ops(comp);
+
+	ds->comp = comp;
+	ds->dst = dst;
+	ds->dst_len = dst_len;
+	if (comp == IH_COMP_NONE)
+		return 0;
+
+	if (!ops) {
+		printf("%s: streaming not supported\n",
+		       genimg_get_comp_name(comp));
+		return -ENOSYS;
+	}
+	ds->state = ops->init(dst, dst_len);
+	if (!ds->state)
+		return -ENOMEM;
+
+	return 0;
+}
+
+int decomp_stream_init(struct decomp_stream *ds, int comp, void *dst,
+		       ulong dst_len)
+{
+	memset(ds, 0, sizeof(*ds));
+
+	return decomp_stream_start(ds, comp, dst, dst_len);
+}
+
+int decomp_stream_init_image(struct decomp_stream *ds, void *dst,
+			     ulong dst_len)
+{
+	memset(ds, 0, sizeof(*ds));
+	ds->dst = dst;
+	ds->dst_len = dst_len;
+	ds->probe = 1;
+
+	return 0;
+}
+
+static int decomp_stream_data(struct decomp_stream *ds, const void *buf,
+			      ulong len)
+{
+	const struct decomp_ops *ops;
+	ulong out = ds->out;
+	int ret;
+
+	if (ds->image) {
+		len = min(len, ds->data_left);
+		ds->data_left -= len;
+		ds->dcrc = crc32(ds->dcrc, buf, len);
+	}
+
+	if (ds->comp == IH_COMP_NONE) {
+		if (len > ds->dst_len - ds->out) {
+			puts("Error: out of room\n");
+			return -ENOSPC;
+		}
+		memcpy(ds->dst + ds->out, buf, len);
+		ds->out += len;
+		return 0;
+	}
+
+	if (!ds->done) {
+		ops = decomp_get_ops(ds->comp);
+		ret = ops->feed(ds->state, buf, len, &ds->out);
+		if (ret < 0) {
+			printf("%s: uncompress error %d\n",
+			       genimg_get_comp_name(ds->comp), ret);
+			return -EINVAL;
+		}
+		ds->done = ret;
+
+		/* the new output is still in the cache */
+		if (ds->image)
+			ds->ocrc = crc32(ds->ocrc, ds->dst + out,
+					 ds->out - out);
+	}
+
+	/* a trailer after the compressed data is still in the data CRC */
+	if (ds->image)
+		return !ds->data_left;
+
+	return ds->done;
+}
+
+/* Set the stream up from the first bytes, collected in ds->hdr */
+static int decomp_stream_probe(struct decomp_stream *ds)
+{
+	static const unsigned char lzop_magic[] = {
+		0x89, 0x4c, 0x5a, 0x4f, 0x00, 0x0d, 0x0a, 0x1a, 0x0a
+	};
+	image_header_t *hdr = &ds->hdr;
+	const unsigned char *p = (const unsigned char *)hdr;
+	ulong hdr_len = sizeof(*hdr);
+	int comp = IH_COMP_NONE;
+	int ret;
+
+	ds->probe = 0;
+
+	if (ds->probe_len == hdr_len && image_check_magic(hdr)) {
+		if (!image_check_hcrc(hdr)) {
+			puts("Bad Header Checksum\n");
+			return -EINVAL;
+		}
+
+		/* anything we cannot stream is copied as it is */
+		if (image_get_type(hdr) != IH_TYPE_MULTI &&
+		    decomp_get_ops(image_get_comp(hdr)) &&
+		    ds->dst_len >= hdr_len) {
+			ret = decomp_stream_start(ds, image_get_comp(hdr),
+						 ds->dst + hdr_len,
+						 ds->dst_len - hdr_len);
+			if (ret)
+				return ret;
+			ds->image = 1;
+			ds->data_left = image_get_data_size(hdr);
+			return 0;
+		}
+	} else if (ds->probe_len >= 2 && p[0] == 0x1f && p[1] == 0x8b) {
+		comp = IH_COMP_GZIP;
+	} else if (ds->probe_len >= sizeof(lzop_magic) &&
+		   !memcmp(p, lzop_magic, sizeof(lzop_magic))) {
+		comp = IH_COMP_LZO;
+	}
+
+	if (!decomp_get_ops(comp))
+		comp = IH_COMP_NONE;
+	ret = decomp_stream_start(ds, comp, ds->dst, ds->dst_len);
+	if (ret)
+		return ret;
+
+	return decomp_stream_data(ds, hdr, ds->probe_len);
+}
+
+int decomp_stream_feed(struct decomp_stream *ds, const void *buf, ulong len)
+{
+	ulong n;
+	int ret;
+
+	if (ds->err)
+		return ds->err;
+
+	if (ds->probe) {
+		n = min(len, sizeof(ds->hdr) - ds->probe_len);
+		memcpy((void *)&ds->hdr + ds->probe_len, buf, n);
+		ds->probe_len += n;
+		buf += n;
+		len -= n;
+		if (ds->probe_len < sizeof(ds->hdr))
+			return 0;
+
+		ret = decomp_stream_probe(ds);
+		if (ret)
+			goto out;
+	}
+
+	ret = decomp_stream_data(ds, buf, len);
+
+out:
+	if (ret < 0)
+		ds->err = ret;
+
+	return ret;
+}
+
+int decomp_stream_finish(struct decomp_stream *ds, ulong *lenp)
+{
+	image_header_t *hdr = &ds->hdr;
+	int ret = ds->err;
+
+	/* less data than a header */
+	if (!ret && ds->probe)
+		ret = min(decomp_stream_probe(ds), 0);
+
+	if (ds->state) {
+		if (decomp_get_ops(ds->comp)->finish(ds->state) && !ret) {
+			printf("%s: compressed data incomplete\n",
+			       genimg_get_comp_name(ds->comp));
+			ret = -EINVAL;
+		}
+		ds->state = NULL;
+	}
+
+	*lenp = ds->out;
+	if (ret || !ds->image)
+		return ret;
+
+	if (ds->data_left || ds->dcrc != image_get_dcrc(hdr)) {
+		puts("Bad Data CRC\n");
+		return -EINVAL;
+	}
+
+	/* turn it into the uncompressed image that was unpacked */
+	image_set_comp(hdr, IH_COMP_NONE);
+	image_set_size(hdr, ds->out);
+	image_set_dcrc(hdr, ds->ocrc);
+	image_set_hcrc(hdr, 0);
+	image_set_hcrc(hdr, crc32(0, (unsigned char *)hdr, sizeof(*hdr)));
+	memcpy(ds->dst - sizeof(*hdr), hdr, sizeof(*hdr));
+	*lenp += sizeof(*hdr);
+
+	return 0;
+}
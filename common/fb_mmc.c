@@ -17,13 +17,13 @@ static char *response_str;
 
 void fastboot_fail(const char *s)
 {
-	strncpy(response_str, "FAIL", 4);
+	strcpy(response_str, "FAIL");
 	strncat(response_str, s, RESPONSE_LEN - 4 - 1);
 }
 
 void fastboot_okay(const char *s)
 {
-	strncpy(response_str, "OKAY", 4);
+	strcpy(response_str, "OKAY");
 	strncat(response_str, s, RESPONSE_LEN - 4 - 1);
 }
 
@@ -59,29 +59,36 @@ static void write_raw_image(block_dev_desc_t *dev_desc, disk_partition_t *info,
 	fastboot_okay("");
 }
 
+static int fb_mmc_find_part(const char *cmd, block_dev_desc_t **dev_desc,
+			    disk_partition_t *info)
+{
+	*dev_desc = get_dev("mmc", CONFIG_FASTBOOT_FLASH_MMC_DEV);
+	if (!*dev_desc || (*dev_desc)->type == DEV_TYPE_UNKNOWN) {
+		error("invalid mmc device\n");
+		fastboot_fail("invalid mmc device");
+		return -1;
+	}
+
+	if (get_partition_info_efi_by_name(*dev_desc, cmd, info)) {
+		error("cannot find partition: '%s'\n", cmd);
+		fastboot_fail("cannot find partition");
+		return -1;
+	}
+
+	return 0;
+}
+
 void fb_mmc_flash_write(const char *cmd, void *download_buffer,
 			unsigned int download_bytes, char *response)
 {
-	int ret;
 	block_dev_desc_t *dev_desc;
 	disk_partition_t info;
 
 	/* initialize the response buffer */
 	response_str = response;
 
-	dev_desc = get_dev("mmc", CONFIG_FASTBOOT_FLASH_MMC_DEV);
-	if (!dev_desc || dev_desc->type == DEV_TYPE_UNKNOWN) {
-		error("invalid mmc device\n");
-		fastboot_fail("invalid mmc device");
+	if (fb_mmc_find_part(cmd, &dev_desc, &info))
 		return;
-	}
-
-	ret = get_partition_info_efi_by_name(dev_desc, cmd, &info);
-	if (ret) {
-		error("cannot find partition: '%s'\n", cmd);
-		fastboot_fail("cannot find partition");
-		return;
-	}
 
 	if (is_sparse_image(download_buffer))
 		write_sparse_image(dev_desc, &info, cmd, download_buffer,
@@ -90,3 +97,43 @@ void fb_mmc_flash_write(const char *cmd, void *download_buffer,
 		write_raw_image(dev_desc, &info, cmd, download_buffer,
 				download_bytes);
 }
+
+#ifdef CONFIG_FASTBOOT_FLASH_STREAM
+static struct sparse_stream fb_stream;
+
+u64 fb_mmc_part_size(const char *cmd, char *response)
+{
+	block_dev_desc_t *dev_desc;
+	disk_partition_t info;
+
+	response_str = response;
+
+	if (fb_mmc_find_part(cmd, &dev_desc, &info))
+		return 0;
+
+	return (u64)info.size * info.blksz;
+}
+
+int fb_mmc_stream_start(const char *cmd, char *response)
+{
+	block_dev_desc_t *dev_desc;
+	disk_partition_t info;
+
+	response_str = response;
+
+	if (fb_mmc_find_part(cmd, &dev_desc, &info))
+		return -1;
+
+	return sparse_stream_init(&fb_stream, dev_desc, &info, cmd);
+}
+
+int fb_mmc_stream_write(const void *data, unsigned int len)
+{
+	return sparse_stream_write(&fb_stream, data, len);
+}
+
+int fb_mmc_stream_finish(void)
+{
+	return sparse_stream_finish(&fb_stream);
+}
+#endif
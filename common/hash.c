@@ -15,12 +15,13 @@
 #include <malloc.h>
 #include <hw_sha.h>
 #include <hash.h>
+#include <watchdog.h>
 #include <u-boot/sha1.h>
 #include <u-boot/sha256.h>
 #include <asm/io.h>
 #include <asm/errno.h>
 
-#ifdef CONFIG_CMD_SHA1SUM
+#if defined(CONFIG_CMD_SHA1SUM) || defined(CONFIG_FIT)
 static int hash_init_sha1(struct hash_algo *algo, void **ctxp)
 {
 	sha1_context *ctx = malloc(sizeof(sha1_context));
@@ -130,7 +131,7 @@ static struct hash_algo hash_algo[] = {
 	 * it bloats the code for boards which use SHA1 but not the 'hash'
 	 * or 'sha1sum' commands.
 	 */
-#ifdef CONFIG_CMD_SHA1SUM
+#if defined(CONFIG_CMD_SHA1SUM) || defined(CONFIG_FIT)
 	{
 		"sha1",
 		SHA1_SUM_LEN,
@@ -139,7 +140,10 @@ static struct hash_algo hash_algo[] = {
 		hash_init_sha1,
 		hash_update_sha1,
 		hash_finish_sha1,
+		sha1_backends,
 	},
+#endif
+#ifdef CONFIG_CMD_SHA1SUM
 #define MULTI_HASH
 #endif
 #ifdef CONFIG_SHA256
@@ -151,6 +155,7 @@ static struct hash_algo hash_algo[] = {
 		hash_init_sha256,
 		hash_update_sha256,
 		hash_finish_sha256,
+		sha256_backends,
 	},
 #define MULTI_HASH
 #endif
@@ -342,6 +347,45 @@ int hash_block(const char *algo_name, const void *data, unsigned int len,
 	return 0;
 }
 
+int hash_copy(void *dst, const void *src, size_t len,
+	      struct hash_copy_op *ops, int count)
+{
+	const void *hashed = dst;
+	size_t n;
+	int i;
+
+	/* A forward copy would overwrite source not yet copied */
+	if (dst > src && dst < src + len) {
+		for (i = 0; i < count; i++) {
+			if (ops[i].algo->hash_update(ops[i].algo, ops[i].ctx,
+						     src, len, 1))
+				return -1;
+		}
+		memmove_wd(dst, (void *)src, len, HASH_COPY_CHUNK);
+		return 0;
+	}
+
+	do {
+		n = min(len, (size_t)HASH_COPY_CHUNK);
+		WATCHDOG_RESET();
+		if (dst != src)
+			memmove(dst, src, n);
+
+		/* the chunk is still in the cache */
+		for (i = 0; i < count; i++) {
+			if (ops[i].algo->hash_update(ops[i].algo, ops[i].ctx,
+						     hashed, n, n == len))
+				return -1;
+		}
+		dst += n;
+		src += n;
+		hashed += n;
+		len -= n;
+	} while (len);
+
+	return 0;
+}
+
 int hash_command(const char *algo_name, int flags, cmd_tbl_t *cmdtp, int flag,
 		 int argc, char * const argv[])
 {
@@ -16,6 +16,7 @@
 #else
 #include <common.h>
 #include <errno.h>
+#include <malloc.h>
 #include <asm/io.h>
 DECLARE_GLOBAL_DATA_PTR;
 #endif /* !USE_HOSTCC*/
@@ -1024,6 +1025,163 @@ error:
 	return 0;
 }
 
+#ifndef USE_HOSTCC
+/* Most hash nodes of an image that are checked during its copy */
+#define FIT_COPY_MAX_HASHES	4
+
+/*
+ * Set up a hash_copy() op for each hash node of an image. Returns 0 if
+ * the image has something the copy cannot check: a signature node, an
+ * algorithm without a chunked interface or too many hash nodes.
+ */
+static int fit_image_copy_hashes(const void *fit, int image_noffset,
+				 struct hash_copy_op *ops, int *hash_noffset,
+				 int *countp)
+{
+	struct hash_algo *hash;
+	int noffset, count = 0;
+	const char *name;
+	char *algo;
+	int ignore;
+
+	for (noffset = fdt_first_subnode(fit, image_noffset);
+	     noffset >= 0;
+	     noffset = fdt_next_subnode(fit, noffset)) {
+		name = fit_get_name(fit, noffset, NULL);
+		if (IMAGE_ENABLE_VERIFY &&
+		    !strncmp(name, FIT_SIG_NODENAME, strlen(FIT_SIG_NODENAME)))
+			goto fallback;
+		if (strncmp(name, FIT_HASH_NODENAME, strlen(FIT_HASH_NODENAME)))
+			continue;
+
+		if (fit_image_hash_get_algo(fit, noffset, &algo))
+			goto fallback;
+		ignore = 0;
+		if (IMAGE_ENABLE_IGNORE)
+			fit_image_hash_get_ignore(fit, noffset, &ignore);
+		if (ignore)
+			continue;
+
+		if (count == FIT_COPY_MAX_HASHES ||
+		    hash_lookup_algo(algo, &hash) || !hash->hash_init ||
+		    hash->digest_size > FIT_MAX_HASH_LEN)
+			goto fallback;
+		hash_noffset[count] = noffset;
+		ops[count].algo = hash;
+		if (hash->hash_init(hash, &ops[count].ctx))
+			goto fallback;
+		count++;
+	}
+	if (noffset != -FDT_ERR_NOTFOUND)
+		goto fallback;
+
+	*countp = count;
+	return 1;
+
+fallback:
+	while (count--)
+		free(ops[count].ctx);
+	return 0;
+}
+
+/**
+ * fit_image_copy_verify - copy an image and verify it in the same pass
+ * @fit: pointer to the FIT format image header
+ * @image_noffset: component image node offset
+ * @dst: where the image data goes
+ *
+ * fit_image_copy_verify() copies the image data to @dst and checks the
+ * hash nodes of the image on the way, so the data is read only once.
+ * Images that cannot be checked during the copy are verified by
+ * fit_image_verify() first and then copied.
+ *
+ * returns:
+ *     1, if all hashes are valid
+ *     0, otherwise (or on error), @dst may then hold part of the data
+ */
+int fit_image_copy_verify(const void *fit, int image_noffset, void *dst)
+{
+	struct hash_copy_op ops[FIT_COPY_MAX_HASHES];
+	int hash_noffset[FIT_COPY_MAX_HASHES];
+	uint8_t value[FIT_MAX_HASH_LEN];
+	uint8_t *fit_value;
+	int fit_value_len;
+	const void *data;
+	size_t size;
+	char *err_msg = "";
+	int verify_all = 1;
+	int noffset = 0;
+	int count, i;
+
+	if (fit_image_get_data(fit, image_noffset, &data, &size)) {
+		err_msg = "Can't get image data/size";
+		goto error;
+	}
+
+	if (!size || !fit_image_copy_hashes(fit, image_noffset, ops,
+					    hash_noffset, &count)) {
+		if (!fit_image_verify(fit, image_noffset))
+			return 0;
+		memmove_wd(dst, (void *)data, size, CHUNKSZ);
+		return 1;
+	}
+
+	/* Required signatures need signature nodes, there are none */
+	if (IMAGE_ENABLE_VERIFY &&
+	    fit_image_verify_required_sigs(fit, image_noffset, data, size,
+					   gd_fdt_blob(), &verify_all)) {
+		err_msg = "Unable to verify required signature";
+		i = 0;
+		goto free;
+	}
+
+	if (hash_copy(dst, data, size, ops, count)) {
+		err_msg = "Hash update failed";
+		i = 0;
+		goto free;
+	}
+
+	for (i = 0; i < count; i++) {
+		noffset = hash_noffset[i];
+		printf("%s", ops[i].algo->name);
+		ops[i].algo->hash_finish(ops[i].algo, ops[i].ctx, value,
+					 sizeof(value));
+		/* FIT stores crc32 values big-endian, see calculate_hash() */
+		if (!strcmp(ops[i].algo->name, "crc32"))
+			*(uint32_t *)value = cpu_to_uimage(*(uint32_t *)value);
+
+		if (fit_image_hash_get_value(fit, noffset, &fit_value,
+					     &fit_value_len)) {
+			err_msg = "Can't get hash value property";
+			i++;
+			goto free;
+		}
+		if (fit_value_len != ops[i].algo->digest_size) {
+			err_msg = "Bad hash value len";
+			i++;
+			goto free;
+		} else if (memcmp(value, fit_value, fit_value_len) != 0) {
+			err_msg = "Bad hash value";
+			i++;
+			goto free;
+		}
+		puts("+ ");
+	}
+
+	return 1;
+
+free:
+	for (; i < count; i++)
+		ops[i].algo->hash_finish(ops[i].algo, ops[i].ctx, value,
+					 sizeof(value));
+error:
+	printf(" error!\n%s for '%s' hash node in '%s' image node\n",
+	       err_msg, fit_get_name(fit, noffset, NULL),
+	       fit_get_name(fit, image_noffset, NULL));
+	return 0;
+}
+#endif /* !USE_HOSTCC */
+
 /**
  * fit_all_image_verify - verify data intergity for all images
  * @fit: pointer to the FIT format image header
@@ -1502,6 +1660,30 @@ static const char *fit_get_image_type_property(int type)
 	return "unknown";
 }
 
+/*
+ * Whether the image data is copied to its load address: by fit_image_load()
+ * itself or, for an uncompressed kernel, by bootm_load_os() later on
+ */
+static int fit_image_load_moves(const void *fit, int noffset, int image_type,
+				enum fit_load_op load_op)
+{
+	const void *buf;
+	size_t size;
+	ulong load;
+
+	if (load_op == FIT_LOAD_IGNORED &&
+	    (image_type != IH_TYPE_KERNEL ||
+	     !fit_image_check_type(fit, noffset, IH_TYPE_KERNEL) ||
+	     !fit_image_check_comp(fit, noffset, IH_COMP_NONE)))
+		return 0;
+	if (fit_image_get_load(fit, noffset, &load) ||
+	    (load_op == FIT_LOAD_OPTIONAL_NON_ZERO && !load) ||
+	    fit_image_get_data(fit, noffset, &buf, &size))
+		return 0;
+
+	return map_to_sysmem((void *)buf) != load;
+}
+
 int fit_image_load(bootm_headers_t *images, ulong addr,
 		   const char **fit_unamep, const char **fit_uname_configp,
 		   int arch, int image_type, int bootstage_id,
@@ -1516,6 +1698,7 @@ int fit_image_load(bootm_headers_t *images, ulong addr,
 	int type_ok, os_ok;
 	ulong load, data, len;
 	const char *prop_name;
+	int copy_verify;
 	int ret;
 
 	fit = map_sysmem(addr, 0);
@@ -1584,7 +1767,17 @@ int fit_image_load(bootm_headers_t *images, ulong addr,
 
 	printf("   Trying '%s' %s subimage\n", fit_uname, prop_name);
 
-	ret = fit_image_select(fit, noffset, images->verify);
+	/*
+	 * Data that goes to a load address is verified while it is copied
+	 * there, rather than read once for the hashes and once for the copy.
+	 * bootm_load_os() does that for the kernel.
+	 */
+	copy_verify = IMAGE_ENABLE_COPY_VERIFY && images->verify &&
+		      fit_image_load_moves(fit, noffset, image_type, load_op);
+	if (image_type == IH_TYPE_KERNEL)
+		images->fit_os_copy_verify = copy_verify &&
+					     load_op == FIT_LOAD_IGNORED;
+	ret = fit_image_select(fit, noffset, images->verify && !copy_verify);
 	if (ret) {
 		bootstage_error(bootstage_id + BOOTSTAGE_SUB_HASH);
 		return ret;
@@ -1679,7 +1872,18 @@ int fit_image_load(bootm_headers_t *images, ulong addr,
 		       prop_name, data, load);
 
 		dst = map_sysmem(load, len);
-		memmove(dst, buf, len);
+		if (copy_verify) {
+			puts("   Verifying Hash Integrity ... ");
+			if (!fit_image_copy_verify(fit, noffset, dst)) {
+				puts("Bad Data Hash\n");
+				bootstage_error(bootstage_id +
+						BOOTSTAGE_SUB_HASH);
+				return -EACCES;
+			}
+			puts("OK\n");
+		} else {
+			memmove(dst, buf, len);
+		}
 		data = load;
 	}
 	bootstage_mark(bootstage_id + BOOTSTAGE_SUB_LOAD);
@@ -2,6 +2,14 @@
 #include <common.h>
 #include <packimg.h>
 #include <aes-packimg.h>
+#include <worker.h>
+#include <decomp_stream.h>
+#include <malloc.h>
+
+#include <linux/sizes.h>
+#ifdef CONFIG_PACKIMG_SHA256
+#include <u-boot/sha256.h>
+#endif
 
 static uint32_t calc_crc(void *buff, int size)
 {
@@ -13,6 +21,237 @@ static uint32_t calc_crc(void *buff, int size)
 }
 
 #define MAX_PACK_ENTRY	8
+#define PACK_HEADER_SIZE \
+	(sizeof(struct pack_header) + sizeof(struct pack_entry) * MAX_PACK_ENTRY)
+
+/*
+ * Check a header just read from the medium, @ph must hold
+ * PACK_HEADER_SIZE bytes. A version 1 header is converted in place to
+ * the version 2 layout.
+ * Returns 0 if the header is valid, -1 otherwise. A wrong magic is not
+ * reported, the callers use it to probe for an image.
+ */
+static int packimg_check_header(struct pack_header *ph)
+{
+	struct pack_entry *pe = (struct pack_entry *)(ph + 1);
+	uint32_t crc, save;
+	int i;
+
+	if (ph->magic != PACK_MAGIC && ph->magic != PACK_MAGIC_V2)
+		return -1;
+
+	if (ph->nentry > MAX_PACK_ENTRY) {
+		printf("packimg has %d entries, only %d supported\n",
+		       ph->nentry, MAX_PACK_ENTRY);
+		return -1;
+	}
+
+	if (ph->magic == PACK_MAGIC) {
+		crc = calc_crc((void *)ph + PACK_V1_HEADER_SIZE,
+			       ph->nentry * PACK_V1_ENTRY_SIZE);
+		if (ph->crc != crc) {
+			printf("packimg head crc error 0x%x should be 0x%x\n",
+			       ph->crc, crc);
+			return -1;
+		}
+
+		/* spread the entries out, last first as they move up */
+		for (i = ph->nentry - 1; i >= 0; i--) {
+			memmove(&pe[i], (void *)ph + PACK_V1_HEADER_SIZE +
+				i * PACK_V1_ENTRY_SIZE, PACK_V1_ENTRY_SIZE);
+			memset(pe[i].digest, 0, sizeof(pe[i].digest));
+		}
+		ph->version = 1;
+		ph->digest = PACK_DIGEST_SUM;
+		return 0;
+	}
+
+	save = ph->crc;
+	ph->crc = 0;
+	crc = crc32(0, (void *)ph, sizeof(*ph) + ph->nentry * sizeof(*pe));
+	ph->crc = save;
+	if (ph->crc != crc) {
+		printf("packimg head crc error 0x%x should be 0x%x\n",
+		       ph->crc, crc);
+		return -1;
+	}
+
+	if (ph->version != PACK_VERSION) {
+		printf("packimg version %d not supported\n", ph->version);
+		return -1;
+	}
+
+	switch (ph->digest) {
+	case PACK_DIGEST_CRC32:
+#ifdef CONFIG_PACKIMG_SHA256
+	case PACK_DIGEST_SHA256:
+#endif
+		return 0;
+	default:
+		printf("packimg digest type %d not supported\n", ph->digest);
+		return -1;
+	}
+}
+
+/*
+ * Running digest of one entry. It is fed chunk by chunk as the entry
+ * comes in from the medium, so checking it needs no second pass over
+ * the loaded data.
+ */
+struct packimg_digest {
+	int type;
+	uint32_t left;			/* bytes not fed yet */
+	uint32_t sum;			/* additive sum or CRC32 */
+	uint32_t next;			/* chunks handed out, core 0 only */
+	volatile uint32_t seq;		/* chunks fed */
+#ifdef CONFIG_PACKIMG_SHA256
+	sha256_context sha;
+#endif
+};
+
+static void packimg_digest_init(struct packimg_digest *d,
+				struct pack_header *ph, struct pack_entry *pe)
+{
+	d->type = ph->digest;
+	d->left = pe->size;
+	d->sum = 0;
+	d->next = 0;
+	d->seq = 0;
+#ifdef CONFIG_PACKIMG_SHA256
+	if (d->type == PACK_DIGEST_SHA256)
+		sha256_starts(&d->sha);
+#endif
+}
+
+/* Chunks must be fed in order and all but the last a multiple of 4 long */
+static void packimg_digest_update(struct packimg_digest *d, void *buf,
+				  uint32_t len)
+{
+	len = min(len, d->left);
+	d->left -= len;
+
+	switch (d->type) {
+	case PACK_DIGEST_SUM:
+		d->sum += calc_crc(buf, len);
+		break;
+	case PACK_DIGEST_CRC32:
+		d->sum = crc32(d->sum, buf, len);
+		break;
+#ifdef CONFIG_PACKIMG_SHA256
+	case PACK_DIGEST_SHA256:
+		sha256_update(&d->sha, buf, len);
+		break;
+#endif
+	}
+}
+
+static int packimg_digest_check(struct packimg_digest *d,
+				struct pack_entry *pe)
+{
+	uint8_t digest[PACK_DIGEST_MAX];
+	uint32_t crc;
+	int len = sizeof(crc);
+
+	if (d->type == PACK_DIGEST_SUM) {
+		if (pe->crc != d->sum) {
+			printf("packimg data crc error 0x%x should be 0x%x\n",
+			       pe->crc, d->sum);
+			return -1;
+		}
+		return 0;
+	}
+
+#ifdef CONFIG_PACKIMG_SHA256
+	if (d->type == PACK_DIGEST_SHA256) {
+		sha256_finish(&d->sha, digest);
+		len = SHA256_SUM_LEN;
+	} else
+#endif
+	{
+		crc = cpu_to_be32(d->sum);
+		memcpy(digest, &crc, sizeof(crc));
+	}
+
+	if (memcmp(pe->digest, digest, len)) {
+		printf("packimg %s digest mismatch\n", pe->name);
+		return -1;
+	}
+	return 0;
+}
+
+/*
+ * Every chunk read from the medium becomes a job that decrypts it (MMC
+ * only) and feeds it to the entry digest. Decryption of different
+ * chunks runs in parallel on the worker cores, the digest update waits
+ * for the previous chunk of the same entry. Chunks are handed out in
+ * order, so the chunk waited for is always running already.
+ */
+#define PACKIMG_JOBS	4
+
+/* Read size for SPI and NAND, the digest of one chunk overlaps the next read */
+#ifndef CONFIG_PACKIMG_CHUNK_SIZE
+#define CONFIG_PACKIMG_CHUNK_SIZE	SZ_128K
+#endif
+
+struct packimg_chunk {
+	struct worker_job job;
+	struct packimg_digest *digest;
+	uint32_t seq;
+	void *buf;
+	uint32_t len;
+	int decrypt;
+};
+
+static struct packimg_chunk packimg_chunk[PACKIMG_JOBS];
+static int packimg_chunk_next;
+
+static void packimg_chunk_fn(void *arg)
+{
+	struct packimg_chunk *c = arg;
+	struct packimg_digest *d = c->digest;
+
+#ifdef CONFIG_AES_PACKIMG
+	if (c->decrypt)
+		aes_dec(c->buf, c->len);
+#endif
+
+	while (d->seq != c->seq)
+		;
+	__sync_synchronize();
+	packimg_digest_update(d, c->buf, c->len);
+	__sync_synchronize();
+	d->seq = c->seq + 1;
+}
+
+static struct packimg_chunk *packimg_feed(struct packimg_digest *d, void *buf,
+					  uint32_t len, int decrypt)
+{
+	struct packimg_chunk *c = &packimg_chunk[packimg_chunk_next];
+
+	packimg_chunk_next = (packimg_chunk_next + 1) % PACKIMG_JOBS;
+	if (c->job.fn)
+		worker_wait(&c->job);
+
+	c->job.fn = packimg_chunk_fn;
+	c->job.arg = c;
+	c->digest = d;
+	c->seq = d->next++;
+	c->buf = buf;
+	c->len = len;
+	c->decrypt = decrypt;
+	worker_submit(&c->job);
+
+	return c;
+}
+
+static void packimg_feed_sync(void)
+{
+	int i;
+
+	for (i = 0; i < PACKIMG_JOBS; i++)
+		if (packimg_chunk[i].job.fn)
+			worker_wait(&packimg_chunk[i].job);
+}
 
 #if defined(CONFIG_SPL_SPI_SUPPORT)
 #include <spi_flash.h>
@@ -25,8 +264,9 @@ int sf_load_packimg(struct spi_flash *flash, uint32_t offs, char *name)
 {
 	struct pack_header *ph;
 	struct pack_entry *pe;
-	uint8_t buf[sizeof(*ph)+sizeof(*pe)*MAX_PACK_ENTRY];
-	uint32_t crc;
+	struct packimg_digest digest[MAX_PACK_ENTRY];
+	uint32_t buf[PACK_HEADER_SIZE / 4];
+	uint32_t done, len;
 	int ret, i;
 
 	ret = spi_flash_read(flash, offs, sizeof(buf), buf);
@@ -38,34 +278,39 @@ int sf_load_packimg(struct spi_flash *flash, uint32_t offs, char *name)
 	pe = (struct pack_entry *)(ph+1);
 
 	// check valid header
-	if (ph->magic != PACK_MAGIC){
+	if (packimg_check_header(ph)) {
 		printf("load packimg from 0x%x fail\n", offs);
 		return -1;
 	}
-	offs+=ret;
-	crc = calc_crc(pe, ph->nentry * sizeof(*pe));
-	if (ph->crc != crc){
-		printf("packimg head crc error 0x%x should be 0x%x\n", ph->crc, crc);
-		return -1;
-	}
-	if(ph->nentry>MAX_PACK_ENTRY){
-		printf("Warning packimg entry %d bigger than %d\n", ph->nentry, MAX_PACK_ENTRY);
-		ph->nentry = MAX_PACK_ENTRY;
-	}
 
-	// load all entries
+	worker_init();
+
+	// load all entries, checking chunk N while chunk N+1 is read
 	for (i = 0; i < ph->nentry; i++){
 		if(name && strcmp(name, pe[i].name)==0) //find target
 			ret = pe[i].ldaddr;
 		
 		debug("load %s@0x%x to ram 0x%x\n", pe[i].name, offs+pe[i].offset, pe[i].ldaddr);
-		spi_flash_read(flash, offs+pe[i].offset, pe[i].size, (void *)pe[i].ldaddr);
-		crc = calc_crc((void *)pe[i].ldaddr, pe[i].size);
-		if (pe[i].crc != crc){
-			printf("packimg data crc error 0x%x should be 0x%x\n", pe[i].crc, crc);
-			return -1;
+		packimg_digest_init(&digest[i], ph, &pe[i]);
+		for (done = 0; done < pe[i].size; done += len) {
+			len = min(pe[i].size - done,
+				  (uint32_t)CONFIG_PACKIMG_CHUNK_SIZE);
+			if (spi_flash_read(flash, offs + pe[i].offset + done,
+					   len, (void *)pe[i].ldaddr + done)) {
+				packimg_feed_sync();
+				printf("%s: load %s failed\n", __func__,
+				       pe[i].name);
+				return -1;
+			}
+			packimg_feed(&digest[i], (void *)pe[i].ldaddr + done,
+				     len, 0);
 		}
 	}
+
+	packimg_feed_sync();
+	for (i = 0; i < ph->nentry; i++)
+		if (packimg_digest_check(&digest[i], &pe[i]))
+			return -1;
 	debug("load packimg success\n");
 	return ret;
 }
@@ -108,70 +353,220 @@ struct pack_entry *mmc_get_packimg_entry_by_index(int index)
 int mmc_load_packimg_header(struct mmc *mmc, uint32_t offs_sector)
 {
 	struct pack_header *ph = mmc_get_packimg_header();
-	struct pack_entry *pe = (struct pack_entry *)(ph + 1);
-	uint32_t crc, nblk;
+	uint32_t nblk;
 	int ret;
 
-	nblk = ROUND_UP(sizeof(*pe) + sizeof(*ph) * MAX_PACK_ENTRY, 
-					mmc->block_dev.log2blksz);
+	nblk = ROUND_UP(PACK_HEADER_SIZE, mmc->block_dev.log2blksz);
 
 	ret = mmc->block_dev.block_read(mmc->block_dev.dev, offs_sector, nblk, (char *)ph);
-	if (ret < 0) {
+	if (ret != nblk) {
 		printf("%s: load head failed\n", __FUNCTION__);
-		return ret;
+		return -1;
 	}
 
 	aes_dec(ph, nblk<<mmc->block_dev.log2blksz);
 
 	// check valid header
-	if (ph->magic != PACK_MAGIC) {
+	if (packimg_check_header(ph)) {
 		printf("mmc load packimg from sector 0x%x fail\n", offs_sector);
 		return -1;
 	}
 
-	crc = calc_crc(pe, ph->nentry * sizeof(*pe));
-	if (ph->crc != crc) {
-		printf("packimg head crc error 0x%x should be 0x%x\n", ph->crc, crc);
+	return 0;
+}
+
+/*
+ * Entries are loaded in chunks of CONFIG_PACKIMG_CHUNK_BLKS blocks so that
+ * the read of chunk N+1 is issued before chunk N is decrypted in place and
+ * fed to the digest. With CONFIG_WORKER both are queued to the secondary
+ * cores, so core 0 can go straight back to the MMC. Hosts with
+ * block_read_async keep transferring chunk N+1 meanwhile, others read it
+ * before returning from blk_read_submit().
+ * Every chunk costs an extra CMD18/CMD12 pair, so keep it large enough
+ * to hide the command overhead.
+ */
+#ifndef CONFIG_PACKIMG_CHUNK_BLKS
+#define CONFIG_PACKIMG_CHUNK_BLKS	2048
+#endif
+
+static void packimg_read_submit(struct mmc *mmc, uint32_t blk, uint32_t cnt,
+				void *dst)
+{
+	blk_read_submit(&mmc->block_dev, blk, cnt, dst);
+}
+
+static int packimg_read_wait(struct mmc *mmc, uint32_t cnt)
+{
+	if (blk_read_wait(&mmc->block_dev) != cnt)
 		return -1;
+	return 0;
+}
+
+#ifdef CONFIG_DECOMP_STREAM
+/*
+ * Check whether an entry is a legacy image with a payload that can be
+ * decompressed while it is read. @hdr returns the image header.
+ */
+static int packimg_entry_compressed(struct mmc *mmc, uint32_t blk,
+				    image_header_t *hdr)
+{
+	ALLOC_CACHE_ALIGN_BUFFER(uint8_t, buf, 1 << mmc->block_dev.log2blksz);
+
+	if (mmc->block_dev.block_read(mmc->block_dev.dev, blk, 1, buf) != 1)
+		return 0;
+	aes_dec(buf, 1 << mmc->block_dev.log2blksz);
+	memcpy(hdr, buf, sizeof(*hdr));
+
+	return image_check_magic(hdr) &&
+	       image_get_type(hdr) != IH_TYPE_MULTI &&
+	       image_get_comp(hdr) != IH_COMP_NONE &&
+	       decomp_stream_supported(image_get_comp(hdr));
+}
+
+/*
+ * Load a compressed legacy image entry straight into the uncompressed
+ * image it holds, at the load address of the payload minus the header so
+ * bootm runs it in place. The compressed data only passes through three
+ * bounce buffers: while the MMC fills chunk N+1, a worker decrypts chunk
+ * N and feeds it to the digest, and core 0 decompresses chunk N-1.
+ * On success the entry is updated to describe the unpacked image.
+ */
+static int mmc_stream_packimg_entry(struct mmc *mmc, uint32_t blk,
+				    struct pack_entry *pe, image_header_t *hdr)
+{
+	int log2blksz = mmc->block_dev.log2blksz;
+	uint32_t chunk_blks = CONFIG_DECOMP_STREAM_CHUNK >> log2blksz;
+	struct packimg_chunk *c, *prev = NULL;
+	struct packimg_digest digest;
+	struct decomp_stream ds;
+	uint32_t nblk, cur, next, left, len;
+	uint8_t *buf[3];
+	ulong dst, size;
+	int i = 0, err, ret;
+
+	buf[0] = memalign(ARCH_DMA_MINALIGN, 3 * CONFIG_DECOMP_STREAM_CHUNK);
+	if (!buf[0])
+		return -1;
+	buf[1] = buf[0] + CONFIG_DECOMP_STREAM_CHUNK;
+	buf[2] = buf[1] + CONFIG_DECOMP_STREAM_CHUNK;
+
+	dst = image_get_load(hdr) - sizeof(*hdr);
+	debug("unpack %s@0x%x to ram 0x%lx\n", pe->name, blk, dst);
+
+	packimg_digest_init(&digest, mmc_get_packimg_header(), pe);
+	decomp_stream_init_image(&ds, (void *)dst, DECOMP_STREAM_ROOM);
+
+	nblk = ROUND_UP(pe->size, log2blksz);
+	left = pe->size;
+	cur = min(nblk, chunk_blks);
+	packimg_read_submit(mmc, blk, cur, buf[0]);
+	err = packimg_read_wait(mmc, cur);
+
+	while (!err && nblk) {
+		blk += cur;
+		nblk -= cur;
+		next = min(nblk, chunk_blks);
+
+		if (next)
+			packimg_read_submit(mmc, blk, next, buf[(i + 1) % 3]);
+
+		c = packimg_feed(&digest, buf[i], cur << log2blksz, 1);
+		if (prev) {
+			worker_wait(&prev->job);
+			len = min(left, prev->len);
+			left -= len;
+			err = min(decomp_stream_feed(&ds, prev->buf, len), 0);
+		}
+		prev = c;
+
+		if (next && packimg_read_wait(mmc, next))
+			err = -1;
+
+		i = (i + 1) % 3;
+		cur = next;
 	}
 
-	if (ph->nentry > MAX_PACK_ENTRY) {
-		printf("Warning packimg entry %d bigger than %d\n", ph->nentry, MAX_PACK_ENTRY);
-		ph->nentry = MAX_PACK_ENTRY;
+	packimg_feed_sync();
+	if (!err && prev) {
+		len = min(left, prev->len);
+		err = min(decomp_stream_feed(&ds, prev->buf, len), 0);
 	}
+	ret = decomp_stream_finish(&ds, &size);
+	free(buf[0]);
+
+	if (err || ret) {
+		printf("unpack packimg entry %s fail\n", pe->name);
+		return -1;
+	}
+	if (packimg_digest_check(&digest, pe))
+		return -1;
+
+	pe->ldaddr = dst;
+	pe->size = size;
 
 	return 0;
 }
+#endif
 
 int mmc_load_packimg_entry(struct mmc *mmc, uint32_t offs_sector, struct pack_entry *pe)
 {
-	uint32_t nblk;
+	int log2blksz = mmc->block_dev.log2blksz;
+	struct packimg_digest digest;
+	uint32_t blk, nblk, cur, next;
+	uint8_t *dst;
 	int err;
 
-	debug("load %s@0x%x to ram 0x%x\n", pe->name,
-		  offs_sector + (pe->offset >> mmc->block_dev.log2blksz),
-		  pe->ldaddr);
+	blk = offs_sector + (pe->offset >> log2blksz);
+	nblk = ROUND_UP(pe->size, log2blksz);
+	dst = (uint8_t *)pe->ldaddr;
 
-	nblk = ROUND_UP(pe->size, mmc->block_dev.log2blksz);
+	worker_init();
 
-	err = mmc->block_dev.block_read(mmc->block_dev.dev,
-		  offs_sector + (pe->offset >> mmc->block_dev.log2blksz),
-		  nblk, (void *)pe->ldaddr);
-	if (err < 0) {
-		printf("load packimg entry fail\n");
-		return err;
+#ifdef CONFIG_DECOMP_STREAM
+	{
+		image_header_t hdr;
+
+		if (packimg_entry_compressed(mmc, blk, &hdr))
+			return mmc_stream_packimg_entry(mmc, blk, pe, &hdr);
 	}
+#endif
 
-	aes_dec(pe->ldaddr, nblk<<mmc->block_dev.log2blksz);
+	debug("load %s@0x%x to ram 0x%x\n", pe->name, blk, pe->ldaddr);
 
-#if 0
-	crc = calc_crc((void *)pe->ldaddr, pe->size);
-	if (pe->crc != crc){
-		printf("packimg data crc error 0x%x should be 0x%x\n", pe->crc, crc);
-		return -1;
+	packimg_digest_init(&digest, mmc_get_packimg_header(), pe);
+
+	cur = min(nblk, (uint32_t)CONFIG_PACKIMG_CHUNK_BLKS);
+	packimg_read_submit(mmc, blk, cur, dst);
+	err = packimg_read_wait(mmc, cur);
+
+	while (!err && nblk) {
+		blk += cur;
+		nblk -= cur;
+		next = min(nblk, (uint32_t)CONFIG_PACKIMG_CHUNK_BLKS);
+
+		/* start fetching chunk N+1 ... */
+		if (next)
+			packimg_read_submit(mmc, blk, next,
+					    dst + (cur << log2blksz));
+
+		/* ... while chunk N is decrypted and checked in place */
+		packimg_feed(&digest, dst, cur << log2blksz, 1);
+
+		if (next)
+			err = packimg_read_wait(mmc, next);
+
+		dst += cur << log2blksz;
+		cur = next;
 	}
-#endif
-	return 0;
+
+	packimg_feed_sync();
+
+	if (err) {
+		printf("load packimg entry fail\n");
+		return err;
+	}
+
+	return packimg_digest_check(&digest, pe);
 }
 
 int mmc_load_packimg(struct mmc *mmc, uint32_t offs_sector)
@@ -206,19 +601,22 @@ int mmc_load_packimg(struct mmc *mmc, uint32_t offs_sector)
 int nand_packimg_read(nand_info_t *nand, uint32_t nand_off, uint32_t nand_size)
 {
 	int i, err;
-	size_t size;
-	char buff[512];
+	size_t size, actual;
+	uint32_t buff[PACK_HEADER_SIZE / 4];
 	struct pack_header *ph;
 	struct pack_entry *pe;
-	uint32_t offs = nand_off, crc;
+	struct packimg_digest digest[MAX_PACK_ENTRY];
+	uint32_t offs = nand_off, from, done;
 
 	if ((nand_off & (nand->erasesize - 1)) || (nand_size & (nand->erasesize - 1))) {
 		printf("offset %x and size %x must be block aligned\n", nand_off, nand_size);
 		return -1;
 	}
 
+	worker_init();
+
 	while (offs < nand_off + nand_size) {
-		size = 512;
+		size = sizeof(buff);
 		err = nand_read_skip_bad(nand, offs, &size, NULL, nand->size, (void *)buff);
 		if (err) {
 			printf("nand read offset %x fail\n", offs);
@@ -228,26 +626,36 @@ int nand_packimg_read(nand_info_t *nand, uint32_t nand_off, uint32_t nand_size)
 		pe = (void *)buff + sizeof(*ph);
 
 		// check valid header
-		if (ph->magic != PACK_MAGIC)
-			goto next_block;
-		crc = calc_crc(pe, ph->nentry * sizeof(*pe));
-		if (ph->crc != crc)
+		if (packimg_check_header(ph))
 			goto next_block;
 
-		// load all entries
+		// load all entries, checking chunk N while chunk N+1 is read
 		for (i = 0; i < ph->nentry; i++) {
-			size = pe[i].size;
-			err = nand_read_skip_bad(nand, offs + pe[i].offset, &size, NULL, nand->size, (void *)pe[i].ldaddr);
-			if (err) {
-				printf("nand read offset %x size %x to %x fail\n",
-					   offs + pe[i].offset, pe[i].size, pe[i].ldaddr);
-				return err;
+			packimg_digest_init(&digest[i], ph, &pe[i]);
+			from = offs + pe[i].offset;
+			for (done = 0; done < pe[i].size; done += size) {
+				size = min(pe[i].size - done,
+					   (uint32_t)CONFIG_PACKIMG_CHUNK_SIZE);
+				err = nand_read_skip_bad(nand, from, &size, &actual, nand->size,
+							 (void *)pe[i].ldaddr + done);
+				if (err) {
+					packimg_feed_sync();
+					printf("nand read offset %x size %x to %x fail\n",
+					       from, size, pe[i].ldaddr + done);
+					return err;
+				}
+				packimg_feed(&digest[i], (void *)pe[i].ldaddr + done,
+					     size, 0);
+				/* skip the bad blocks the read stepped over */
+				from += actual;
 			}
-			crc = calc_crc((void *)pe[i].ldaddr, pe[i].size);
-			if (pe[i].crc != crc)
-				goto next_block;
 		}
 
+		packimg_feed_sync();
+		for (i = 0; i < ph->nentry; i++)
+			if (packimg_digest_check(&digest[i], &pe[i]))
+				goto next_block;
+
 		printf("load packimg at %x success\n", offs);
 		return 0;
 
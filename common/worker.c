@@ -0,0 +1,128 @@
+/*
+ * Worker cores, see include/worker.h
+ *
+ * Each worker owns one mailbox, padded to a cache line so that polling
+ * cores do not share lines. Core 0 posts a job into an empty mailbox and
+ * the worker clears it again once the job is done.
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+#include <common.h>
+#include <worker.h>
+
+#ifndef CONFIG_SYS_WORKER_CORES
+#define CONFIG_SYS_WORKER_CORES	3
+#endif
+
+struct worker_mailbox {
+	struct worker_job *volatile job;
+	volatile int running;
+} __aligned(ARCH_DMA_MINALIGN);
+
+static struct worker_mailbox mailbox[CONFIG_SYS_WORKER_CORES];
+static int nr_workers = -1;
+
+static void worker_main(int cpu)
+{
+	struct worker_mailbox *mb = &mailbox[cpu - 1];
+	struct worker_job *job;
+
+	mb->running = 1;
+	__sync_synchronize();
+
+	while (mb->running) {
+		job = mb->job;
+		if (!job) {
+			arch_worker_idle();
+			continue;
+		}
+
+		job->fn(job->arg);
+
+		__sync_synchronize();
+		job->done = 1;
+		mb->job = NULL;
+		__sync_synchronize();
+		arch_worker_kick();
+	}
+}
+
+int worker_init(void)
+{
+	ulong start;
+	int cpu;
+
+	if (nr_workers >= 0)
+		return nr_workers;
+
+	nr_workers = 0;
+	for (cpu = 1; cpu <= CONFIG_SYS_WORKER_CORES; cpu++) {
+		if (arch_worker_start(cpu, worker_main))
+			break;
+
+		start = get_timer(0);
+		while (!mailbox[cpu - 1].running) {
+			if (get_timer(start) > 100) {
+				printf("worker: core %d did not come up\n", cpu);
+				arch_worker_stop(cpu);
+				goto out;
+			}
+		}
+		nr_workers++;
+	}
+
+out:
+
+	debug("%s: %d worker cores\n", __func__, nr_workers);
+	return nr_workers;
+}
+
+void worker_submit(struct worker_job *job)
+{
+	int i;
+
+	job->done = 0;
+
+	if (nr_workers <= 0) {
+		job->fn(job->arg);
+		job->done = 1;
+		return;
+	}
+
+	__sync_synchronize();
+	for (;;) {
+		for (i = 0; i < nr_workers; i++) {
+			if (mailbox[i].running && !mailbox[i].job) {
+				mailbox[i].job = job;
+				__sync_synchronize();
+				arch_worker_kick();
+				return;
+			}
+		}
+		arch_worker_idle();
+	}
+}
+
+void worker_wait(struct worker_job *job)
+{
+	while (!job->done)
+		arch_worker_idle();
+	__sync_synchronize();
+}
+
+void worker_stop(void)
+{
+	int i;
+
+	for (i = 0; i < nr_workers; i++) {
+		while (mailbox[i].job)
+			arch_worker_idle();
+		mailbox[i].running = 0;
+		__sync_synchronize();
+		arch_worker_kick();
+		arch_worker_stop(i + 1);
+	}
+
+	nr_workers = 0;
+}
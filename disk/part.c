@@ -251,6 +251,9 @@ void dev_print (block_dev_desc_t *dev_desc)
 
 void init_part(block_dev_desc_t *dev_desc)
 {
+	/* The device was (re)scanned, it may hold a different medium now */
+	blkcache_invalidate(dev_desc->if_type, dev_desc->dev);
+
 #ifdef CONFIG_ISO_PARTITION
 	if (test_part_iso(dev_desc) == 0) {
 		dev_desc->part_type = PART_TYPE_ISO;
@@ -0,0 +1,180 @@
+/*
+ * Block read cache
+ *
+ * Filesystems and partition tables read the same metadata blocks over
+ * and over: every "ls" or "load" in a boot script mounts again and
+ * re-reads the superblock, group descriptors, FAT sectors or the GPT.
+ * Small reads through blk_dread() are kept here, keyed by interface,
+ * device and block, and evicted least recently used first. Writes go
+ * straight to the device. The write function of every block driver drops
+ * the device's entries, so writes that bypass blk_dwrite() ("usb write",
+ * "sata write", ...) cannot leave stale blocks behind.
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+#include <common.h>
+#include <malloc.h>
+#include <part.h>
+#include <linux/list.h>
+
+#ifndef CONFIG_BLOCK_CACHE_BLOCKS
+#define CONFIG_BLOCK_CACHE_BLOCKS	32
+#endif
+#ifndef CONFIG_BLOCK_CACHE_ENTRIES
+#define CONFIG_BLOCK_CACHE_ENTRIES	32
+#endif
+
+struct blkcache_node {
+	struct list_head lh;
+	int iftype;
+	int devnum;
+	lbaint_t start;
+	lbaint_t blkcnt;
+	unsigned long blksz;
+	char *cache;
+};
+
+/* Most recently used first */
+static LIST_HEAD(blkcache);
+
+static struct blkcache_stats stats = {
+	.max_blocks_per_entry = CONFIG_BLOCK_CACHE_BLOCKS,
+	.max_entries = CONFIG_BLOCK_CACHE_ENTRIES,
+};
+
+static void blkcache_free_node(struct blkcache_node *node)
+{
+	list_del(&node->lh);
+	free(node->cache);
+	free(node);
+	stats.entries--;
+}
+
+static struct blkcache_node *blkcache_find(block_dev_desc_t *dev_desc,
+					   lbaint_t start, lbaint_t blkcnt)
+{
+	struct blkcache_node *node;
+
+	list_for_each_entry(node, &blkcache, lh) {
+		if (node->iftype == dev_desc->if_type &&
+		    node->devnum == dev_desc->dev &&
+		    node->blksz == dev_desc->blksz &&
+		    node->start <= start &&
+		    node->start + node->blkcnt >= start + blkcnt) {
+			/* move to the front */
+			list_move(&node->lh, &blkcache);
+			return node;
+		}
+	}
+
+	return NULL;
+}
+
+static void blkcache_fill(block_dev_desc_t *dev_desc, lbaint_t start,
+			  lbaint_t blkcnt, const void *buffer)
+{
+	struct blkcache_node *node;
+	size_t bytes = blkcnt * dev_desc->blksz;
+
+	if (blkcnt > stats.max_blocks_per_entry || !stats.max_entries)
+		return;
+
+	/* reuse the least recently used entry once the cache is full */
+	if (stats.entries >= stats.max_entries) {
+		node = list_entry(blkcache.prev, struct blkcache_node, lh);
+		list_del(&node->lh);
+		stats.entries--;
+		if (node->blkcnt * node->blksz < bytes) {
+			free(node->cache);
+			node->cache = NULL;
+		}
+	} else {
+		node = calloc(1, sizeof(*node));
+		if (!node)
+			return;
+	}
+
+	if (!node->cache) {
+		node->cache = malloc(bytes);
+		if (!node->cache) {
+			free(node);
+			return;
+		}
+	}
+
+	node->iftype = dev_desc->if_type;
+	node->devnum = dev_desc->dev;
+	node->start = start;
+	node->blkcnt = blkcnt;
+	node->blksz = dev_desc->blksz;
+	memcpy(node->cache, buffer, bytes);
+	list_add(&node->lh, &blkcache);
+	stats.entries++;
+}
+
+unsigned long blk_dread(block_dev_desc_t *dev_desc, lbaint_t start,
+			lbaint_t blkcnt, void *buffer)
+{
+	struct blkcache_node *node;
+	unsigned long blks;
+
+	if (blkcnt <= stats.max_blocks_per_entry) {
+		node = blkcache_find(dev_desc, start, blkcnt);
+		if (node) {
+			memcpy(buffer, node->cache +
+			       (start - node->start) * dev_desc->blksz,
+			       blkcnt * dev_desc->blksz);
+			stats.hits++;
+			return blkcnt;
+		}
+		stats.misses++;
+	}
+
+	blks = dev_desc->block_read(dev_desc->dev, start, blkcnt, buffer);
+	if (blks == blkcnt)
+		blkcache_fill(dev_desc, start, blkcnt, buffer);
+
+	return blks;
+}
+
+unsigned long blk_dwrite(block_dev_desc_t *dev_desc, lbaint_t start,
+			 lbaint_t blkcnt, const void *buffer)
+{
+	blkcache_invalidate(dev_desc->if_type, dev_desc->dev);
+
+	return dev_desc->block_write(dev_desc->dev, start, blkcnt, buffer);
+}
+
+void blkcache_invalidate(int iftype, int devnum)
+{
+	struct blkcache_node *node, *tmp;
+
+	list_for_each_entry_safe(node, tmp, &blkcache, lh) {
+		if (node->iftype == iftype && node->devnum == devnum)
+			blkcache_free_node(node);
+	}
+}
+
+void blkcache_configure(unsigned blocks, unsigned entries)
+{
+	struct blkcache_node *node, *tmp;
+
+	if (blocks != stats.max_blocks_per_entry ||
+	    entries != stats.max_entries) {
+		list_for_each_entry_safe(node, tmp, &blkcache, lh)
+			blkcache_free_node(node);
+	}
+
+	stats.max_blocks_per_entry = blocks;
+	stats.max_entries = entries;
+	stats.hits = 0;
+	stats.misses = 0;
+}
+
+void blkcache_stats(struct blkcache_stats *blkstats)
+{
+	*blkstats = stats;
+	stats.hits = 0;
+	stats.misses = 0;
+}
@@ -46,6 +46,8 @@ static unsigned long host_block_write(int dev, unsigned long start,
 				      lbaint_t blkcnt, const void *buffer)
 {
 	struct host_block_dev *host_dev = find_host_device(dev);
+
+	blkcache_invalidate(IF_TYPE_HOST, dev);
 	if (os_lseek(host_dev->fd,
 		     start * host_dev->blk_dev.blksz,
 		     OS_SEEK_SET) == -1) {
@@ -59,6 +61,40 @@ static unsigned long host_block_write(int dev, unsigned long start,
 	return -1;
 }
 
+/*
+ * The host has no DMA engine, so an async read is only recorded here and
+ * carried out by the second poll. That keeps the buffer untouched while
+ * the read is in flight, as it would be on real hardware.
+ */
+static int host_block_read_async(int dev, lbaint_t start, lbaint_t blkcnt,
+				 void *buffer)
+{
+	struct host_block_dev *host_dev = find_host_device(dev);
+
+	if (!host_dev)
+		return -1;
+
+	host_dev->async_start = start;
+	host_dev->async_blkcnt = blkcnt;
+	host_dev->async_buffer = buffer;
+	host_dev->async_polls = 0;
+
+	return 0;
+}
+
+static int host_block_read_poll(int dev, unsigned long *blkread)
+{
+	struct host_block_dev *host_dev = find_host_device(dev);
+
+	if (!host_dev->async_polls++)
+		return -EBUSY;
+
+	*blkread = host_block_read(dev, host_dev->async_start,
+				   host_dev->async_blkcnt,
+				   host_dev->async_buffer);
+	return 0;
+}
+
 int host_dev_bind(int dev, char *filename)
 {
 	struct host_block_dev *host_dev = find_host_device(dev);
@@ -92,6 +128,8 @@ int host_dev_bind(int dev, char *filename)
 	blk_dev->lba = os_lseek(host_dev->fd, 0, OS_SEEK_END) / blk_dev->blksz;
 	blk_dev->block_read = host_block_read;
 	blk_dev->block_write = host_block_write;
+	blk_dev->block_read_async = host_block_read_async;
+	blk_dev->block_read_poll = host_block_read_poll;
 	blk_dev->dev = dev;
 	blk_dev->part_type = PART_TYPE_UNKNOWN;
 	init_part(blk_dev);
@@ -20,9 +20,24 @@
 #include <fsl_esdhc.h>
 #include <fdt_support.h>
 #include <asm/io.h>
+#ifdef CONFIG_FSL_ESDHC_ADMA2
+#include <sdhci.h>
+#endif
 
 DECLARE_GLOBAL_DATA_PTR;
 
+#ifdef CONFIG_FSL_ESDHC_ADMA2
+#ifdef CONFIG_SYS_FSL_ESDHC_USE_PIO
+#error "CONFIG_FSL_ESDHC_ADMA2 and CONFIG_SYS_FSL_ESDHC_USE_PIO are exclusive"
+#endif
+/*
+ * With ADMA2 the host follows a descriptor table instead of a single
+ * SDMA address, so a transfer may be scattered over several buffers.
+ */
+static struct sdhci_adma_desc esdhc_adma_table[SDHCI_ADMA_DESC_COUNT]
+	__aligned(ARCH_DMA_MINALIGN);
+#endif
+
 struct fsl_esdhc {
 	uint    dsaddr;		/* SDMA system address register */
 	uint    blkattr;	/* Block attributes register */
@@ -186,11 +201,11 @@ static int esdhc_setup_data(struct mmc *mmc, struct mmc_data *data)
 			wml_value = WML_RD_WML_MAX_VAL;
 
 		esdhc_clrsetbits32(&regs->wml, WML_RD_WML_MASK, wml_value);
-#ifndef CONFIG_SYS_FSL_ESDHC_USE_PIO
+#if !defined(CONFIG_SYS_FSL_ESDHC_USE_PIO) && !defined(CONFIG_FSL_ESDHC_ADMA2)
 		esdhc_write32(&regs->dsaddr, (u32)data->dest);
 #endif
 	} else {
-#ifndef CONFIG_SYS_FSL_ESDHC_USE_PIO
+#if !defined(CONFIG_SYS_FSL_ESDHC_USE_PIO) && !defined(CONFIG_FSL_ESDHC_ADMA2)
 		flush_dcache_range((ulong)data->src,
 				   (ulong)data->src+data->blocks
 					 *data->blocksize);
@@ -204,11 +219,19 @@ static int esdhc_setup_data(struct mmc *mmc, struct mmc_data *data)
 
 		esdhc_clrsetbits32(&regs->wml, WML_WR_WML_MASK,
 					wml_value << 16);
-#ifndef CONFIG_SYS_FSL_ESDHC_USE_PIO
+#if !defined(CONFIG_SYS_FSL_ESDHC_USE_PIO) && !defined(CONFIG_FSL_ESDHC_ADMA2)
 		esdhc_write32(&regs->dsaddr, (u32)data->src);
 #endif
 	}
 
+#ifdef CONFIG_FSL_ESDHC_ADMA2
+	if (sdhci_adma_prepare(esdhc_adma_table, data)) {
+		printf("%s: unaligned or too scattered buffer\n", __func__);
+		return COMM_ERR;
+	}
+	esdhc_write32(&regs->adsaddr, (u32)esdhc_adma_table);
+#endif
+
 	esdhc_write32(&regs->blkattr, data->blocks << 16 | data->blocksize);
 
 	/* Calculate the timeout period for data transactions */
@@ -248,7 +271,7 @@ static int esdhc_setup_data(struct mmc *mmc, struct mmc_data *data)
 	return 0;
 }
 
-#ifndef CONFIG_SYS_FSL_ESDHC_USE_PIO
+#if !defined(CONFIG_SYS_FSL_ESDHC_USE_PIO) && !defined(CONFIG_FSL_ESDHC_ADMA2)
 static void check_and_invalidate_dcache_range
 	(struct mmc_cmd *cmd,
 	 struct mmc_data *data) {
@@ -388,8 +411,12 @@ esdhc_send_cmd(struct mmc *mmc, struct mmc_cmd *cmd, struct mmc_data *data)
 			}
 		} while ((irqstat & DATA_COMPLETE) != DATA_COMPLETE);
 
+#ifdef CONFIG_FSL_ESDHC_ADMA2
+		sdhci_adma_complete(data);
+#else
 		if (data->flags & MMC_DATA_READ)
 			check_and_invalidate_dcache_range(cmd, data);
+#endif
 #endif
 	}
 
@@ -504,6 +531,9 @@ static int esdhc_init(struct mmc *mmc)
 
 	/* Put the PROCTL reg back to the default */
 	esdhc_write32(&regs->proctl, PROCTL_INIT);
+#ifdef CONFIG_FSL_ESDHC_ADMA2
+	esdhc_clrsetbits32(&regs->proctl, PROCTL_DMAS_MASK, PROCTL_DMAS_ADMA2);
+#endif
 
 	/* Set timout to the maximum value */
 	esdhc_clrsetbits32(&regs->sysctl, SYSCTL_TIMEOUT_MASK, 14 << 16);
@@ -611,6 +641,10 @@ int fsl_esdhc_initialize(bd_t *bis, struct fsl_esdhc_cfg *cfg)
 	if (caps & ESDHC_HOSTCAPBLT_HSS)
 		cfg->cfg.host_caps |= MMC_MODE_HS_52MHz | MMC_MODE_HS;
 
+#ifdef CONFIG_FSL_ESDHC_ADMA2
+	cfg->cfg.host_caps |= MMC_MODE_SG;
+#endif
+
 #ifdef CONFIG_ESDHC_DETECT_8_BIT_QUIRK
 	if (CONFIG_ESDHC_DETECT_8_BIT_QUIRK)
 		cfg->cfg.host_caps &= ~MMC_MODE_8BIT;
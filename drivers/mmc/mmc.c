@@ -188,13 +188,13 @@ struct mmc *find_mmc_device(int dev_num)
 	return NULL;
 }
 
-static int mmc_read_blocks(struct mmc *mmc, void *dst, lbaint_t start,
-			   lbaint_t blkcnt)
+/* Read data->blocks blocks from start, data->dest or data->sg is set up */
+static int mmc_read_start(struct mmc *mmc, struct mmc_data *data,
+			  lbaint_t start)
 {
 	struct mmc_cmd cmd;
-	struct mmc_data data;
 
-	if (blkcnt > 1)
+	if (data->blocks > 1)
 		cmd.cmdidx = MMC_CMD_READ_MULTIPLE_BLOCK;
 	else
 		cmd.cmdidx = MMC_CMD_READ_SINGLE_BLOCK;
@@ -206,15 +206,17 @@ static int mmc_read_blocks(struct mmc *mmc, void *dst, lbaint_t start,
 
 	cmd.resp_type = MMC_RSP_R1;
 
-	data.dest = dst;
-	data.blocks = blkcnt;
-	data.blocksize = mmc->read_bl_len;
-	data.flags = MMC_DATA_READ;
+	data->blocksize = mmc->read_bl_len;
+	data->flags |= MMC_DATA_READ;
 
-	if (mmc_send_cmd(mmc, &cmd, &data))
-		return 0;
+	return mmc_send_cmd(mmc, &cmd, data);
+}
+
+static int mmc_read_stop(struct mmc *mmc, struct mmc_data *data)
+{
+	struct mmc_cmd cmd;
 
-	if (blkcnt > 1) {
+	if (data->blocks > 1) {
 		cmd.cmdidx = MMC_CMD_STOP_TRANSMISSION;
 		cmd.cmdarg = 0;
 		cmd.resp_type = MMC_RSP_R1b;
@@ -226,7 +228,28 @@ static int mmc_read_blocks(struct mmc *mmc, void *dst, lbaint_t start,
 		}
 	}
 
-	return blkcnt;
+	return data->blocks;
+}
+
+static int mmc_read_data(struct mmc *mmc, struct mmc_data *data,
+			 lbaint_t start)
+{
+	if (mmc_read_start(mmc, data, start))
+		return 0;
+
+	return mmc_read_stop(mmc, data);
+}
+
+static int mmc_read_blocks(struct mmc *mmc, void *dst, lbaint_t start,
+			   lbaint_t blkcnt)
+{
+	struct mmc_data data;
+
+	data.dest = dst;
+	data.blocks = blkcnt;
+	data.flags = 0;
+
+	return mmc_read_data(mmc, &data, start);
 }
 
 static ulong mmc_bread(int dev_num, lbaint_t start, lbaint_t blkcnt, void *dst)
@@ -264,6 +287,126 @@ static ulong mmc_bread(int dev_num, lbaint_t start, lbaint_t blkcnt, void *dst)
 	return blkcnt;
 }
 
+/*
+ * Start one CMD18 and return while the host moves the data. Reads the
+ * host cannot do in one command, or hosts without data_poll, return -1
+ * so that the caller falls back to mmc_bread().
+ */
+static int mmc_bread_async(int dev_num, lbaint_t start, lbaint_t blkcnt,
+			   void *dst)
+{
+	struct mmc *mmc = find_mmc_device(dev_num);
+	struct mmc_data *data;
+
+	if (!mmc || !mmc->cfg->ops->data_poll || !blkcnt ||
+	    blkcnt > mmc->cfg->b_max || start + blkcnt > mmc->block_dev.lba)
+		return -1;
+
+	if (mmc_set_blocklen(mmc, mmc->read_bl_len))
+		return -1;
+
+	data = &mmc->async_data;
+	data->dest = dst;
+	data->blocks = blkcnt;
+	data->flags = MMC_DATA_ASYNC;
+
+	return mmc_read_start(mmc, data, start);
+}
+
+static int mmc_bread_poll(int dev_num, unsigned long *blkread)
+{
+	struct mmc *mmc = find_mmc_device(dev_num);
+	struct mmc_data *data = &mmc->async_data;
+	int err;
+
+	err = mmc->cfg->ops->data_poll(mmc, data);
+	if (err == -EBUSY)
+		return err;
+
+	*blkread = err ? 0 : mmc_read_stop(mmc, data);
+	return 0;
+}
+
+ulong mmc_bread_sg(int dev_num, lbaint_t start, struct mmc_sg *sg,
+		   uint sg_len)
+{
+	struct mmc_sg part[MMC_SG_MAX];
+	struct mmc_data data;
+	struct mmc *mmc;
+	lbaint_t blkcnt = 0, cur, seg, off;
+	uint bl_len, i, n;
+
+	mmc = find_mmc_device(dev_num);
+	if (!mmc)
+		return 0;
+
+	bl_len = mmc->read_bl_len;
+	for (i = 0; i < sg_len; i++) {
+		if (sg[i].len % bl_len)
+			return 0;
+		blkcnt += sg[i].len / bl_len;
+	}
+
+	if (!(mmc->cfg->host_caps & MMC_MODE_SG)) {
+		for (i = 0; i < sg_len; start += sg[i].len / bl_len, i++)
+			if (sg[i].len &&
+			    mmc_bread(dev_num, start, sg[i].len / bl_len,
+				      sg[i].addr) != sg[i].len / bl_len)
+				return 0;
+		return blkcnt;
+	}
+
+	if (!blkcnt)
+		return 0;
+
+	if ((start + blkcnt) > mmc->block_dev.lba) {
+#if !defined(CONFIG_SPL_BUILD) || defined(CONFIG_SPL_LIBCOMMON_SUPPORT)
+		printf("MMC: block number 0x" LBAF " exceeds max(0x" LBAF ")\n",
+			start + blkcnt, mmc->block_dev.lba);
+#endif
+		return 0;
+	}
+
+	if (mmc_set_blocklen(mmc, bl_len))
+		return 0;
+
+	/* Gather up to b_max blocks from as many buffers as fit per command */
+	i = 0;
+	off = 0;
+	while (i < sg_len) {
+		for (n = 0, cur = 0; i < sg_len && n < MMC_SG_MAX &&
+		     cur < mmc->cfg->b_max; ) {
+			seg = sg[i].len / bl_len - off;
+			if (seg > mmc->cfg->b_max - cur)
+				seg = mmc->cfg->b_max - cur;
+			if (seg) {
+				part[n].addr = sg[i].addr + off * bl_len;
+				part[n].len = seg * bl_len;
+				n++;
+				cur += seg;
+				off += seg;
+			}
+			if (off == sg[i].len / bl_len) {
+				i++;
+				off = 0;
+			}
+		}
+
+		if (!n)
+			break;
+
+		data.sg = part;
+		data.sg_len = n;
+		data.blocks = cur;
+		data.flags = MMC_DATA_SG;
+		if (mmc_read_data(mmc, &data, start) != cur)
+			return 0;
+		start += cur;
+	}
+
+	return blkcnt;
+}
+
 static int mmc_go_idle(struct mmc *mmc)
 {
 	struct mmc_cmd cmd;
@@ -602,6 +745,9 @@ int mmc_switch_part(int dev_num, unsigned int part_num)
 	if ((ret == 0) || ((ret == -ENODEV) && (part_num == 0)))
 		ret = mmc_set_capacity(mmc, part_num);
 
+	/* Same device number, different blocks */
+	blkcache_invalidate(IF_TYPE_MMC, dev_num);
+
 	return ret;
 }
 
@@ -966,6 +1112,8 @@ static int mmc_startup(struct mmc *mmc)
 	 * For SD, its erase group is always one sector
 	 */
 	mmc->erase_grp_size = 1;
+	mmc->can_trim = 0;
+	mmc->erased_byte = 0xff;
 	mmc->part_config = MMCPART_NOAVAILABLE;
 	if (!IS_SD(mmc) && (mmc->version >= MMC_VERSION_4)) {
 		/* check  ext_csd version and capacity */
@@ -1038,6 +1186,10 @@ static int mmc_startup(struct mmc *mmc)
 
 		mmc->capacity_boot = ext_csd[EXT_CSD_BOOT_MULT] << 17;
 
+		mmc->can_trim = !!(ext_csd[EXT_CSD_SEC_FEATURE_SUPPORT] &
+				   EXT_CSD_SEC_GB_CL_EN);
+		mmc->erased_byte = ext_csd[EXT_CSD_ERASED_MEM_CONT] ? 0xff : 0;
+
 		mmc->capacity_rpmb = ext_csd[EXT_CSD_RPMB_MULT] << 17;
 
 		for (i = 0; i < 4; i++) {
@@ -1249,6 +1401,11 @@ struct mmc *mmc_create(const struct mmc_config *cfg, void *priv)
 	mmc->block_dev.block_read = mmc_bread;
 	mmc->block_dev.block_write = mmc_bwrite;
 	mmc->block_dev.block_erase = mmc_berase;
+	mmc->block_dev.block_zero = mmc_bzero;
+	if (cfg->ops->data_poll) {
+		mmc->block_dev.block_read_async = mmc_bread_async;
+		mmc->block_dev.block_read_poll = mmc_bread_poll;
+	}
 
 	/* setup initial part type */
 	mmc->block_dev.part_type = mmc->cfg->part_type;
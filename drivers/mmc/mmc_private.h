@@ -21,6 +21,8 @@ extern int mmc_set_blocklen(struct mmc *mmc, int len);
 
 extern unsigned long mmc_berase(int dev_num, lbaint_t start, lbaint_t blkcnt);
 
+extern unsigned long mmc_bzero(int dev_num, lbaint_t start, lbaint_t blkcnt);
+
 extern ulong mmc_bwrite(int dev_num, lbaint_t start, lbaint_t blkcnt,
 		const void *src);
 
@@ -34,6 +36,12 @@ static inline unsigned long mmc_berase(int dev_num, lbaint_t start,
 	return 0;
 }
 
+static inline unsigned long mmc_bzero(int dev_num, lbaint_t start,
+		lbaint_t blkcnt)
+{
+	return 0;
+}
+
 static inline ulong mmc_bwrite(int dev_num, lbaint_t start, lbaint_t blkcnt,
 		const void *src)
 {
@@ -12,7 +12,11 @@
 #include <part.h>
 #include "mmc_private.h"
 
-static ulong mmc_erase_t(struct mmc *mmc, ulong start, lbaint_t blkcnt)
+/* Blocks per erase/trim command when zeroing, bounds the busy time */
+#define MMC_ZERO_MAX_BLKS	0x20000
+
+static ulong mmc_erase_t(struct mmc *mmc, ulong start, lbaint_t blkcnt,
+			 uint arg)
 {
 	struct mmc_cmd cmd;
 	ulong end;
@@ -49,7 +53,7 @@ static ulong mmc_erase_t(struct mmc *mmc, ulong start, lbaint_t blkcnt)
 		goto err_out;
 
 	cmd.cmdidx = MMC_CMD_ERASE;
-	cmd.cmdarg = SECURE_ERASE;
+	cmd.cmdarg = arg;
 	cmd.resp_type = MMC_RSP_R1b;
 
 	err = mmc_send_cmd(mmc, &cmd, NULL);
@@ -73,6 +77,8 @@ unsigned long mmc_berase(int dev_num, lbaint_t start, lbaint_t blkcnt)
 	if (!mmc)
 		return -1;
 
+	blkcache_invalidate(IF_TYPE_MMC, dev_num);
+
 	if ((start % mmc->erase_grp_size) || (blkcnt % mmc->erase_grp_size))
 		printf("\n\nCaution! Your devices Erase group is 0x%x\n"
 		       "The erase range would be change to "
@@ -84,7 +90,7 @@ unsigned long mmc_berase(int dev_num, lbaint_t start, lbaint_t blkcnt)
 	while (blk < blkcnt) {
 		blk_r = ((blkcnt - blk) > mmc->erase_grp_size) ?
 			mmc->erase_grp_size : (blkcnt - blk);
-		err = mmc_erase_t(mmc, start + blk, blk_r);
+		err = mmc_erase_t(mmc, start + blk, blk_r, SECURE_ERASE);
 		if (err)
 			break;
 
@@ -98,6 +104,47 @@ unsigned long mmc_berase(int dev_num, lbaint_t start, lbaint_t blkcnt)
 	return blk;
 }
 
+/*
+ * Zero blocks by erasing them: TRIM works on single write blocks, plain
+ * ERASE only on whole erase groups. Returns 0 if the range cannot be
+ * zeroed that way and has to be written instead.
+ */
+unsigned long mmc_bzero(int dev_num, lbaint_t start, lbaint_t blkcnt)
+{
+	struct mmc *mmc = find_mmc_device(dev_num);
+	lbaint_t blk, blk_r, max;
+	uint arg;
+
+	if (!mmc || IS_SD(mmc) || mmc->erased_byte)
+		return 0;
+
+	blkcache_invalidate(IF_TYPE_MMC, dev_num);
+
+	if ((start + blkcnt) > mmc->block_dev.lba)
+		return 0;
+
+	if (mmc->can_trim)
+		arg = MMC_TRIM_ARG;
+	else if (!(start % mmc->erase_grp_size) &&
+		 !(blkcnt % mmc->erase_grp_size))
+		arg = MMC_ERASE_ARG;
+	else
+		return 0;
+
+	max = roundup(MMC_ZERO_MAX_BLKS, mmc->erase_grp_size);
+	for (blk = 0; blk < blkcnt; blk += blk_r) {
+		blk_r = min(blkcnt - blk, max);
+		if (mmc_erase_t(mmc, start + blk, blk_r, arg))
+			return 0;
+
+		/* Waiting for the ready status */
+		if (mmc_send_status(mmc, 10000))
+			return 0;
+	}
+
+	return blkcnt;
+}
+
 static ulong mmc_write_blocks(struct mmc *mmc, lbaint_t start,
 		lbaint_t blkcnt, const void *src)
 {
@@ -163,6 +210,8 @@ ulong mmc_bwrite(int dev_num, lbaint_t start, lbaint_t blkcnt, const void *src)
 	if (!mmc)
 		return 0;
 
+	blkcache_invalidate(IF_TYPE_MMC, dev_num);
+
 	if (mmc_set_blocklen(mmc, mmc->write_bl_len))
 		return 0;
 
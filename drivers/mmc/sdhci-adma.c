@@ -0,0 +1,86 @@
+/*
+ * ADMA2 descriptor tables for SDHCI style hosts
+ *
+ * ADMA2 lets the host walk a list of buffers on its own, so one command
+ * can move b_max blocks without SDMA boundary stops and scatter them over
+ * several buffers.
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+#include <common.h>
+#include <mmc.h>
+#include <sdhci.h>
+
+static void sdhci_adma_cache(void *addr, uint len, int invalidate)
+{
+	ulong start = (ulong)addr & ~(ARCH_DMA_MINALIGN - 1);
+	ulong end = roundup((ulong)addr + len, ARCH_DMA_MINALIGN);
+
+	if (invalidate)
+		invalidate_dcache_range(start, end);
+	else
+		flush_dcache_range(start, end);
+}
+
+int sdhci_adma_prepare(struct sdhci_adma_desc *table, struct mmc_data *data)
+{
+	struct mmc_sg one, *sg;
+	struct sdhci_adma_desc *desc = table;
+	uint sg_len, i, len, left;
+	ulong addr;
+
+	if (data->flags & MMC_DATA_SG) {
+		sg = data->sg;
+		sg_len = data->sg_len;
+	} else {
+		one.addr = data->dest;
+		one.len = data->blocks * data->blocksize;
+		sg = &one;
+		sg_len = 1;
+	}
+
+	for (i = 0; i < sg_len; i++) {
+		addr = (ulong)sg[i].addr;
+		if ((addr | sg[i].len) & 3)
+			return -1;
+
+		/* A read must not race with dirty lines being written back */
+		sdhci_adma_cache(sg[i].addr, sg[i].len, 0);
+
+		for (left = sg[i].len; left; left -= len, addr += len) {
+			if (desc == table + SDHCI_ADMA_DESC_COUNT)
+				return -1;
+			len = min(left, (uint)SDHCI_ADMA_MAX_LEN);
+			desc->attr = SDHCI_ADMA_VALID | SDHCI_ADMA_TRAN;
+			desc->len = len;
+			desc->addr = addr;
+			desc++;
+		}
+	}
+
+	if (desc == table)
+		return -1;
+	desc[-1].attr |= SDHCI_ADMA_END | SDHCI_ADMA_INT;
+
+	flush_dcache_range((ulong)table,
+			   roundup((ulong)desc, ARCH_DMA_MINALIGN));
+
+	return 0;
+}
+
+void sdhci_adma_complete(struct mmc_data *data)
+{
+	uint i;
+
+	if (!(data->flags & MMC_DATA_READ))
+		return;
+
+	if (!(data->flags & MMC_DATA_SG)) {
+		sdhci_adma_cache(data->dest, data->blocks * data->blocksize, 1);
+		return;
+	}
+
+	for (i = 0; i < data->sg_len; i++)
+		sdhci_adma_cache(data->sg[i].addr, data->sg[i].len, 1);
+}
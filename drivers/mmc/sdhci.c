@@ -9,12 +9,21 @@
  */
 
 #include <common.h>
+#include <errno.h>
 #include <malloc.h>
 #include <mmc.h>
 #include <sdhci.h>
 
 void *aligned_buffer;
 
+#ifdef CONFIG_MMC_SDHCI_ADMA
+#ifdef CONFIG_MMC_SDMA
+#error "CONFIG_MMC_SDHCI_ADMA and CONFIG_MMC_SDMA are exclusive"
+#endif
+static struct sdhci_adma_desc sdhci_adma_table[SDHCI_ADMA_DESC_COUNT]
+	__aligned(ARCH_DMA_MINALIGN);
+#endif
+
 static void sdhci_reset(struct sdhci_host *host, u8 mask)
 {
 	unsigned long timeout;
@@ -56,7 +65,7 @@ static void sdhci_transfer_pio(struct sdhci_host *host, struct mmc_data *data)
 	char *offs;
 	for (i = 0; i < data->blocksize; i += 4) {
 		offs = data->dest + i;
-		if (data->flags == MMC_DATA_READ)
+		if (data->flags & MMC_DATA_READ)
 			*(u32 *)offs = sdhci_readl(host, SDHCI_BUFFER);
 		else
 			sdhci_writel(host, *(u32 *)offs, SDHCI_BUFFER);
@@ -108,9 +117,33 @@ static int sdhci_transfer_data(struct sdhci_host *host, struct mmc_data *data,
 			return -1;
 		}
 	} while (!(stat & SDHCI_INT_DATA_END));
+
+#ifdef CONFIG_MMC_SDHCI_ADMA
+	sdhci_adma_complete(data);
+#endif
 	return 0;
 }
 
+static int sdhci_command_end(struct sdhci_host *host, int ret)
+{
+	unsigned int stat;
+
+	if (host->quirks & SDHCI_QUIRK_WAIT_SEND_CMD)
+		udelay(1000);
+
+	stat = sdhci_readl(host, SDHCI_INT_STATUS);
+	sdhci_writel(host, SDHCI_INT_ALL_MASK, SDHCI_INT_STATUS);
+	if (!ret)
+		return 0;
+
+	sdhci_reset(host, SDHCI_RESET_CMD);
+	sdhci_reset(host, SDHCI_RESET_DATA);
+	if (stat & SDHCI_INT_TIMEOUT)
+		return TIMEOUT;
+	else
+		return COMM_ERR;
+}
+
 /*
  * No command will be sent by driver if card is busy, so driver must wait
  * for card ready state.
@@ -135,6 +168,9 @@ int sdhci_send_command(struct mmc *mmc, struct mmc_cmd *cmd,
 	unsigned int time = 0, start_addr = 0;
 	unsigned int retry = 10000;
 	int mmc_dev = mmc->block_dev.dev;
+#ifdef CONFIG_MMC_SDHCI_ADMA
+	u8 ctrl;
+#endif
 
 	/* Timeout unit - ms */
 	static unsigned int cmd_timeout = CONFIG_SDHCI_CMD_DEFAULT_TIMEOUT;
@@ -189,7 +225,7 @@ int sdhci_send_command(struct mmc *mmc, struct mmc_cmd *cmd,
 		if (data->blocks > 1)
 			mode |= SDHCI_TRNS_MULTI;
 
-		if (data->flags == MMC_DATA_READ)
+		if (data->flags & MMC_DATA_READ)
 			mode |= SDHCI_TRNS_READ;
 
 #ifdef CONFIG_MMC_SDMA
@@ -207,6 +243,19 @@ int sdhci_send_command(struct mmc *mmc, struct mmc_cmd *cmd,
 
 		sdhci_writel(host, start_addr, SDHCI_DMA_ADDRESS);
 		mode |= SDHCI_TRNS_DMA;
+#endif
+#ifdef CONFIG_MMC_SDHCI_ADMA
+		if (sdhci_adma_prepare(sdhci_adma_table, data)) {
+			printf("%s: unaligned or too scattered buffer\n",
+			       __func__);
+			return COMM_ERR;
+		}
+		sdhci_writel(host, (u32)sdhci_adma_table, SDHCI_ADMA_ADDRESS);
+		ctrl = sdhci_readb(host, SDHCI_HOST_CONTROL);
+		ctrl &= ~SDHCI_CTRL_DMA_MASK;
+		sdhci_writeb(host, ctrl | SDHCI_CTRL_ADMA32,
+			     SDHCI_HOST_CONTROL);
+		mode |= SDHCI_TRNS_DMA;
 #endif
 		sdhci_writew(host, SDHCI_MAKE_BLKSZ(SDHCI_DEFAULT_BOUNDARY_ARG,
 				data->blocksize),
@@ -243,28 +292,49 @@ int sdhci_send_command(struct mmc *mmc, struct mmc_cmd *cmd,
 	} else
 		ret = -1;
 
-	if (!ret && data)
+	if (!ret && data) {
+#ifdef CONFIG_MMC_SDHCI_ADMA
+		/* ADMA runs on its own, sdhci_data_poll() finishes up */
+		if (data->flags & MMC_DATA_ASYNC) {
+			host->data_start = get_timer(0);
+			return 0;
+		}
+#endif
 		ret = sdhci_transfer_data(host, data, start_addr);
+	}
 
-	if (host->quirks & SDHCI_QUIRK_WAIT_SEND_CMD)
-		udelay(1000);
+	ret = sdhci_command_end(host, ret);
+	if (!ret && (host->quirks & SDHCI_QUIRK_32BIT_DMA_ADDR) &&
+	    !is_aligned && (data->flags == MMC_DATA_READ))
+		memcpy(data->dest, aligned_buffer, trans_bytes);
+
+	return ret;
+}
+
+#ifdef CONFIG_MMC_SDHCI_ADMA
+/* Transfers take at most as long as in sdhci_transfer_data() */
+#define SDHCI_DATA_TIMEOUT	10000
+
+static int sdhci_data_poll(struct mmc *mmc, struct mmc_data *data)
+{
+	struct sdhci_host *host = mmc->priv;
+	unsigned int stat;
+	int ret;
 
 	stat = sdhci_readl(host, SDHCI_INT_STATUS);
-	sdhci_writel(host, SDHCI_INT_ALL_MASK, SDHCI_INT_STATUS);
-	if (!ret) {
-		if ((host->quirks & SDHCI_QUIRK_32BIT_DMA_ADDR) &&
-				!is_aligned && (data->flags == MMC_DATA_READ))
-			memcpy(data->dest, aligned_buffer, trans_bytes);
-		return 0;
+	if (!(stat & (SDHCI_INT_ERROR | SDHCI_INT_DATA_END))) {
+		if (get_timer(host->data_start) < SDHCI_DATA_TIMEOUT)
+			return -EBUSY;
+		printf("%s: Transfer data timeout\n", __func__);
+		return sdhci_command_end(host, -1);
 	}
 
-	sdhci_reset(host, SDHCI_RESET_CMD);
-	sdhci_reset(host, SDHCI_RESET_DATA);
-	if (stat & SDHCI_INT_TIMEOUT)
-		return TIMEOUT;
-	else
-		return COMM_ERR;
+	/* Sees DATA_END or the error on its first pass */
+	ret = sdhci_transfer_data(host, data, 0);
+
+	return sdhci_command_end(host, ret);
 }
+#endif
 
 static int sdhci_set_clock(struct mmc *mmc, unsigned int clock)
 {
@@ -435,6 +505,9 @@ static const struct mmc_ops sdhci_ops = {
 	.send_cmd	= sdhci_send_command,
 	.set_ios	= sdhci_set_ios,
 	.init		= sdhci_init,
+#ifdef CONFIG_MMC_SDHCI_ADMA
+	.data_poll	= sdhci_data_poll,
+#endif
 };
 
 int add_sdhci(struct sdhci_host *host, u32 max_clk, u32 min_clk)
@@ -452,6 +525,13 @@ int add_sdhci(struct sdhci_host *host, u32 max_clk, u32 min_clk)
 		return -1;
 	}
 #endif
+#ifdef CONFIG_MMC_SDHCI_ADMA
+	if (!(caps & SDHCI_CAN_DO_ADMA2)) {
+		printf("%s: Your controller doesn't support ADMA2!!\n",
+		       __func__);
+		return -1;
+	}
+#endif
 
 	if (max_clk)
 		host->cfg.f_max = max_clk;
@@ -500,6 +580,9 @@ int add_sdhci(struct sdhci_host *host, u32 max_clk, u32 min_clk)
 		host->cfg.host_caps |= host->host_caps;
 
 	host->cfg.b_max = CONFIG_SYS_MMC_MAX_BLK_COUNT;
+#ifdef CONFIG_MMC_SDHCI_ADMA
+	host->cfg.host_caps |= MMC_MODE_SG;
+#endif
 
 	sdhci_reset(host, SDHCI_RESET_ALL);
 
@@ -77,12 +77,12 @@
 #include <linux/random.h>
 #else
 #include <div64.h>
+#include <ubi_uboot.h>
 #include <linux/err.h>
 #endif
 
 #include <linux/math64.h>
 
-#include <ubi_uboot.h>
 #include "ubi.h"
 
 static int self_check_ai(struct ubi_device *ubi, struct ubi_attach_info *ai);
@@ -90,6 +90,8 @@ static int self_check_ai(struct ubi_device *ubi, struct ubi_attach_info *ai);
 /* Temporary variables used during scanning */
 static struct ubi_ec_hdr *ech;
 static struct ubi_vid_hdr *vidh;
+/* Both headers of a PEB as read at once, NULL if they are read one by one */
+static void *hdrs;
 
 /**
  * add_to_list - add physical eraseblock to a list.
@@ -813,7 +815,7 @@ static int scan_peb(struct ubi_device *ubi, struct ubi_attach_info *ai,
 		    int pnum, int *vid, unsigned long long *sqnum)
 {
 	long long uninitialized_var(ec);
-	int err, bitflips = 0, vol_id = -1, ec_err = 0;
+	int err, bitflips = 0, vol_id = -1, ec_err = 0, vid_err = 0;
 
 	dbg_bld("scan PEB %d", pnum);
 
@@ -826,7 +828,10 @@ static int scan_peb(struct ubi_device *ubi, struct ubi_attach_info *ai,
 		return 0;
 	}
 
-	err = ubi_io_read_ec_hdr(ubi, pnum, ech, 0);
+	if (hdrs)
+		err = ubi_io_read_hdrs(ubi, pnum, hdrs, ech, vidh, &vid_err, 0);
+	else
+		err = ubi_io_read_ec_hdr(ubi, pnum, ech, 0);
 	if (err < 0)
 		return err;
 	switch (err) {
@@ -908,7 +913,10 @@ static int scan_peb(struct ubi_device *ubi, struct ubi_attach_info *ai,
 
 	/* OK, we've done with the EC header, let's look at the VID header */
 
-	err = ubi_io_read_vid_hdr(ubi, pnum, vidh, 0);
+	if (hdrs)
+		err = vid_err;
+	else
+		err = ubi_io_read_vid_hdr(ubi, pnum, vidh, 0);
 	if (err < 0)
 		return err;
 	switch (err) {
@@ -1207,6 +1215,24 @@ static void destroy_ai(struct ubi_attach_info *ai)
 	kfree(ai);
 }
 
+/**
+ * alloc_hdrs - allocate the buffer to read both headers of a PEB at once.
+ * @ubi: UBI device description object
+ *
+ * Reading the VID header along with the EC header only pays off if both are
+ * in the first flash page, or if the flash has no pages (NOR). Returns %NULL
+ * otherwise, or if there is no memory, and the headers are read one by one.
+ */
+static void *alloc_hdrs(const struct ubi_device *ubi)
+{
+	int len = ubi->vid_hdr_aloffset + ubi->vid_hdr_alsize;
+
+	if (ubi->min_io_size > 1 && len > ubi->min_io_size)
+		return NULL;
+
+	return kmalloc(len, GFP_KERNEL);
+}
+
 /**
  * scan_all - scan entire MTD device.
  * @ubi: UBI device description object
@@ -1235,6 +1261,8 @@ static int scan_all(struct ubi_device *ubi, struct ubi_attach_info *ai,
 	if (!vidh)
 		goto out_ech;
 
+	hdrs = alloc_hdrs(ubi);
+
 	for (pnum = start; pnum < ubi->peb_count; pnum++) {
 		cond_resched();
 
@@ -1281,12 +1309,16 @@ static int scan_all(struct ubi_device *ubi, struct ubi_attach_info *ai,
 	if (err)
 		goto out_vidh;
 
+	kfree(hdrs);
+	hdrs = NULL;
 	ubi_free_vid_hdr(ubi, vidh);
 	kfree(ech);
 
 	return 0;
 
 out_vidh:
+	kfree(hdrs);
+	hdrs = NULL;
 	ubi_free_vid_hdr(ubi, vidh);
 out_ech:
 	kfree(ech);
@@ -1320,6 +1352,8 @@ static int scan_fast(struct ubi_device *ubi, struct ubi_attach_info *ai)
 	if (!vidh)
 		goto out_ech;
 
+	hdrs = alloc_hdrs(ubi);
+
 	for (pnum = 0; pnum < UBI_FM_MAX_START; pnum++) {
 		int vol_id = -1;
 		unsigned long long sqnum = -1;
@@ -1336,6 +1370,8 @@ static int scan_fast(struct ubi_device *ubi, struct ubi_attach_info *ai)
 		}
 	}
 
+	kfree(hdrs);
+	hdrs = NULL;
 	ubi_free_vid_hdr(ubi, vidh);
 	kfree(ech);
 
@@ -1345,6 +1381,8 @@ static int scan_fast(struct ubi_device *ubi, struct ubi_attach_info *ai)
 	return ubi_scan_fastmap(ubi, ai, fm_anchor);
 
 out_vidh:
+	kfree(hdrs);
+	hdrs = NULL;
 	ubi_free_vid_hdr(ubi, vidh);
 out_ech:
 	kfree(ech);
@@ -1067,6 +1067,18 @@ int ubi_attach_mtd_dev(struct mtd_info *mtd, int ubi_num,
 	wake_up_process(ubi->bgt_thread);
 	spin_unlock(&ubi->wl_lock);
 
+#ifdef CONFIG_MTD_UBI_FASTMAP
+	/*
+	 * U-Boot hands over to the kernel without detaching, so an image
+	 * without a fastmap would be scanned on every boot. Write one now,
+	 * the next attach only has to read it.
+	 */
+	if (!ubi->fm && !ubi->fm_disabled && !ubi->ro_mode) {
+		ubi_msg("no fastmap found, writing one");
+		ubi_update_fastmap(ubi);
+	}
+#endif
+
 	ubi_devices[ubi_num] = ubi;
 	ubi_notify_all(ubi, UBI_VOLUME_ADDED, NULL);
 	return ubi_num;
@@ -29,6 +29,9 @@
 #include <linux/types.h>
 
 #include <asm/byteorder.h>
+#ifdef __UBOOT__
+#include <u-boot/crc.h>
+#endif
 
 #ifndef __UBOOT__
 #include <linux/slab.h>
@@ -78,6 +81,16 @@ u32 crc32_le(u32 crc, unsigned char const *p, size_t len)
 }
 #else				/* Table-based approach */
 
+#ifdef __UBOOT__
+/*
+ * Same raw CRC as crc32_no_comp(), which has the slicing-by-8 and ARMv8
+ * CRC32 code of lib/crc32.c
+ */
+u32 crc32_le(u32 crc, unsigned char const *p, size_t len)
+{
+	return crc32_no_comp(crc, p, len);
+}
+#else
 u32 crc32_le(u32 crc, unsigned char const *p, size_t len)
 {
 # if CRC_LE_BITS == 8
@@ -145,6 +158,7 @@ u32 crc32_le(u32 crc, unsigned char const *p, size_t len)
 	return crc;
 # endif
 }
+#endif /* __UBOOT__ */
 #endif
 #ifndef __UBOOT__
 /**
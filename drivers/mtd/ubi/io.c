@@ -92,6 +92,10 @@ static int self_check_vid_hdr(const struct ubi_device *ubi, int pnum,
 			      const struct ubi_vid_hdr *vid_hdr);
 static int self_check_write(struct ubi_device *ubi, const void *buf, int pnum,
 			    int offset, int len);
+static int check_ec_hdr(const struct ubi_device *ubi, int pnum,
+			struct ubi_ec_hdr *ec_hdr, int read_err, int verbose);
+static int check_vid_hdr(const struct ubi_device *ubi, int pnum,
+			 struct ubi_vid_hdr *vid_hdr, int read_err, int verbose);
 
 /**
  * ubi_io_read - read data from a physical eraseblock.
@@ -722,8 +726,7 @@ bad:
 int ubi_io_read_ec_hdr(struct ubi_device *ubi, int pnum,
 		       struct ubi_ec_hdr *ec_hdr, int verbose)
 {
-	int err, read_err;
-	uint32_t crc, magic, hdr_crc;
+	int read_err;
 
 	dbg_io("read EC header from PEB %d", pnum);
 	ubi_assert(pnum >= 0 && pnum < ubi->peb_count);
@@ -744,6 +747,25 @@ int ubi_io_read_ec_hdr(struct ubi_device *ubi, int pnum,
 		 */
 	}
 
+	return check_ec_hdr(ubi, pnum, ec_hdr, read_err, verbose);
+}
+
+/**
+ * check_ec_hdr - check an erase counter header which has just been read.
+ * @ubi: UBI device description object
+ * @pnum: physical eraseblock the header was read from
+ * @ec_hdr: the erase counter header
+ * @read_err: what 'ubi_io_read()' returned for the header
+ * @verbose: be verbose if the header is corrupted or was not found
+ *
+ * Returns the same codes as 'ubi_io_read_ec_hdr()'.
+ */
+static int check_ec_hdr(const struct ubi_device *ubi, int pnum,
+			struct ubi_ec_hdr *ec_hdr, int read_err, int verbose)
+{
+	int err;
+	uint32_t crc, magic, hdr_crc;
+
 	magic = be32_to_cpu(ec_hdr->magic);
 	if (magic != UBI_EC_HDR_MAGIC) {
 		if (mtd_is_eccerr(read_err))
@@ -992,8 +1014,7 @@ bad:
 int ubi_io_read_vid_hdr(struct ubi_device *ubi, int pnum,
 			struct ubi_vid_hdr *vid_hdr, int verbose)
 {
-	int err, read_err;
-	uint32_t crc, magic, hdr_crc;
+	int read_err;
 	void *p;
 
 	dbg_io("read VID header from PEB %d", pnum);
@@ -1005,6 +1026,25 @@ int ubi_io_read_vid_hdr(struct ubi_device *ubi, int pnum,
 	if (read_err && read_err != UBI_IO_BITFLIPS && !mtd_is_eccerr(read_err))
 		return read_err;
 
+	return check_vid_hdr(ubi, pnum, vid_hdr, read_err, verbose);
+}
+
+/**
+ * check_vid_hdr - check a volume identifier header which has just been read.
+ * @ubi: UBI device description object
+ * @pnum: physical eraseblock the header was read from
+ * @vid_hdr: the volume identifier header
+ * @read_err: what 'ubi_io_read()' returned for the header
+ * @verbose: be verbose if the header is corrupted or wasn't found
+ *
+ * Returns the same codes as 'ubi_io_read_vid_hdr()'.
+ */
+static int check_vid_hdr(const struct ubi_device *ubi, int pnum,
+			 struct ubi_vid_hdr *vid_hdr, int read_err, int verbose)
+{
+	int err;
+	uint32_t crc, magic, hdr_crc;
+
 	magic = be32_to_cpu(vid_hdr->magic);
 	if (magic != UBI_VID_HDR_MAGIC) {
 		if (mtd_is_eccerr(read_err))
@@ -1058,6 +1098,65 @@ int ubi_io_read_vid_hdr(struct ubi_device *ubi, int pnum,
 	return read_err ? UBI_IO_BITFLIPS : 0;
 }
 
+/**
+ * ubi_io_read_hdrs - read and check both headers of a PEB at once.
+ * @ubi: UBI device description object
+ * @pnum: physical eraseblock number to read from
+ * @buf: buffer of @ubi->vid_hdr_aloffset + @ubi->vid_hdr_alsize bytes
+ * @ec_hdr: &struct ubi_ec_hdr object where to store the erase counter header
+ * @vid_hdr: &struct ubi_vid_hdr object where to store the volume identifier
+ * header
+ * @vid_err: the status of the volume identifier header is stored here
+ * @verbose: be verbose if a header is corrupted or was not found
+ *
+ * Attaching by scanning needs both headers of every PEB. When the VID header
+ * sits in the same flash page as the EC header, or the flash has no pages at
+ * all (NOR), one read of the beginning of the PEB fetches both and saves a
+ * flash access per PEB. If that read reports bit-flips or an ECC error, the
+ * headers are read again one by one so that the error is charged to the
+ * right header.
+ *
+ * Returns the status of the EC header, see 'ubi_io_read_ec_hdr()', and
+ * stores the status of the VID header, see 'ubi_io_read_vid_hdr()', at
+ * @vid_err. A negative error code is returned in case of failure.
+ */
+int ubi_io_read_hdrs(struct ubi_device *ubi, int pnum, void *buf,
+		     struct ubi_ec_hdr *ec_hdr, struct ubi_vid_hdr *vid_hdr,
+		     int *vid_err, int verbose)
+{
+	int err;
+
+	dbg_io("read EC and VID headers from PEB %d", pnum);
+	ubi_assert(pnum >= 0 && pnum < ubi->peb_count);
+
+	err = ubi_io_read(ubi, buf, pnum, 0,
+			  ubi->vid_hdr_aloffset + ubi->vid_hdr_alsize);
+	if (err) {
+		if (err != UBI_IO_BITFLIPS && !mtd_is_eccerr(err))
+			return err;
+
+		err = ubi_io_read_ec_hdr(ubi, pnum, ec_hdr, verbose);
+		if (err < 0)
+			return err;
+		*vid_err = ubi_io_read_vid_hdr(ubi, pnum, vid_hdr, verbose);
+		if (*vid_err < 0)
+			return *vid_err;
+		return err;
+	}
+
+	memcpy(ec_hdr, buf, UBI_EC_HDR_SIZE);
+	memcpy(vid_hdr, buf + ubi->vid_hdr_offset, UBI_VID_HDR_SIZE);
+
+	err = check_ec_hdr(ubi, pnum, ec_hdr, 0, verbose);
+	if (err < 0)
+		return err;
+	*vid_err = check_vid_hdr(ubi, pnum, vid_hdr, 0, verbose);
+	if (*vid_err < 0)
+		return *vid_err;
+
+	return err;
+}
+
 /**
  * ubi_io_write_vid_hdr - write a volume identifier header.
  * @ubi: UBI device description object
@@ -763,21 +763,23 @@ out:
 }
 
 /**
- * Pull one frame from the card
+ * Hand out the next frame of the receive ring, without copying it out of
+ * its DMA buffer. The descriptor stays ours until fec_free_pkt().
  * @param[in] dev Our ethernet device to handle
- * @return Length of packet read
+ * @param[out] packetp Frame data
+ * @return Length of the frame, 0 for a bad frame, -EAGAIN if none arrived
  */
-static int fec_recv(struct eth_device *dev)
+static int fec_recv_pkt(struct eth_device *dev, uchar **packetp)
 {
 	struct fec_priv *fec = (struct fec_priv *)dev->priv;
 	struct fec_bd *rbd = &fec->rbd_base[fec->rbd_index];
 	unsigned long ievent;
-	int frame_length, len = 0;
+	int frame_length;
 	struct nbuf *frame;
 	uint16_t bd_status;
 	uint32_t addr, size, end;
-	int i;
-	ALLOC_CACHE_ALIGN_BUFFER(uchar, buff, FEC_MAX_PKT_SIZE);
+
+	*packetp = NULL;
 
 	/*
 	 * Check if any critical events have happened
@@ -789,7 +791,7 @@ static int fec_recv(struct eth_device *dev)
 		fec_halt(dev);
 		fec_init(dev, fec->bd);
 		printf("some error: 0x%08lx\n", ievent);
-		return 0;
+		return -EAGAIN;
 	}
 	if (ievent & FEC_IEVENT_HBERR) {
 		/* Heartbeat error */
@@ -827,61 +829,111 @@ static int fec_recv(struct eth_device *dev)
 	bd_status = readw(&rbd->status);
 	debug("fec_recv: status 0x%x\n", bd_status);
 
-	if (!(bd_status & FEC_RBD_EMPTY)) {
-		if ((bd_status & FEC_RBD_LAST) && !(bd_status & FEC_RBD_ERR) &&
-			((readw(&rbd->data_length) - 4) > 14)) {
-			/*
-			 * Get buffer address and size
-			 */
-			frame = (struct nbuf *)readl(&rbd->data_pointer);
-			frame_length = readw(&rbd->data_length) - 4;
-			/*
-			 * Invalidate data cache over the buffer
-			 */
-			addr = (uint32_t)frame;
-			end = roundup(addr + frame_length, ARCH_DMA_MINALIGN);
-			addr &= ~(ARCH_DMA_MINALIGN - 1);
-			invalidate_dcache_range(addr, end);
-
-			/*
-			 *  Fill the buffer and pass it to upper layers
-			 */
+	if (bd_status & FEC_RBD_EMPTY)
+		return -EAGAIN;
+
+	if (!(bd_status & FEC_RBD_LAST) || (bd_status & FEC_RBD_ERR) ||
+	    (readw(&rbd->data_length) - 4) <= 14) {
+		if (bd_status & FEC_RBD_ERR)
+			printf("error frame: 0x%08lx 0x%08x\n",
+					(ulong)rbd->data_pointer,
+					bd_status);
+		return 0;
+	}
+
+	/*
+	 * Get buffer address and size
+	 */
+	frame = (struct nbuf *)readl(&rbd->data_pointer);
+	frame_length = readw(&rbd->data_length) - 4;
+	/*
+	 * Invalidate data cache over the buffer
+	 */
+	addr = (uint32_t)frame;
+	end = roundup(addr + frame_length, ARCH_DMA_MINALIGN);
+	addr &= ~(ARCH_DMA_MINALIGN - 1);
+	invalidate_dcache_range(addr, end);
+
 #ifdef CONFIG_FEC_MXC_SWAP_PACKET
-			swap_packet((uint32_t *)frame->data, frame_length);
+	swap_packet((uint32_t *)frame->data, frame_length);
 #endif
-			memcpy(buff, frame->data, frame_length);
-			NetReceive(buff, frame_length);
-			len = frame_length;
-		} else {
-			if (bd_status & FEC_RBD_ERR)
-				printf("error frame: 0x%08lx 0x%08x\n",
-						(ulong)rbd->data_pointer,
-						bd_status);
-		}
+	*packetp = frame->data;
 
-		/*
-		 * Free the current buffer, restart the engine and move forward
-		 * to the next buffer. Here we check if the whole cacheline of
-		 * descriptors was already processed and if so, we mark it free
-		 * as whole.
-		 */
-		size = RXDESC_PER_CACHELINE - 1;
-		if ((fec->rbd_index & size) == size) {
-			i = fec->rbd_index - size;
-			addr = (uint32_t)&fec->rbd_base[i];
-			for (; i <= fec->rbd_index ; i++) {
-				fec_rbd_clean(i == (FEC_RBD_NUM - 1),
-					      &fec->rbd_base[i]);
-			}
-			flush_dcache_range(addr,
-				addr + ARCH_DMA_MINALIGN);
-		}
+	return frame_length;
+}
+
+/**
+ * Give the frame from fec_recv_pkt() back to the card and move forward
+ * to the next buffer
+ * @param[in] dev Our ethernet device to handle
+ * @param[in] packet Frame data, NULL for a bad frame
+ * @param[in] length Length of the frame
+ * @return 0
+ */
+static int fec_free_pkt(struct eth_device *dev, uchar *packet, int length)
+{
+	struct fec_priv *fec = (struct fec_priv *)dev->priv;
+	uint32_t addr, end, size;
+	int i;
 
-		fec_rx_task_enable(fec);
-		fec->rbd_index = (fec->rbd_index + 1) % FEC_RBD_NUM;
+	/*
+	 * The stack may have written to the frame, e.g. to turn a ping
+	 * around. Drop those cache lines so they can't be evicted over the
+	 * next frame the card puts into the buffer.
+	 */
+	if (packet && length > 0) {
+		addr = (uint32_t)packet;
+		end = roundup(addr + length, ARCH_DMA_MINALIGN);
+		addr &= ~(ARCH_DMA_MINALIGN - 1);
+		invalidate_dcache_range(addr, end);
 	}
+
+	/*
+	 * Free the current buffer, restart the engine and move forward
+	 * to the next buffer. Here we check if the whole cacheline of
+	 * descriptors was already processed and if so, we mark it free
+	 * as whole.
+	 */
+	size = RXDESC_PER_CACHELINE - 1;
+	if ((fec->rbd_index & size) == size) {
+		i = fec->rbd_index - size;
+		addr = (uint32_t)&fec->rbd_base[i];
+		for (; i <= fec->rbd_index ; i++) {
+			fec_rbd_clean(i == (FEC_RBD_NUM - 1),
+				      &fec->rbd_base[i]);
+		}
+		flush_dcache_range(addr,
+			addr + ARCH_DMA_MINALIGN);
+	}
+
+	fec_rx_task_enable(fec);
+	fec->rbd_index = (fec->rbd_index + 1) % FEC_RBD_NUM;
 	debug("fec_recv: stop\n");
 
+	return 0;
+}
+
+/**
+ * Pull one frame from the card
+ * @param[in] dev Our ethernet device to handle
+ * @return Length of packet read
+ */
+static int fec_recv(struct eth_device *dev)
+{
+	ALLOC_CACHE_ALIGN_BUFFER(uchar, buff, FEC_MAX_PKT_SIZE);
+	uchar *packet;
+	int len;
+
+	len = fec_recv_pkt(dev, &packet);
+	if (len < 0)
+		return 0;
+
+	if (len > 0) {
+		memcpy(buff, packet, len);
+		NetReceive(buff, len);
+	}
+	fec_free_pkt(dev, packet, len);
+
 	return len;
 }
 
@@ -998,6 +1050,8 @@ static int fec_probe(bd_t *bd, int dev_id, uint32_t base_addr,
 	edev->init = fec_init;
 	edev->send = fec_send;
 	edev->recv = fec_recv;
+	edev->recv_pkt = fec_recv_pkt;
+	edev->free_pkt = fec_free_pkt;
 	edev->halt = fec_halt;
 	edev->write_hwaddr = fec_set_hwaddr;
 
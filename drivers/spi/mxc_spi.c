@@ -330,6 +330,85 @@ int spi_xchg_single(struct spi_slave *slave, unsigned int bitlen,
 
 }
 
+#ifdef MAX_SPI_BURST_BYTES
+/* Next word to send, the first byte goes out first */
+static u32 spi_burst_word(const u8 **dout)
+{
+	const u8 *p = *dout;
+
+	if (!p)
+		return 0;
+	*dout = p + 4;
+
+	return p[0] << 24 | p[1] << 16 | p[2] << 8 | p[3];
+}
+
+/*
+ * Exchange a burst of whole words, longer than the FIFO. The burst starts
+ * with the TX FIFO full and every word received makes room for the next
+ * one to send, so SCLK keeps running for the whole burst instead of
+ * stopping after each MAX_SPI_BYTES, and the RX FIFO can never overflow.
+ */
+static int spi_xchg_burst(struct spi_slave *slave, int nbytes,
+	const u8 *dout, u8 *din)
+{
+	struct mxc_spi_slave *mxcs = to_mxc_spi_slave(slave);
+	struct cspi_regs *regs = (struct cspi_regs *)mxcs->base;
+	int nwords = nbytes / 4;
+	int tx, rx, busy = 1;
+	u32 data, ts = 0;
+
+	mxcs->ctrl_reg = (mxcs->ctrl_reg &
+		~MXC_CSPICTRL_BITCOUNT(MXC_CSPICTRL_MAXBITS)) |
+		MXC_CSPICTRL_BITCOUNT(nbytes * 8 - 1);
+
+	reg_write(&regs->ctrl, mxcs->ctrl_reg | MXC_CSPICTRL_EN);
+	reg_write(&regs->cfg, mxcs->cfg_reg);
+	reg_write(&regs->stat, MXC_CSPICTRL_TC | MXC_CSPICTRL_RXOVF);
+
+	for (tx = 0; tx < nwords && tx < MXC_CSPI_FIFO_WORDS; tx++)
+		reg_write(&regs->txdata, spi_burst_word(&dout));
+
+	reg_write(&regs->ctrl, mxcs->ctrl_reg |
+		MXC_CSPICTRL_EN | MXC_CSPICTRL_XCH);
+
+	for (rx = 0; rx < nwords; ) {
+		/* the timeout only runs while no word comes in */
+		if (!(reg_read(&regs->stat) & MXC_CSPISTAT_RR)) {
+			if (busy) {
+				ts = get_timer(0);
+				busy = 0;
+			} else if (get_timer(ts) > CONFIG_SYS_SPI_MXC_WAIT) {
+				printf("spi_xchg_burst: Timeout!\n");
+				return -1;
+			}
+			continue;
+		}
+		busy = 1;
+
+		data = reg_read(&regs->rxdata);
+		if (din) {
+			din[0] = data >> 24;
+			din[1] = data >> 16;
+			din[2] = data >> 8;
+			din[3] = data;
+			din += 4;
+		}
+		rx++;
+
+		if (tx < nwords) {
+			reg_write(&regs->txdata, spi_burst_word(&dout));
+			tx++;
+		}
+	}
+
+	/* All words are in, the burst is complete */
+	reg_write(&regs->stat, MXC_CSPICTRL_TC | MXC_CSPICTRL_RXOVF);
+
+	return 0;
+}
+#endif
+
 int spi_xfer(struct spi_slave *slave, unsigned int bitlen, const void *dout,
 		void *din, unsigned long flags)
 {
@@ -354,6 +433,14 @@ int spi_xfer(struct spi_slave *slave, unsigned int bitlen, const void *dout,
 
 		n_bits = blk_size * 8;
 
+#ifdef MAX_SPI_BURST_BYTES
+		/* Long transfers go in bursts of whole words */
+		if (n_bytes > MAX_SPI_BYTES) {
+			blk_size = min(n_bytes, MAX_SPI_BURST_BYTES) & ~3;
+			ret = spi_xchg_burst(slave, blk_size, p_outbuf,
+					     p_inbuf);
+		} else
+#endif
 		ret = spi_xchg_single(slave, n_bits, p_outbuf, p_inbuf, 0);
 
 		if (ret)
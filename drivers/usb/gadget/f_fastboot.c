@@ -56,6 +56,18 @@ static struct f_fastboot *fastboot_func;
 static unsigned int download_size;
 static unsigned int download_bytes;
 
+#ifdef CONFIG_FASTBOOT_FLASH_STREAM
+/*
+ * After "oem stream <partition>" downloads are written to that partition
+ * as they arrive instead of being collected in the download buffer. The
+ * following "flash" command only reports the outcome.
+ */
+static char stream_part[32];
+static char stream_response[RESPONSE_LEN];
+static int download_stream;
+static void *stream_spare;
+#endif
+
 static struct usb_endpoint_descriptor fs_ep_in = {
 	.bLength            = USB_DT_ENDPOINT_SIZE,
 	.bDescriptorType    = USB_DT_ENDPOINT,
@@ -122,6 +134,7 @@ static struct usb_gadget_strings *fastboot_strings[] = {
 };
 
 static void rx_handler_command(struct usb_ep *ep, struct usb_request *req);
+static unsigned int download_max_size(void);
 
 static void fastboot_complete(struct usb_ep *ep, struct usb_request *req)
 {
@@ -355,7 +368,7 @@ static void cb_getvar(struct usb_ep *ep, struct usb_request *req)
 		!strcmp_l1("max-download-size", cmd)) {
 		char str_num[12];
 
-		sprintf(str_num, "0x%08x", CONFIG_USB_FASTBOOT_BUF_SIZE);
+		sprintf(str_num, "0x%08x", download_max_size());
 		strncat(response, str_num, chars_left);
 	} else if (!strcmp_l1("serialno", cmd)) {
 		s = getenv("serial#");
@@ -370,6 +383,22 @@ static void cb_getvar(struct usb_ep *ep, struct usb_request *req)
 	fastboot_tx_write_str(response);
 }
 
+static unsigned int download_max_size(void)
+{
+#ifdef CONFIG_FASTBOOT_FLASH_STREAM
+	u64 size;
+
+	if (stream_part[0]) {
+		size = fb_mmc_part_size(stream_part, stream_response);
+		if (size > 0xfffff000)
+			size = 0xfffff000;
+		if (size)
+			return size;
+	}
+#endif
+	return CONFIG_USB_FASTBOOT_BUF_SIZE;
+}
+
 static unsigned int rx_bytes_expected(void)
 {
 	int rx_remain = download_size - download_bytes;
@@ -397,6 +426,16 @@ static void rx_handler_dl_image(struct usb_ep *ep, struct usb_request *req)
 	if (buffer_size < transfer_size)
 		transfer_size = buffer_size;
 
+#ifdef CONFIG_FASTBOOT_FLASH_STREAM
+	if (download_stream) {
+		/*
+		 * Receive the next packet into the spare buffer while this
+		 * one is written out below
+		 */
+		req->buf = stream_spare;
+		stream_spare = (void *)buffer;
+	} else
+#endif
 	memcpy((void *)CONFIG_USB_FASTBOOT_BUF_ADDR + download_bytes,
 	       buffer, transfer_size);
 
@@ -432,7 +471,45 @@ static void rx_handler_dl_image(struct usb_ep *ep, struct usb_request *req)
 
 	req->actual = 0;
 	usb_ep_queue(ep, req, 0);
+
+#ifdef CONFIG_FASTBOOT_FLASH_STREAM
+	if (download_stream) {
+		fb_mmc_stream_write(buffer, transfer_size);
+		if (!download_size) {
+			fb_mmc_stream_finish();
+			download_stream = 0;
+		}
+	}
+#endif
+}
+
+#ifdef CONFIG_FASTBOOT_FLASH_STREAM
+static int download_stream_start(void)
+{
+	if (!stream_spare) {
+		stream_spare = memalign(CONFIG_SYS_CACHELINE_SIZE,
+					EP_BUFFER_SIZE);
+		if (!stream_spare) {
+			strcpy(stream_response, "FAILout of memory");
+			return 0;
+		}
+	}
+
+	/* Drop what is left of a download that never completed */
+	if (download_stream) {
+		fb_mmc_stream_finish();
+		download_stream = 0;
+	}
+
+	strcpy(stream_response, "FAILstream incomplete");
+	if (fb_mmc_stream_start(stream_part, stream_response))
+		return 0;
+
+	printf("Streaming to '%s'\n", stream_part);
+	download_stream = 1;
+	return 1;
 }
+#endif
 
 static void cb_download(struct usb_ep *ep, struct usb_request *req)
 {
@@ -447,9 +524,14 @@ static void cb_download(struct usb_ep *ep, struct usb_request *req)
 
 	if (0 == download_size) {
 		sprintf(response, "FAILdata invalid size");
-	} else if (download_size > CONFIG_USB_FASTBOOT_BUF_SIZE) {
+	} else if (download_size > download_max_size()) {
 		download_size = 0;
 		sprintf(response, "FAILdata too large");
+#ifdef CONFIG_FASTBOOT_FLASH_STREAM
+	} else if (stream_part[0] && !download_stream_start()) {
+		download_size = 0;
+		strcpy(response, stream_response);
+#endif
 	} else {
 		sprintf(response, "DATA%08x", download_size);
 		req->complete = rx_handler_dl_image;
@@ -494,6 +576,17 @@ static void cb_flash(struct usb_ep *ep, struct usb_request *req)
 	}
 
 	strcpy(response, "FAILno flash device defined");
+#ifdef CONFIG_FASTBOOT_FLASH_STREAM
+	if (stream_part[0]) {
+		/* The image has already been written during the download */
+		if (strcmp(cmd, stream_part))
+			strcpy(response, "FAILimage was streamed elsewhere");
+		else
+			strcpy(response, stream_response);
+		fastboot_tx_write_str(response);
+		return;
+	}
+#endif
 #ifdef CONFIG_FASTBOOT_FLASH_MMC_DEV
 	fb_mmc_flash_write(cmd, (void *)CONFIG_USB_FASTBOOT_BUF_ADDR,
 			   download_bytes, response);
@@ -502,6 +595,38 @@ static void cb_flash(struct usb_ep *ep, struct usb_request *req)
 }
 #endif
 
+#ifdef CONFIG_FASTBOOT_FLASH_STREAM
+static void cb_oem_stream(struct usb_ep *ep, struct usb_request *req)
+{
+	char *cmd = req->buf + strlen("oem stream");
+	char response[RESPONSE_LEN];
+
+	while (*cmd == ' ' || *cmd == ':')
+		cmd++;
+	if (!*cmd) {
+		/* "oem stream" alone goes back to buffered downloads */
+		stream_part[0] = '\0';
+		fastboot_tx_write_str("OKAY");
+		return;
+	}
+
+	if (strlen(cmd) >= sizeof(stream_part)) {
+		fastboot_tx_write_str("FAILpartition name too long");
+		return;
+	}
+
+	strcpy(response, "OKAY");
+	if (!fb_mmc_part_size(cmd, response)) {
+		fastboot_tx_write_str(response);
+		return;
+	}
+
+	strcpy(stream_part, cmd);
+	strcpy(stream_response, "FAILnothing downloaded");
+	fastboot_tx_write_str("OKAY");
+}
+#endif
+
 struct cmd_dispatch_info {
 	char *cmd;
 	void (*cb)(struct usb_ep *ep, struct usb_request *req);
@@ -527,6 +652,12 @@ static const struct cmd_dispatch_info cmd_dispatch_info[] = {
 		.cb = cb_flash,
 	},
 #endif
+#ifdef CONFIG_FASTBOOT_FLASH_STREAM
+	{
+		.cmd = "oem stream",
+		.cb = cb_oem_stream,
+	},
+#endif
 };
 
 static void rx_handler_command(struct usb_ep *ep, struct usb_request *req)
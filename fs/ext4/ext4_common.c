@@ -80,28 +80,22 @@ void put_ext4(uint64_t off, void *buf, uint32_t size)
 
 	if (remainder) {
 		if (fs->dev_desc->block_read) {
-			fs->dev_desc->block_read(fs->dev_desc->dev,
-						 startblock, 1, sec_buf);
+			blk_dread(fs->dev_desc, startblock, 1, sec_buf);
 			temp_ptr = sec_buf;
 			memcpy((temp_ptr + remainder),
 			       (unsigned char *)buf, size);
-			fs->dev_desc->block_write(fs->dev_desc->dev,
-						  startblock, 1, sec_buf);
+			blk_dwrite(fs->dev_desc, startblock, 1, sec_buf);
 		}
 	} else {
 		if (size >> log2blksz != 0) {
-			fs->dev_desc->block_write(fs->dev_desc->dev,
-						  startblock,
-						  size >> log2blksz,
-						  (unsigned long *)buf);
+			blk_dwrite(fs->dev_desc, startblock,
+				   size >> log2blksz, (unsigned long *)buf);
 		} else {
-			fs->dev_desc->block_read(fs->dev_desc->dev,
-						 startblock, 1, sec_buf);
+			blk_dread(fs->dev_desc, startblock, 1, sec_buf);
 			temp_ptr = sec_buf;
 			memcpy(temp_ptr, buf, size);
-			fs->dev_desc->block_write(fs->dev_desc->dev,
-						  startblock, 1,
-						  (unsigned long *)sec_buf);
+			blk_dwrite(fs->dev_desc, startblock, 1,
+				   (unsigned long *)sec_buf);
 		}
 	}
 }
@@ -1839,6 +1833,182 @@ long int read_allocated_block(struct ext2_inode *inode, int fileblock)
 	return blknr;
 }
 
+/*
+ * Extent map of the file being read, so that ext4fs_read_file() does not
+ * walk the extent tree for every block. It is built once per file from
+ * all leaves of the tree and dropped again by ext4fs_close().
+ */
+static struct ext4_extent_map ext4fs_extmap;
+
+void ext4fs_free_extent_map(void)
+{
+	free(ext4fs_extmap.runs);
+	memset(&ext4fs_extmap, 0, sizeof(ext4fs_extmap));
+}
+
+static int ext4fs_extent_map_add(struct ext4_extent_map *map,
+				 struct ext4_extent *extent)
+{
+	struct ext4_extent_run *run, *runs;
+	uint32_t len = le16_to_cpu(extent->ee_len);
+	uint64_t start;
+
+	start = le16_to_cpu(extent->ee_start_hi);
+	start = (start << 32) + le32_to_cpu(extent->ee_start_lo);
+
+	/* Unwritten extents read back as zeroes, just like holes */
+	if (len > EXT4_EXT_INIT_MAX_LEN) {
+		len -= EXT4_EXT_INIT_MAX_LEN;
+		start = 0;
+	}
+
+	if (map->count == map->size) {
+		map->size = map->size ? map->size * 2 : 16;
+		runs = malloc(map->size * sizeof(*runs));
+		if (!runs)
+			return -ENOMEM;
+		memcpy(runs, map->runs, map->count * sizeof(*runs));
+		free(map->runs);
+		map->runs = runs;
+	}
+
+	run = &map->runs[map->count];
+	run->fileblock = le32_to_cpu(extent->ee_block);
+	run->len = len;
+	run->start = start;
+
+	/* Lookups are binary searches, the tree has to be sorted */
+	if (map->count && run->fileblock < run[-1].fileblock + run[-1].len)
+		return -EINVAL;
+	map->count++;
+
+	return 0;
+}
+
+static int ext4fs_extent_map_walk(struct ext4_extent_map *map,
+				  struct ext4_extent_header *ext_block,
+				  int depth, int log2_blksz)
+{
+	struct ext4_extent_idx *index;
+	unsigned long long block;
+	int blksz = EXT2_BLOCK_SIZE(ext4fs_root);
+	int entries, i, err = 0;
+	char *buf;
+
+	if (le16_to_cpu(ext_block->eh_magic) != EXT4_EXT_MAGIC ||
+	    le16_to_cpu(ext_block->eh_depth) != depth)
+		return -EINVAL;
+
+	entries = le16_to_cpu(ext_block->eh_entries);
+	if (!depth) {
+		for (i = 0; i < entries && !err; i++)
+			err = ext4fs_extent_map_add(map,
+				(struct ext4_extent *)(ext_block + 1) + i);
+		return err;
+	}
+
+	buf = zalloc(blksz);
+	if (!buf)
+		return -ENOMEM;
+
+	index = (struct ext4_extent_idx *)(ext_block + 1);
+	for (i = 0; i < entries && !err; i++) {
+		block = le16_to_cpu(index[i].ei_leaf_hi);
+		block = (block << 32) + le32_to_cpu(index[i].ei_leaf_lo);
+
+		if (!ext4fs_devread((lbaint_t)block << log2_blksz, 0, blksz,
+				    buf))
+			err = -EIO;
+		else
+			err = ext4fs_extent_map_walk(map,
+				(struct ext4_extent_header *)buf, depth - 1,
+				log2_blksz);
+	}
+
+	free(buf);
+	return err;
+}
+
+/**
+ * ext4fs_get_extent_map() - Extent map of an extent based file
+ *
+ * @node:	file to map
+ * @return the map, NULL if the file has no extents or the tree is broken
+ */
+struct ext4_extent_map *ext4fs_get_extent_map(struct ext2fs_node *node)
+{
+	struct ext4_extent_header *ext_block;
+	struct ext4_extent_map *map = &ext4fs_extmap;
+	int log2_blksz;
+
+	if (!(le32_to_cpu(node->inode.flags) & EXT4_EXTENTS_FL))
+		return NULL;
+
+	if (map->runs && map->data == node->data && map->ino == node->ino)
+		return map;
+
+	ext4fs_free_extent_map();
+	log2_blksz = LOG2_BLOCK_SIZE(ext4fs_root) -
+		     get_fs()->dev_desc->log2blksz;
+	ext_block = (struct ext4_extent_header *)node->inode.b.blocks.dir_blocks;
+
+	if (ext4fs_extent_map_walk(map, ext_block,
+				   le16_to_cpu(ext_block->eh_depth),
+				   log2_blksz) || !map->count) {
+		ext4fs_free_extent_map();
+		return NULL;
+	}
+
+	map->data = node->data;
+	map->ino = node->ino;
+	debug("ext4fs extent map of inode %d: %d runs\n", map->ino,
+	      map->count);
+
+	return map;
+}
+
+/**
+ * ext4fs_extent_map_lookup() - Find the filesystem block of a file block
+ *
+ * @map:	map from ext4fs_get_extent_map()
+ * @fileblock:	block in the file
+ * @blknr:	returns the filesystem block, 0 in holes
+ * @return number of blocks from @fileblock on that are consecutive on the
+ * device, or part of the same hole
+ */
+uint32_t ext4fs_extent_map_lookup(struct ext4_extent_map *map,
+				  uint32_t fileblock, uint64_t *blknr)
+{
+	struct ext4_extent_run *run;
+	int lo = 0, hi = map->count, mid;
+
+	/* Find the last run starting at or before fileblock */
+	while (hi - lo > 1) {
+		mid = (lo + hi) / 2;
+		if (map->runs[mid].fileblock <= fileblock)
+			lo = mid;
+		else
+			hi = mid;
+	}
+
+	run = &map->runs[lo];
+	*blknr = 0;
+	if (fileblock < run->fileblock)
+		return run->fileblock - fileblock;
+
+	if (fileblock - run->fileblock < run->len) {
+		if (run->start)
+			*blknr = run->start + fileblock - run->fileblock;
+		return run->len - (fileblock - run->fileblock);
+	}
+
+	/* In the hole after the run */
+	if (lo + 1 < map->count)
+		return run[1].fileblock - fileblock;
+
+	return -1U - fileblock;
+}
+
 /**
  * ext4fs_reinit_global() - Reinitialize values of ext4 write implementation's
  *			    global pointers
@@ -1874,6 +2044,7 @@ void ext4fs_reinit_global(void)
 }
 void ext4fs_close(void)
 {
+	ext4fs_free_extent_map();
 	if ((ext4fs_file != NULL) && (ext4fs_root != NULL)) {
 		ext4fs_free_node(ext4fs_file, &ext4fs_root->diropen);
 		ext4fs_file = NULL;
@@ -2178,6 +2349,9 @@ int ext4fs_open(const char *filename)
 	if (ext4fs_root == NULL)
 		return -1;
 
+	/* a file read in pieces is opened for every piece */
+	if (ext4fs_file)
+		ext4fs_free_node(ext4fs_file, &ext4fs_root->diropen);
 	ext4fs_file = NULL;
 	status = ext4fs_find_file(filename, &ext4fs_root->diropen, &fdiro,
 				  FILETYPE_REG);
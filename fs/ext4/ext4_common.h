@@ -57,6 +57,26 @@ int ext4fs_find_file(const char *path, struct ext2fs_node *rootnode,
 int ext4fs_iterate_dir(struct ext2fs_node *dir, char *name,
 			struct ext2fs_node **fnode, int *ftype);
 
+/* File blocks mapped to consecutive filesystem blocks, start 0 for holes */
+struct ext4_extent_run {
+	uint32_t fileblock;
+	uint32_t len;
+	uint64_t start;
+};
+
+struct ext4_extent_map {
+	struct ext2_data *data;		/* filesystem and inode mapped */
+	int ino;
+	int count;
+	int size;			/* runs allocated */
+	struct ext4_extent_run *runs;
+};
+
+struct ext4_extent_map *ext4fs_get_extent_map(struct ext2fs_node *node);
+uint32_t ext4fs_extent_map_lookup(struct ext4_extent_map *map,
+				  uint32_t fileblock, uint64_t *blknr);
+void ext4fs_free_extent_map(void);
+
 #if defined(CONFIG_EXT4_WRITE)
 uint32_t ext4fs_div_roundup(uint32_t size, uint32_t n);
 int ext4fs_checksum_update(unsigned int i);
@@ -846,6 +846,9 @@ int ext4fs_write(const char *fname, unsigned char *buffer,
 	if (!g_parent_inode)
 		goto fail;
 
+	/* The file and its directory may get new extents */
+	ext4fs_free_extent_map();
+
 	if (ext4fs_init() != 0) {
 		printf("error in File System init\n");
 		return -1;
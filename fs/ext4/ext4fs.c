@@ -40,6 +40,45 @@ void ext4fs_free_node(struct ext2fs_node *node, struct ext2fs_node *currroot)
 		free(node);
 }
 
+/*
+ * Read extent based files one extent at a time, each with a single
+ * ext4fs_devread(), using the map instead of walking the extent tree
+ * for every block.
+ */
+static int ext4fs_read_extents(struct ext4_extent_map *map, int pos,
+			       unsigned int len, char *buf)
+{
+	struct ext_filesystem *fs = get_fs();
+	int log2blksz = fs->dev_desc->log2blksz;
+	int log2_fs_blocksize = LOG2_BLOCK_SIZE(ext4fs_root);
+	unsigned int blocksize = 1 << log2_fs_blocksize;
+	unsigned int skip, size, end = pos + len;
+	uint32_t fileblock, nblocks;
+	uint64_t blknr;
+
+	while (pos < end) {
+		fileblock = pos >> log2_fs_blocksize;
+		skip = pos & (blocksize - 1);
+		nblocks = ext4fs_extent_map_lookup(map, fileblock, &blknr);
+
+		size = end - pos;
+		if ((uint64_t)nblocks * blocksize - skip < size)
+			size = nblocks * blocksize - skip;
+
+		if (!blknr)
+			memset(buf, 0, size);
+		else if (!ext4fs_devread((lbaint_t)blknr <<
+					 (log2_fs_blocksize - log2blksz),
+					 skip, size, buf))
+			return -1;
+
+		pos += size;
+		buf += size;
+	}
+
+	return len;
+}
+
 /*
  * Taken from openmoko-kernel mailing list: By Andy green
  * Optimized read file API : collects and defers contiguous sector
@@ -61,12 +100,17 @@ int ext4fs_read_file(struct ext2fs_node *node, int pos,
 	lbaint_t delayed_skipfirst = 0;
 	lbaint_t delayed_next = 0;
 	char *delayed_buf = NULL;
+	struct ext4_extent_map *map;
 	short status;
 
 	/* Adjust len so it we can't read past the end of the file. */
 	if (len > filesize)
 		len = filesize;
 
+	map = ext4fs_get_extent_map(node);
+	if (map)
+		return ext4fs_read_extents(map, pos, len, buf);
+
 	blockcnt = ((len + pos) + blocksize - 1) / blocksize;
 
 	for (i = pos / blocksize; i < blockcnt; i++) {
@@ -213,21 +257,18 @@ int ext4_read_file(const char *filename, void *buf, int offset, int len)
 	int file_len;
 	int len_read;
 
-	if (offset != 0) {
-		printf("** Cannot support non-zero offset **\n");
-		return -1;
-	}
-
 	file_len = ext4fs_open(filename);
 	if (file_len < 0) {
 		printf("** File not found %s **\n", filename);
 		return -1;
 	}
 
-	if (len == 0)
-		len = file_len;
+	if (offset >= file_len)
+		return 0;
+	if (len == 0 || len > file_len - offset)
+		len = file_len - offset;
 
-	len_read = ext4fs_read(buf, len);
+	len_read = ext4fs_read_file(ext4fs_file, offset, len, buf);
 
 	return len_read;
 }
@@ -48,8 +48,94 @@ static int disk_read(__u32 block, __u32 nr_blocks, void *buf)
 	if (!cur_dev || !cur_dev->block_read)
 		return -1;
 
-	return cur_dev->block_read(cur_dev->dev,
-			cur_part_info.start + block, nr_blocks, buf);
+	return blk_dread(cur_dev, cur_part_info.start + block, nr_blocks, buf);
+}
+
+/* File contents are read once, keep them out of the block cache */
+static int disk_read_data(__u32 block, __u32 nr_blocks, void *buf)
+{
+	if (!cur_dev || !cur_dev->block_read)
+		return -1;
+
+	return cur_dev->block_read(cur_dev->dev, cur_part_info.start + block,
+				   nr_blocks, buf);
+}
+
+/*
+ * FAT sectors are cached in CONFIG_FAT_CACHE_WINDOWS windows of
+ * FATBUFBLOCKS sectors, evicting the least recently used window first.
+ * A fragmented file jumps back and forth between a few areas of the FAT,
+ * which a single window would have to re-read every time. The cache lives
+ * as long as the device is set, fat_set_blk_dev() and FAT writes drop it.
+ */
+#ifndef CONFIG_FAT_CACHE_WINDOWS
+#define CONFIG_FAT_CACHE_WINDOWS	8
+#endif
+
+static struct {
+	__u8	*buf;		/* all windows, allocated for sect_size */
+	__u16	sect_size;
+	__u32	tick;
+	int	bufnum[CONFIG_FAT_CACHE_WINDOWS];	/* -1 when empty */
+	__u32	used[CONFIG_FAT_CACHE_WINDOWS];		/* tick of last use */
+} fat_cache;
+
+static void fat_cache_invalidate(void)
+{
+	int i;
+
+	for (i = 0; i < CONFIG_FAT_CACHE_WINDOWS; i++) {
+		fat_cache.bufnum[i] = -1;
+		fat_cache.used[i] = 0;
+	}
+}
+
+/* Return the cache window holding FAT block 'bufnum', NULL on errors */
+static __u8 *fat_cache_get(fsdata *mydata, __u32 bufnum)
+{
+	__u32 getsize = FATBUFBLOCKS;
+	__u32 startblock = bufnum * FATBUFBLOCKS;
+	__u8 *bufptr;
+	int i, victim = 0;
+
+	if (fat_cache.sect_size != mydata->sect_size) {
+		free(fat_cache.buf);
+		fat_cache.buf = memalign(ARCH_DMA_MINALIGN,
+					 CONFIG_FAT_CACHE_WINDOWS * FATBUFSIZE);
+		if (!fat_cache.buf) {
+			debug("Error: allocating memory\n");
+			fat_cache.sect_size = 0;
+			return NULL;
+		}
+		fat_cache.sect_size = mydata->sect_size;
+		fat_cache_invalidate();
+	}
+
+	for (i = 0; i < CONFIG_FAT_CACHE_WINDOWS; i++) {
+		if (fat_cache.bufnum[i] == (int)bufnum) {
+			fat_cache.used[i] = ++fat_cache.tick;
+			return fat_cache.buf + i * FATBUFSIZE;
+		}
+		if (fat_cache.used[i] < fat_cache.used[victim])
+			victim = i;
+	}
+
+	/* Read a new block of FAT entries into the cache. */
+	if (startblock + getsize > mydata->fatlength)
+		getsize = mydata->fatlength - startblock;
+
+	startblock += mydata->fat_sect;	/* Offset from start of disk */
+
+	bufptr = fat_cache.buf + victim * FATBUFSIZE;
+	fat_cache.bufnum[victim] = -1;
+	if (disk_read(startblock, getsize, bufptr) != getsize) {
+		debug("Error reading FAT blocks\n");
+		return NULL;
+	}
+	fat_cache.bufnum[victim] = bufnum;
+	fat_cache.used[victim] = ++fat_cache.tick;
+
+	return bufptr;
 }
 
 int fat_set_blk_dev(block_dev_desc_t *dev_desc, disk_partition_t *info)
@@ -58,6 +144,7 @@ int fat_set_blk_dev(block_dev_desc_t *dev_desc, disk_partition_t *info)
 
 	cur_dev = dev_desc;
 	cur_part_info = *info;
+	fat_cache_invalidate();
 
 	/* Make sure it has a valid FAT header */
 	if (disk_read(0, 1, buffer) != 1) {
@@ -164,6 +251,7 @@ static __u32 get_fatent(fsdata *mydata, __u32 entry)
 	__u32 off16, offset;
 	__u32 ret = 0x00;
 	__u16 val1, val2;
+	__u8 *fatbuf;
 
 	switch (mydata->fatsize) {
 	case 32:
@@ -187,57 +275,42 @@ static __u32 get_fatent(fsdata *mydata, __u32 entry)
 	debug("FAT%d: entry: 0x%04x = %d, offset: 0x%04x = %d\n",
 	       mydata->fatsize, entry, entry, offset, offset);
 
-	/* Read a new block of FAT entries into the cache. */
-	if (bufnum != mydata->fatbufnum) {
-		__u32 getsize = FATBUFBLOCKS;
-		__u8 *bufptr = mydata->fatbuf;
-		__u32 fatlength = mydata->fatlength;
-		__u32 startblock = bufnum * FATBUFBLOCKS;
-
-		if (startblock + getsize > fatlength)
-			getsize = fatlength - startblock;
-
-		startblock += mydata->fat_sect;	/* Offset from start of disk */
-
-		if (disk_read(startblock, getsize, bufptr) < 0) {
-			debug("Error reading FAT blocks\n");
-			return ret;
-		}
-		mydata->fatbufnum = bufnum;
-	}
+	fatbuf = fat_cache_get(mydata, bufnum);
+	if (!fatbuf)
+		return ret;
 
 	/* Get the actual entry from the table */
 	switch (mydata->fatsize) {
 	case 32:
-		ret = FAT2CPU32(((__u32 *) mydata->fatbuf)[offset]);
+		ret = FAT2CPU32(((__u32 *) fatbuf)[offset]);
 		break;
 	case 16:
-		ret = FAT2CPU16(((__u16 *) mydata->fatbuf)[offset]);
+		ret = FAT2CPU16(((__u16 *) fatbuf)[offset]);
 		break;
 	case 12:
 		off16 = (offset * 3) / 4;
 
 		switch (offset & 0x3) {
 		case 0:
-			ret = FAT2CPU16(((__u16 *) mydata->fatbuf)[off16]);
+			ret = FAT2CPU16(((__u16 *) fatbuf)[off16]);
 			ret &= 0xfff;
 			break;
 		case 1:
-			val1 = FAT2CPU16(((__u16 *)mydata->fatbuf)[off16]);
+			val1 = FAT2CPU16(((__u16 *)fatbuf)[off16]);
 			val1 &= 0xf000;
-			val2 = FAT2CPU16(((__u16 *)mydata->fatbuf)[off16 + 1]);
+			val2 = FAT2CPU16(((__u16 *)fatbuf)[off16 + 1]);
 			val2 &= 0x00ff;
 			ret = (val2 << 4) | (val1 >> 12);
 			break;
 		case 2:
-			val1 = FAT2CPU16(((__u16 *)mydata->fatbuf)[off16]);
+			val1 = FAT2CPU16(((__u16 *)fatbuf)[off16]);
 			val1 &= 0xff00;
-			val2 = FAT2CPU16(((__u16 *)mydata->fatbuf)[off16 + 1]);
+			val2 = FAT2CPU16(((__u16 *)fatbuf)[off16 + 1]);
 			val2 &= 0x000f;
 			ret = (val2 << 8) | (val1 >> 8);
 			break;
 		case 3:
-			ret = FAT2CPU16(((__u16 *)mydata->fatbuf)[off16]);
+			ret = FAT2CPU16(((__u16 *)fatbuf)[off16]);
 			ret = (ret & 0xfff0) >> 4;
 			break;
 		default:
@@ -252,11 +325,13 @@ static __u32 get_fatent(fsdata *mydata, __u32 entry)
 }
 
 /*
- * Read at most 'size' bytes from the specified cluster into 'buffer'.
+ * Read at most 'size' bytes from the specified cluster into 'buffer'
+ * with 'read', disk_read() or disk_read_data().
  * Return 0 on success, -1 otherwise.
  */
 static int
-get_cluster(fsdata *mydata, __u32 clustnum, __u8 *buffer, unsigned long size)
+__get_cluster(fsdata *mydata, __u32 clustnum, __u8 *buffer, unsigned long size,
+	      int (*read)(__u32 block, __u32 nr_blocks, void *buf))
 {
 	__u32 idx = 0;
 	__u32 startsect;
@@ -277,7 +352,7 @@ get_cluster(fsdata *mydata, __u32 clustnum, __u8 *buffer, unsigned long size)
 		printf("FAT: Misaligned buffer address (%p)\n", buffer);
 
 		while (size >= mydata->sect_size) {
-			ret = disk_read(startsect++, 1, tmpbuf);
+			ret = read(startsect++, 1, tmpbuf);
 			if (ret != 1) {
 				debug("Error reading data (got %d)\n", ret);
 				return -1;
@@ -289,7 +364,7 @@ get_cluster(fsdata *mydata, __u32 clustnum, __u8 *buffer, unsigned long size)
 		}
 	} else {
 		idx = size / mydata->sect_size;
-		ret = disk_read(startsect, idx, buffer);
+		ret = read(startsect, idx, buffer);
 		if (ret != idx) {
 			debug("Error reading data (got %d)\n", ret);
 			return -1;
@@ -302,7 +377,7 @@ get_cluster(fsdata *mydata, __u32 clustnum, __u8 *buffer, unsigned long size)
 	if (size) {
 		ALLOC_CACHE_ALIGN_BUFFER(__u8, tmpbuf, mydata->sect_size);
 
-		ret = disk_read(startsect, 1, tmpbuf);
+		ret = read(startsect, 1, tmpbuf);
 		if (ret != 1) {
 			debug("Error reading data (got %d)\n", ret);
 			return -1;
@@ -314,6 +389,63 @@ get_cluster(fsdata *mydata, __u32 clustnum, __u8 *buffer, unsigned long size)
 	return 0;
 }
 
+static int
+get_cluster(fsdata *mydata, __u32 clustnum, __u8 *buffer, unsigned long size)
+{
+	return __get_cluster(mydata, clustnum, buffer, size, disk_read);
+}
+
+/* Consecutive clusters of a chain, see get_runs() */
+struct fat_run {
+	__u32	start;
+	__u32	count;
+};
+
+#define FAT_RUNS	32
+
+/*
+ * Follow the chain from '*clust' for up to 'nclust' clusters and collect
+ * it in up to FAT_RUNS runs of consecutive clusters, so that every run
+ * can be read with a single request. Only the FAT is read here.
+ * Returns the number of runs and sets '*clust' to the cluster after the
+ * last run, or to 0 if the chain ended early.
+ */
+static int get_runs(fsdata *mydata, __u32 *clust, __u32 nclust,
+		    struct fat_run *runs)
+{
+	__u32 cur = *clust, next;
+	int nruns = 1;
+
+	runs[0].start = cur;
+	runs[0].count = 1;
+
+	while (--nclust) {
+		next = get_fatent(mydata, cur);
+		if (CHECK_CLUST(next, mydata->fatsize)) {
+			debug("curclust: 0x%x\n", next);
+			*clust = 0;
+			return nruns;
+		}
+
+		if (next == cur + 1) {
+			runs[nruns - 1].count++;
+		} else {
+			if (nruns == FAT_RUNS) {
+				*clust = next;
+				return nruns;
+			}
+			runs[nruns].start = next;
+			runs[nruns].count = 1;
+			nruns++;
+		}
+		cur = next;
+	}
+
+	/* 'nclust' clusters were asked for, the caller needs no more */
+	*clust = 0;
+	return nruns;
+}
+
 /*
  * Read at most 'maxsize' bytes from 'pos' in the file associated with 'dentptr'
  * into 'buffer'.
@@ -329,8 +461,9 @@ get_contents(fsdata *mydata, dir_entry *dentptr, unsigned long pos,
 	unsigned long filesize = FAT2CPU32(dentptr->size), gotsize = 0;
 	unsigned int bytesperclust = mydata->clust_size * mydata->sect_size;
 	__u32 curclust = START(dentptr);
-	__u32 endclust, newclust;
+	struct fat_run runs[FAT_RUNS];
 	unsigned long actsize;
+	int nruns, i;
 
 	debug("Filesize: %ld bytes\n", filesize);
 
@@ -386,50 +519,31 @@ get_contents(fsdata *mydata, dir_entry *dentptr, unsigned long pos,
 		}
 	}
 
-	actsize = bytesperclust;
-	endclust = curclust;
-
-	do {
-		/* search for consecutive clusters */
-		while (actsize < filesize) {
-			newclust = get_fatent(mydata, endclust);
-			if ((newclust - 1) != endclust)
-				goto getit;
-			if (CHECK_CLUST(newclust, mydata->fatsize)) {
-				debug("curclust: 0x%x\n", newclust);
-				debug("Invalid FAT entry\n");
-				return gotsize;
+	while (filesize) {
+		nruns = get_runs(mydata, &curclust,
+				 DIV_ROUND_UP(filesize, bytesperclust), runs);
+
+		for (i = 0; i < nruns && filesize; i++) {
+			actsize = min(filesize,
+				      (unsigned long)runs[i].count *
+				      bytesperclust);
+			if (__get_cluster(mydata, runs[i].start, buffer,
+					  actsize, disk_read_data) != 0) {
+				printf("Error reading cluster\n");
+				return -1;
 			}
-			endclust = newclust;
-			actsize += bytesperclust;
-		}
-
-		/* get remaining bytes */
-		actsize = filesize;
-		if (get_cluster(mydata, curclust, buffer, (int)actsize) != 0) {
-			printf("Error reading cluster\n");
-			return -1;
-		}
-		gotsize += actsize;
-		return gotsize;
-getit:
-		if (get_cluster(mydata, curclust, buffer, (int)actsize) != 0) {
-			printf("Error reading cluster\n");
-			return -1;
+			gotsize += actsize;
+			filesize -= actsize;
+			buffer += actsize;
 		}
-		gotsize += (int)actsize;
-		filesize -= actsize;
-		buffer += actsize;
 
-		curclust = get_fatent(mydata, endclust);
-		if (CHECK_CLUST(curclust, mydata->fatsize)) {
-			debug("curclust: 0x%x\n", curclust);
+		if (filesize && !curclust) {
 			printf("Invalid FAT entry\n");
 			return gotsize;
 		}
-		actsize = bytesperclust;
-		endclust = curclust;
-	} while (1);
+	}
+
+	return gotsize;
 }
 
 /*
@@ -865,13 +979,6 @@ do_fat_read_at(const char *filename, unsigned long pos, void *buffer,
 					(mydata->clust_size * 2);
 	}
 
-	mydata->fatbufnum = -1;
-	mydata->fatbuf = memalign(ARCH_DMA_MINALIGN, FATBUFSIZE);
-	if (mydata->fatbuf == NULL) {
-		debug("Error: allocating memory\n");
-		return -1;
-	}
-
 	if (vfat_enabled)
 		debug("VFAT Support enabled\n");
 
@@ -1159,7 +1266,6 @@ rootdir_done:
 	debug("Size: %d, got: %ld\n", FAT2CPU32(dentptr->size), ret);
 
 exit:
-	free(mydata->fatbuf);
 	return ret;
 }
 
@@ -1264,7 +1370,11 @@ int fat_read_file(const char *filename, void *buf, int offset, int len)
 {
 	int len_read;
 
-	len_read = file_fat_read_at(filename, offset, buf, len);
+	/* reads further into a file continue a load, say "reading" once */
+	if (offset)
+		len_read = do_fat_read_at(filename, offset, buf, len, LS_NO, 0);
+	else
+		len_read = file_fat_read_at(filename, offset, buf, len);
 	if (len_read == -1) {
 		printf("** Unable to read file %s **\n", filename);
 		return -1;
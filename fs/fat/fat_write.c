@@ -37,8 +37,11 @@ static int disk_write(__u32 block, __u32 nr_blocks, void *buf)
 		return -1;
 	}
 
-	return cur_dev->block_write(cur_dev->dev,
-			cur_part_info.start + block, nr_blocks,	buf);
+	/* The FAT may be written through any path, drop the read cache */
+	fat_cache_invalidate();
+
+	return blk_dwrite(cur_dev, cur_part_info.start + block, nr_blocks,
+			  buf);
 }
 
 /*
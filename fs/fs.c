@@ -21,6 +21,8 @@
 #include <fat.h>
 #include <fs.h>
 #include <sandboxfs.h>
+#include <decomp_stream.h>
+#include <malloc.h>
 #include <asm/io.h>
 
 DECLARE_GLOBAL_DATA_PTR;
@@ -270,6 +272,42 @@ int fs_read(const char *filename, ulong addr, int offset, int len)
 	return ret;
 }
 
+#ifdef CONFIG_DECOMP_STREAM
+int fs_read_stream(const char *filename, struct decomp_stream *ds)
+{
+	struct fstype_info *info = fs_get_info(fs_type);
+	int chunk = CONFIG_DECOMP_STREAM_CHUNK;
+	int pos = 0;
+	void *buf;
+	int len, ret = 0;
+
+	buf = memalign(ARCH_DMA_MINALIGN, chunk);
+	if (!buf) {
+		fs_close();
+		return -1;
+	}
+
+	for (;;) {
+		len = info->read(filename, buf, pos, chunk);
+		if (len <= 0) {
+			ret = len;
+			break;
+		}
+		pos += len;
+
+		/* stop at the end of the file or of the compressed data */
+		ret = decomp_stream_feed(ds, buf, len);
+		if (ret || len < chunk)
+			break;
+	}
+
+	free(buf);
+	fs_close();
+
+	return ret < 0 ? ret : pos;
+}
+#endif
+
 int fs_write(const char *filename, ulong addr, int offset, int len)
 {
 	struct fstype_info *info = fs_get_info(fs_type);
@@ -377,6 +415,72 @@ int do_load(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[],
 	return 0;
 }
 
+#ifdef CONFIG_DECOMP_STREAM
+int do_loadz(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[],
+		int fstype)
+{
+	struct decomp_stream ds;
+	unsigned long addr;
+	const char *addr_str;
+	const char *filename;
+	ulong len;
+	int len_read, err;
+	unsigned long time;
+	char *ep;
+
+	if (argc < 2)
+		return CMD_RET_USAGE;
+	if (argc > 5)
+		return CMD_RET_USAGE;
+
+	if (fs_set_blk_dev(argv[1], (argc >= 3) ? argv[2] : NULL, fstype))
+		return 1;
+
+	if (argc >= 4) {
+		addr = simple_strtoul(argv[3], &ep, 16);
+		if (ep == argv[3] || *ep != '\0')
+			return CMD_RET_USAGE;
+	} else {
+		addr_str = getenv("loadaddr");
+		if (addr_str != NULL)
+			addr = simple_strtoul(addr_str, NULL, 16);
+		else
+			addr = CONFIG_SYS_LOAD_ADDR;
+	}
+	if (argc >= 5) {
+		filename = argv[4];
+	} else {
+		filename = getenv("bootfile");
+		if (!filename) {
+			puts("** No boot file defined **\n");
+			return 1;
+		}
+	}
+
+	time = get_timer(0);
+	decomp_stream_init_image(&ds, map_sysmem(addr, 0), DECOMP_STREAM_ROOM);
+	len_read = fs_read_stream(filename, &ds);
+	err = decomp_stream_finish(&ds, &len);
+	time = get_timer(time);
+	unmap_sysmem(ds.dst);
+	if (len_read <= 0 || err)
+		return 1;
+
+	printf("%d bytes read, %lu bytes loaded in %lu ms", len_read, len,
+	       time);
+	if (time > 0) {
+		puts(" (");
+		print_size(len / time * 1000, "/s");
+		puts(")");
+	}
+	puts("\n");
+
+	setenv_hex("filesize", len);
+
+	return 0;
+}
+#endif
+
 int do_ls(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[],
 	int fstype)
 {
@@ -1737,6 +1737,10 @@ void ubifs_umount(struct ubifs_info *c)
 	free_wbufs(c);
 	free_orphans(c);
 	ubifs_lpt_free(c, 0);
+#ifdef __UBOOT__
+	/* the znodes cached by ubifs_ls() and ubifs_load() */
+	ubifs_tnc_close(c);
+#endif
 
 	kfree(c->cbuf);
 	kfree(c->rcvrd_mst_node);
@@ -2247,6 +2251,8 @@ static int ubifs_fill_super(struct super_block *sb, void *data, int silent)
 #else
 	/* U-Boot read only mode */
 	c->ubi = ubi_open_volume(c->vi.ubi_num, c->vi.vol_id, UBI_READONLY);
+	/* ubifs_load() reads runs of data nodes in one go */
+	c->bulk_read = 1;
 #endif
 
 	if (IS_ERR(c->ubi)) {
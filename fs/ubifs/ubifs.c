@@ -28,6 +28,7 @@
 
 #include <linux/err.h>
 #include <linux/lzo.h>
+#include <asm/io.h>
 
 DECLARE_GLOBAL_DATA_PTR;
 
@@ -133,6 +134,7 @@ static inline int crypto_comp_decompress(struct crypto_comp *tfm,
 				u8 *dst, unsigned int *dlen)
 {
 	struct ubifs_compressor *compr = ubifs_compressors[tfm->compressor];
+	size_t len = *dlen;
 	int err;
 
 	if (compr->compr_type == UBIFS_COMPR_NONE) {
@@ -141,7 +143,8 @@ static inline int crypto_comp_decompress(struct crypto_comp *tfm,
 		return 0;
 	}
 
-	err = compr->decompress(src, slen, dst, (size_t *)dlen);
+	err = compr->decompress(src, slen, dst, &len);
+	*dlen = len;
 	if (err)
 		ubifs_err("cannot decompress %d bytes, compressor %s, "
 			  "error %d", slen, compr->name, err);
@@ -562,6 +565,59 @@ static unsigned long ubifs_findfile(struct super_block *sb, char *filename)
 	return 0;
 }
 
+/* shrinker.c */
+
+#ifndef CONFIG_UBIFS_TNC_CACHE
+#define CONFIG_UBIFS_TNC_CACHE	2048
+#endif
+
+atomic_long_t ubifs_clean_zn_cnt;
+
+/* Free the clean znodes at @level below @znode, return how many went */
+static long shrink_tnc_level(struct ubifs_znode *znode, int level)
+{
+	struct ubifs_znode *child;
+	long freed = 0;
+	int n;
+
+	for (n = 0; n < znode->child_cnt; n++) {
+		child = znode->zbranch[n].znode;
+		if (!child)
+			continue;
+
+		if (child->level > level) {
+			freed += shrink_tnc_level(child, level);
+		} else if (!ubifs_zn_dirty(child)) {
+			freed += ubifs_destroy_tnc_subtree(child);
+			znode->zbranch[n].znode = NULL;
+		}
+	}
+
+	return freed;
+}
+
+/*
+ * The TNC keeps the index nodes it read for as long as the file-system is
+ * mounted, the next file mostly finds the upper levels of the index there.
+ * Once it holds more than CONFIG_UBIFS_TNC_CACHE znodes, drop them from the
+ * bottom level up, the root stays.
+ */
+static void shrink_tnc(struct ubifs_info *c)
+{
+	struct ubifs_znode *zroot = c->zroot.znode;
+	long freed;
+	int level;
+
+	for (level = 0; zroot && level < zroot->level; level++) {
+		if (atomic_long_read(&c->clean_zn_cnt) <= CONFIG_UBIFS_TNC_CACHE)
+			break;
+
+		freed = shrink_tnc_level(zroot, level);
+		atomic_long_sub(freed, &c->clean_zn_cnt);
+		atomic_long_sub(freed, &ubifs_clean_zn_cnt);
+	}
+}
+
 int ubifs_ls(char *filename)
 {
 	struct ubifs_info *c = ubifs_sb->s_fs_info;
@@ -573,6 +629,7 @@ int ubifs_ls(char *filename)
 	int ret = 0;
 
 	c->ubi = ubi_open_volume(c->vi.ubi_num, c->vi.vol_id, UBI_READONLY);
+	shrink_tnc(c);
 	inum = ubifs_findfile(ubifs_sb, filename);
 	if (!inum) {
 		ret = -1;
@@ -621,23 +678,13 @@ static inline void *kmap(struct page *page)
 	return page->addr;
 }
 
-static int read_block(struct inode *inode, void *addr, unsigned int block,
-		      struct ubifs_data_node *dn)
+static int decode_block(struct inode *inode, void *addr, unsigned int block,
+			struct ubifs_data_node *dn)
 {
 	struct ubifs_info *c = inode->i_sb->s_fs_info;
 	int err, len, out_len;
-	union ubifs_key key;
 	unsigned int dlen;
 
-	data_key_init(c, &key, inode->i_ino, block);
-	err = ubifs_tnc_lookup(c, &key, dn);
-	if (err) {
-		if (err == -ENOENT)
-			/* Not found, so it must be a hole */
-			memset(addr, 0, UBIFS_BLOCK_SIZE);
-		return err;
-	}
-
 	ubifs_assert(le64_to_cpu(dn->ch.sqnum) > ubifs_inode(inode)->creat_sqnum);
 
 	len = le32_to_cpu(dn->size);
@@ -668,6 +715,68 @@ dump:
 	return -EINVAL;
 }
 
+static int read_block(struct inode *inode, void *addr, unsigned int block,
+		      struct ubifs_data_node *dn)
+{
+	struct ubifs_info *c = inode->i_sb->s_fs_info;
+	union ubifs_key key;
+	int err;
+
+	data_key_init(c, &key, inode->i_ino, block);
+	err = ubifs_tnc_lookup(c, &key, dn);
+	if (err) {
+		if (err == -ENOENT)
+			/* Not found, so it must be a hole */
+			memset(addr, 0, UBIFS_BLOCK_SIZE);
+		return err;
+	}
+
+	return decode_block(inode, addr, block, dn);
+}
+
+/*
+ * Read the data nodes from @block on which follow each other in one LEB
+ * with a single flash read and decode them straight to @addr, holes in
+ * between zeroed. No more than @max blocks are written. Returns the number
+ * of blocks done, 0 if there is no data node to start with.
+ */
+static int bulk_read(struct ubifs_info *c, struct inode *inode, void *addr,
+		     unsigned int block, int max)
+{
+	struct bu_info *bu = &c->bu;
+	struct ubifs_data_node *dn;
+	int err, i, blk, done = 0;
+
+	data_key_init(c, &bu->key, inode->i_ino, block);
+	bu->buf_len = c->max_bu_buf_len;
+	err = ubifs_tnc_get_bu_keys(c, bu);
+	if (err || !bu->cnt)
+		return err;
+
+	err = ubifs_tnc_bulk_read(c, bu);
+	if (err)
+		return err;
+
+	dn = bu->buf;
+	for (i = 0; i < bu->cnt; i++) {
+		blk = key_block(c, &bu->zbranch[i].key) - block;
+		if (blk >= max)
+			break;
+
+		memset(addr + done * UBIFS_BLOCK_SIZE, 0,
+		       (blk - done) * UBIFS_BLOCK_SIZE);
+		err = decode_block(inode, addr + blk * UBIFS_BLOCK_SIZE,
+				   block + blk, dn);
+		if (err)
+			return err;
+
+		done = blk + 1;
+		dn = (void *)dn + ALIGN(bu->zbranch[i].len, 8);
+	}
+
+	return done;
+}
+
 static int do_readpage(struct ubifs_info *c, struct inode *inode,
 		       struct page *page, int last_block_size)
 {
@@ -786,11 +895,12 @@ int ubifs_load(char *filename, u32 addr, u32 size)
 	struct inode *inode;
 	struct page page;
 	int err = 0;
-	int i;
+	int i, n;
 	int count;
 	int last_block_size = 0;
 
 	c->ubi = ubi_open_volume(c->vi.ubi_num, c->vi.vol_id, UBI_READONLY);
+	shrink_tnc(c);
 	/* ubifs_findfile will resolve symlinks, so we know that we get
 	 * the real file here */
 	inum = ubifs_findfile(ubifs_sb, filename);
@@ -820,10 +930,28 @@ int ubifs_load(char *filename, u32 addr, u32 size)
 	printf("Loading file '%s' to addr 0x%08x with size %d (0x%08x)...\n",
 	       filename, addr, size, size);
 
-	page.addr = (void *)addr;
+	page.addr = map_sysmem(addr, size);
 	page.index = 0;
 	page.inode = inode;
 	for (i = 0; i < count; i++) {
+		/*
+		 * All but the last block go straight to the destination, as
+		 * many in a row as were written next to each other
+		 */
+		if (c->bulk_read && i + 1 < count) {
+			n = bulk_read(c, inode, page.addr, i, count - 1 - i);
+			if (n < 0) {
+				err = n;
+				break;
+			}
+			if (n) {
+				page.addr += n * PAGE_SIZE;
+				page.index += n;
+				i += n - 1;
+				continue;
+			}
+		}
+
 		/*
 		 * Make sure to not read beyond the requested size
 		 */
@@ -64,12 +64,13 @@ struct page {
 void iput(struct inode *inode);
 
 /*
- * The atomic operations are used for budgeting etc which is not
- * needed for the read-only U-Boot implementation:
+ * The atomic operations are plain counters in the single threaded U-Boot,
+ * the number of clean znodes bounds the TNC cache
  */
-#define atomic_long_inc(a)
-#define atomic_long_dec(a)
-#define	atomic_long_sub(a, b)
+#define atomic_long_inc(a)	((*(a))++)
+#define atomic_long_dec(a)	((*(a))--)
+#define atomic_long_sub(a, b)	(*(b) -= (a))
+#define atomic_long_read(a)	(*(a))
 
 typedef unsigned long atomic_long_t;
 
@@ -26,3 +26,40 @@ static inline int is_sparse_image(void *buf)
 void write_sparse_image(block_dev_desc_t *dev_desc,
 		disk_partition_t *info, const char *part_name,
 		void *data, unsigned sz);
+
+/*
+ * Incremental writer for sparse (or plain) images, fed with the image
+ * in pieces of any size as it arrives. Only a staging buffer of
+ * CONFIG_FASTBOOT_SPARSE_BUF_SIZE is needed, not the whole image.
+ * Errors are reported through fastboot_fail(), success through
+ * fastboot_okay() from sparse_stream_finish().
+ */
+struct sparse_stream {
+	block_dev_desc_t *dev_desc;
+	disk_partition_t info;
+	char part_name[32];
+
+	int state;
+	sparse_header_t sparse_header;
+	chunk_header_t chunk_header;
+	u8 hdr[sizeof(sparse_header_t)] __aligned(4);
+	unsigned int hdr_len;	/* header bytes collected so far */
+	unsigned int skip;	/* input bytes to drop before going on */
+	u64 remaining;		/* data bytes left in the current raw chunk */
+	unsigned int chunk;	/* chunks done */
+	uint32_t total_blocks;
+
+	lbaint_t blk;		/* where the staged data goes */
+	u64 bytes_written;
+	void *buf;
+	unsigned int buf_size;
+	unsigned int buf_len;
+	uint32_t fill_val;
+	unsigned int fill_len;	/* bytes of buf still holding fill_val */
+};
+
+int sparse_stream_init(struct sparse_stream *ss, block_dev_desc_t *dev_desc,
+		       disk_partition_t *info, const char *part_name);
+int sparse_stream_write(struct sparse_stream *ss, const void *buf,
+			unsigned int len);
+int sparse_stream_finish(struct sparse_stream *ss);
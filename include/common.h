@@ -786,6 +786,10 @@ int	init_timebase (void);
 int gunzip(void *, int, unsigned char *, unsigned long *);
 int zunzip(void *dst, int dstlen, unsigned char *src, unsigned long *lenp,
 						int stoponerr, int offset);
+void *gzip_stream_init(void *dst, unsigned long dstlen);
+int gzip_stream_feed(void *stream, const void *src, unsigned long len,
+		     unsigned long *outlen);
+int gzip_stream_finish(void *stream);
 
 /* lib/qsort.c */
 void qsort(void *base, size_t nmemb, size_t size,
@@ -4,6 +4,20 @@
 #define CONFIG_SPL_PACKIMG
 #define CONFIG_PACKIMG
 
+/* Decrypt and check packimg entries on the secondary cores */
+#ifndef CONFIG_SPL_BUILD
+#define CONFIG_WORKER
+#endif
+
+/* Decompress images while they are loaded (loadz, sf read.z, packimg) */
+#ifndef CONFIG_SPL_BUILD
+#define CONFIG_DECOMP_STREAM
+#endif
+
+/* LZ4 compressed kernels, matches copied with NEON */
+#define CONFIG_LZ4
+#define CONFIG_ARMV7_NEON
+
 #ifdef CONFIG_AES_PACKIMG
 #define CONFIG_AES
 #define CONFIG_MXC_OCOTP
@@ -34,9 +48,14 @@
 	SPI flash data layout
 	1:		SPL				63k
 	64k:		u-boot.img		480k
-	544k:	env				224k
+	544k:	env				216k
+	760k:	sf update manifests	8k
 	768k:	pack(dtb,splash)	256k
 */
+/* sf update manifests of fl_uboot and fl_packimg, 4k each */
+#define RBCTRL_SF_UBOOT_MANIFEST	0xBE000
+#define RBCTRL_SF_PACK_MANIFEST		0xBF000
+
 #ifdef CONFIG_BOOT_SPI
 #define CONFIG_SYS_SPI_U_BOOT_OFFS	(64 * 1024)
 #define CONFIG_SYS_SPI_U_BOOT_SIZE	(480 * 1024)
@@ -46,9 +65,14 @@
 #define CONFIG_ENV_SPI_MAX_HZ		CONFIG_SF_DEFAULT_SPEED
 #define CONFIG_ENV_SPI_MODE			CONFIG_SF_DEFAULT_MODE
 #define CONFIG_ENV_OFFSET			(CONFIG_SYS_SPI_U_BOOT_OFFS+CONFIG_SYS_SPI_U_BOOT_SIZE)
-#define CONFIG_ENV_RANGE			(224 * 1024)
+#define CONFIG_ENV_RANGE			(216 * 1024)
 #define CONFIG_ENV_SECT_SIZE		(4 * 1024)
-#define CONFIG_SYS_SPI_PACK_OFFS	(CONFIG_ENV_OFFSET+CONFIG_ENV_RANGE)
+#define CONFIG_SYS_SPI_PACK_OFFS	(768 * 1024)
+/* The manifests sit between the env range and the pack */
+#if RBCTRL_SF_UBOOT_MANIFEST != CONFIG_ENV_OFFSET + CONFIG_ENV_RANGE || \
+    RBCTRL_SF_PACK_MANIFEST != CONFIG_SYS_SPI_PACK_OFFS - 4 * 1024
+#error "sf update manifests do not match the SPI flash layout"
+#endif
 #ifdef CONFIG_SPL_BUILD
 #define CONFIG_SPL_NAND_SUPPORT
 #define CONFIG_SPL_SPI_SUPPORT
@@ -101,13 +125,19 @@
 #define CONFIG_FSL_USDHC
 #define CONFIG_SYS_FSL_ESDHC_ADDR  USDHC2_BASE_ADDR
 #define CONFIG_SYS_FSL_USDHC_NUM   1
+#define CONFIG_FSL_ESDHC_ADMA2
 
 #define CONFIG_MMC
 #define CONFIG_CMD_MMC
+#define CONFIG_CMD_MMC_BENCH
 #define CONFIG_GENERIC_MMC
 #define CONFIG_CMD_EXT2
 #define CONFIG_CMD_FAT
 #define CONFIG_DOS_PARTITION
+#ifndef CONFIG_SPL_BUILD
+#define CONFIG_BLOCK_CACHE
+#define CONFIG_CMD_BLOCK_CACHE
+#endif
 
 #define CONFIG_CMD_PING
 #define CONFIG_CMD_DHCP
@@ -119,6 +149,9 @@
 #define CONFIG_FEC_XCV_TYPE		RMII
 #define CONFIG_ETHPRIME			"FEC"
 #define CONFIG_FEC_MXC_PHYADDR		1
+#define CONFIG_TFTP_WINDOWSIZE		16
+#define CONFIG_IP_DEFRAG
+#define CONFIG_NFS_READ_SIZE		8192
 
 #define CONFIG_PHYLIB
 #define CONFIG_PHY_ATHEROS
@@ -147,6 +180,8 @@
 #define CONFIG_LZO
 #define CONFIG_CMD_UBI
 #define CONFIG_CMD_UBIFS
+#define CONFIG_MTD_UBI_FASTMAP
+#define CONFIG_MTD_UBI_FASTMAP_AUTOCONVERT	1
 
 #define CONFIG_SYS_NAND_BASE		0x40000000
 #define CONFIG_SYS_NAND_5_ADDR_CYCLE
@@ -216,9 +251,11 @@
     \
 	"fl_spl=mw.b ${loadaddr} 0xff 0x400 && setexpr tmpvar ${filesize} + 0x400 && " \
         "sf probe && sf update ${loadaddr} 0 ${filesize}\0" \
-	"fl_uboot=sf probe && sf update ${loadaddr} 0x10000 ${filesize}\0" \
+	"fl_uboot=sf probe && sf update ${loadaddr} 0x10000 ${filesize} " \
+		__stringify(RBCTRL_SF_UBOOT_MANIFEST) "\0" \
     "fl_env=sf probe && sf update ${loadaddr} 0x88000 ${filesize}\0" \
-	"fl_packimg=sf probe && sf update ${loadaddr} 0xC0000 ${filesize}\0" \
+	"fl_packimg=sf probe && sf update ${loadaddr} 0xC0000 ${filesize} " \
+		__stringify(RBCTRL_SF_PACK_MANIFEST) "\0" \
 	CMD_FLASH_KERNEL \
     "fl_rootfs=nand erase.part rootfs && " \
 	"  ubi part rootfs && " \
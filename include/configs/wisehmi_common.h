@@ -4,6 +4,20 @@
 #define CONFIG_SPL_PACKIMG
 #define CONFIG_PACKIMG
 
+/* Decrypt and check packimg entries on the secondary cores */
+#ifndef CONFIG_SPL_BUILD
+#define CONFIG_WORKER
+#endif
+
+/* Decompress images while they are loaded (loadz, sf read.z, packimg) */
+#ifndef CONFIG_SPL_BUILD
+#define CONFIG_DECOMP_STREAM
+#endif
+
+/* LZ4 compressed kernels, matches copied with NEON */
+#define CONFIG_LZ4
+#define CONFIG_ARMV7_NEON
+
 #ifdef CONFIG_AES_PACKIMG
 #define CONFIG_AES
 #define CONFIG_MXC_OCOTP
@@ -128,14 +142,20 @@
 #define CONFIG_FSL_USDHC
 #define CONFIG_SYS_FSL_ESDHC_ADDR  USDHC2_BASE_ADDR
 #define CONFIG_SYS_FSL_USDHC_NUM   1
+#define CONFIG_FSL_ESDHC_ADMA2
 
 #define CONFIG_MMC
 #define CONFIG_CMD_MMC
+#define CONFIG_CMD_MMC_BENCH
 #define CONFIG_CMD_MMC_PACKIMG
 #define CONFIG_GENERIC_MMC
 #define CONFIG_CMD_EXT2
 #define CONFIG_CMD_FAT
 #define CONFIG_DOS_PARTITION
+#ifndef CONFIG_SPL_BUILD
+#define CONFIG_BLOCK_CACHE
+#define CONFIG_CMD_BLOCK_CACHE
+#endif
 
 #define CONFIG_CMD_PING
 #define CONFIG_CMD_DHCP
@@ -147,6 +167,9 @@
 #define CONFIG_FEC_XCV_TYPE		RMII
 #define CONFIG_ETHPRIME			"FEC"
 #define CONFIG_FEC_MXC_PHYADDR		1
+#define CONFIG_TFTP_WINDOWSIZE		16
+#define CONFIG_IP_DEFRAG
+#define CONFIG_NFS_READ_SIZE		8192
 
 #define CONFIG_PHYLIB
 #define CONFIG_PHY_ATHEROS
@@ -0,0 +1,113 @@
+/*
+ * Streaming decompression
+ *
+ * Loaders hand the data to a decomp_stream chunk by chunk as it comes off
+ * the medium and it is decompressed straight to its destination. The
+ * compressed image never needs a staging buffer of its own and each chunk
+ * is decompressed while it is still in the cache.
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+#ifndef __DECOMP_STREAM_H__
+#define __DECOMP_STREAM_H__
+
+#include <image.h>
+
+/* Read size of the loaders, small enough to stay in the L2 cache */
+#ifndef CONFIG_DECOMP_STREAM_CHUNK
+#define CONFIG_DECOMP_STREAM_CHUNK	(256 << 10)
+#endif
+
+#ifndef CONFIG_SYS_BOOTM_LEN
+/* use 8MByte as default max gunzip size */
+#define CONFIG_SYS_BOOTM_LEN	0x800000
+#endif
+
+/* Room the loaders allow for a decompressed image and its header */
+#define DECOMP_STREAM_ROOM	(CONFIG_SYS_BOOTM_LEN + sizeof(image_header_t))
+
+struct decomp_stream {
+	int comp;		/* IH_COMP_... of the data */
+	void *state;		/* decompressor state */
+	unsigned char *dst;	/* output, after the header for an image */
+	ulong dst_len;		/* room at dst */
+	ulong out;		/* bytes written to dst */
+	int done;		/* end of the compressed data seen */
+	int err;		/* first error, sticks until finish */
+
+	/* Legacy image handling, see decomp_stream_init_image() */
+	int probe;		/* still collecting the first bytes */
+	int image;		/* payload of a legacy image is decompressed */
+	image_header_t hdr;	/* the header, or the first bytes to probe */
+	ulong probe_len;	/* bytes in hdr while probing */
+	ulong data_left;	/* payload bytes still to come */
+	uint32_t dcrc;		/* CRC32 of the payload fed */
+	uint32_t ocrc;		/* CRC32 of the output */
+};
+
+/**
+ * decomp_stream_supported() - Check whether data can be streamed
+ *
+ * @comp:	compression (IH_COMP_...)
+ * @return 1 if decomp_stream_init() accepts @comp, 0 if not
+ */
+int decomp_stream_supported(int comp);
+
+/**
+ * decomp_stream_init() - Start decompressing data of a known type
+ *
+ * @ds:		stream to set up
+ * @comp:	compression of the data (IH_COMP_...), IH_COMP_NONE copies
+ * @dst:	where the data goes
+ * @dst_len:	room at @dst
+ * @return 0 if OK, -ENOSYS if @comp cannot be streamed, -ENOMEM
+ */
+int decomp_stream_init(struct decomp_stream *ds, int comp, void *dst,
+		       ulong dst_len);
+
+/**
+ * decomp_stream_init_image() - Start decompressing data of unknown type
+ *
+ * The type is taken from the first bytes fed. A legacy image with a
+ * compressed payload is turned into an uncompressed one at @dst: the
+ * payload is decompressed to @dst + sizeof(image_header_t) and the
+ * header in front is rewritten for it once the stream is finished, so
+ * bootm runs the result in place when @dst is the load address minus
+ * the header. Raw gzip and lzop data are recognised by their magic,
+ * anything else is copied as it is.
+ *
+ * @ds:		stream to set up
+ * @dst:	where the data goes
+ * @dst_len:	room at @dst
+ * @return 0
+ */
+int decomp_stream_init_image(struct decomp_stream *ds, void *dst,
+			     ulong dst_len);
+
+/**
+ * decomp_stream_feed() - Decompress the next chunk
+ *
+ * Chunks can be of any size. Data after the end of the compressed data
+ * is ignored, so a loader may stop reading once 1 was returned.
+ *
+ * @ds:		stream
+ * @buf:	data, may be reused once this returns
+ * @len:	bytes at @buf
+ * @return 0 if more data is wanted, 1 at the end of the data, -ve on error
+ */
+int decomp_stream_feed(struct decomp_stream *ds, const void *buf, ulong len);
+
+/**
+ * decomp_stream_finish() - Finish the stream and release it
+ *
+ * Must be called for every stream set up, also after errors.
+ *
+ * @ds:		stream
+ * @lenp:	returns the bytes written at dst, including the header of a
+ *		decompressed legacy image
+ * @return 0 if the data was complete and valid, -ve on error
+ */
+int decomp_stream_finish(struct decomp_stream *ds, ulong *lenp);
+
+#endif /* __DECOMP_STREAM_H__ */
@@ -30,6 +30,7 @@
 
 #define EXT4_EXTENTS_FL		0x00080000 /* Inode uses extents */
 #define EXT4_EXT_MAGIC			0xf30a
+#define EXT4_EXT_INIT_MAX_LEN		(1 << 15) /* longer ones are unwritten */
 #define EXT4_FEATURE_RO_COMPAT_GDT_CSUM	0x0010
 #define EXT4_FEATURE_INCOMPAT_EXTENTS	0x0040
 #define EXT4_INDIRECT_BLOCKS		12
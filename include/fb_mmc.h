@@ -6,3 +6,13 @@
 
 void fb_mmc_flash_write(const char *cmd, void *download_buffer,
 			unsigned int download_bytes, char *response);
+
+/*
+ * Write an image to a partition while it is being downloaded. The
+ * result ends up in @response, which has to stay around until
+ * fb_mmc_stream_finish() returns.
+ */
+u64 fb_mmc_part_size(const char *cmd, char *response);
+int fb_mmc_stream_start(const char *cmd, char *response);
+int fb_mmc_stream_write(const void *data, unsigned int len);
+int fb_mmc_stream_finish(void);
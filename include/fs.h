@@ -68,6 +68,18 @@ int fs_size(const char *filename);
  */
 int fs_read(const char *filename, ulong addr, int offset, int len);
 
+struct decomp_stream;
+
+/*
+ * Read file "filename" from the partition previously set by fs_set_blk_dev()
+ * in pieces of CONFIG_DECOMP_STREAM_CHUNK bytes and feed them to "ds". The
+ * read stops early at the end of the compressed data. The caller sets up
+ * "ds" and finishes it.
+ *
+ * Returns number of bytes read on success. Returns <= 0 on error.
+ */
+int fs_read_stream(const char *filename, struct decomp_stream *ds);
+
 /*
  * Write file "filename" to the partition previously set by fs_set_blk_dev(),
  * from address "addr", starting at byte offset "offset", and writing "len"
@@ -86,6 +98,8 @@ int do_size(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[],
 		int fstype);
 int do_load(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[],
 		int fstype);
+int do_loadz(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[],
+		int fstype);
 int do_ls(cmd_tbl_t *cmdtp, int flag, int argc, char * const argv[],
 		int fstype);
 int file_exists(const char *dev_type, const char *dev_part, const char *file,
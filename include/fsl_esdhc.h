@@ -90,6 +90,8 @@
 #define PROCTL_INIT		0x00000020
 #define PROCTL_DTW_4		0x00000002
 #define PROCTL_DTW_8		0x00000004
+#define PROCTL_DMAS_MASK	0x00000300
+#define PROCTL_DMAS_ADMA2	0x00000200
 
 #define CMDARG			0x0002e008
 
@@ -17,6 +17,46 @@ enum {
 	HASH_FLAG_ENV		= 1 << 1,	/* Allow env vars */
 };
 
+/*
+ * One way of hashing whole blocks, e.g. SHA-256 with the NEON unit. An
+ * algorithm lists its backends best first, ending with the portable C one
+ * which has no usable() hook.
+ */
+struct hash_backend {
+	const char *name;
+	/* Non-zero if this CPU can run the backend now */
+	int (*usable)(void);
+	/*
+	 * blocks: Hash whole blocks into the algorithm's context
+	 *
+	 * @ctx:	The algorithm's context, e.g. sha256_context
+	 * @input:	Data, need not be aligned
+	 * @count:	Number of blocks
+	 */
+	void (*blocks)(void *ctx, const unsigned char *input,
+		       unsigned int count);
+};
+
+/**
+ * hash_pick_backend() - Find the first backend this CPU can run
+ *
+ * This is checked on each call rather than remembered, since the FPU may
+ * only be enabled later on and nothing can be written before relocation.
+ *
+ * @list:	Backends of an algorithm, ending with the C one
+ * @return the backend to use
+ */
+static inline const struct hash_backend *hash_pick_backend(
+		const struct hash_backend *list)
+{
+	while (list->usable && !list->usable())
+		list++;
+	return list;
+}
+
+extern const struct hash_backend sha1_backends[];
+extern const struct hash_backend sha256_backends[];
+
 #ifndef USE_HOSTCC
 #if defined(CONFIG_SHA1SUM_VERIFY) || defined(CONFIG_CRC32_VERIFY)
 #define CONFIG_HASH_VERIFY
@@ -75,6 +115,8 @@ struct hash_algo {
 	 */
 	int (*hash_finish)(struct hash_algo *algo, void *ctx, void *dest_buf,
 			   int size);
+	/* Block backends, best first, NULL if the algorithm has no choice */
+	const struct hash_backend *backends;
 };
 
 /**
@@ -114,6 +156,37 @@ int hash_command(const char *algo_name, int flags, cmd_tbl_t *cmdtp, int flag,
 int hash_block(const char *algo_name, const void *data, unsigned int len,
 	       uint8_t *output, int *output_size);
 
+/* Piece size of hash_copy(), copy and hash fit in the L1 cache together */
+#define HASH_COPY_CHUNK		(16 << 10)
+
+/* One hash computed by hash_copy() */
+struct hash_copy_op {
+	struct hash_algo *algo;
+	void *ctx;		/* from algo->hash_init() */
+};
+
+/**
+ * hash_copy() - Copy data and hash it in the same pass over memory
+ *
+ * The data is copied in chunks of HASH_COPY_CHUNK bytes and each chunk is
+ * hashed at the destination right after it was copied, while it is still
+ * in the cache, instead of hashing it in a sweep of its own. With @dst
+ * equal to @src the data is only hashed. A destination overlapping the
+ * source from above is hashed first and moved after.
+ *
+ * The hashes are updated but not finished, the caller calls hash_finish()
+ * for each of @ops whether or not this succeeds.
+ *
+ * @dst:	where the data goes
+ * @src:	data to copy
+ * @len:	bytes to copy, at least 1
+ * @ops:	hashes to update, each set up with its hash_init()
+ * @count:	number of @ops
+ * @return 0 if ok, -1 if a hash update failed
+ */
+int hash_copy(void *dst, const void *src, size_t len,
+	      struct hash_copy_op *ops, int count);
+
 /**
  * hash_lookup_algo() - Look up the hash_algo struct for an algorithm
  *
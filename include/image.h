@@ -242,6 +242,7 @@ struct lmb;
 #define IH_COMP_BZIP2		2	/* bzip2 Compression Used	*/
 #define IH_COMP_LZMA		3	/* lzma  Compression Used	*/
 #define IH_COMP_LZO		4	/* lzo   Compression Used	*/
+#define IH_COMP_LZ4		5	/* lz4   Compression Used	*/
 
 #define IH_MAGIC	0x27051956	/* Image Magic Number		*/
 #define IH_NMLEN		32	/* Image Name Length		*/
@@ -295,6 +296,7 @@ typedef struct bootm_headers {
 	void		*fit_hdr_os;	/* os FIT image header */
 	const char	*fit_uname_os;	/* os subimage node unit name */
 	int		fit_noffset_os;	/* os subimage node offset */
+	int		fit_os_copy_verify; /* bootm_load_os() checks the hashes */
 
 	void		*fit_hdr_rd;	/* init ramdisk FIT image header */
 	const char	*fit_uname_rd;	/* init ramdisk subimage node unit name */
@@ -813,6 +815,7 @@ int fit_add_verification_data(const char *keydir, void *keydest, void *fit,
 			      const char *comment, int require_keys);
 
 int fit_image_verify(const void *fit, int noffset);
+int fit_image_copy_verify(const void *fit, int image_noffset, void *dst);
 int fit_config_verify(const void *fit, int conf_noffset);
 int fit_all_image_verify(const void *fit);
 int fit_image_check_os(const void *fit, int noffset, uint8_t os);
@@ -878,6 +881,13 @@ void image_set_host_blob(void *host_blob);
 #define IMAGE_ENABLE_BEST_MATCH	0
 #endif
 
+/* fit_image_load() verifies an image while it copies it */
+#ifdef USE_HOSTCC
+# define IMAGE_ENABLE_COPY_VERIFY	0
+#else
+# define IMAGE_ENABLE_COPY_VERIFY	1
+#endif
+
 /* Information passed to the signing routines */
 struct image_sign_info {
 	const char *keydir;		/* Directory conaining keys */
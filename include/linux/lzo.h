@@ -31,6 +31,12 @@ int lzo1x_decompress_safe(const unsigned char *src, size_t src_len,
 int lzop_decompress(const unsigned char *src, size_t src_len,
 		    unsigned char *dst, size_t *dst_len);
 
+/* decompress lzop format fed in pieces */
+void *lzop_stream_init(void *dst, unsigned long dstlen);
+int lzop_stream_feed(void *stream, const void *src, unsigned long len,
+		     unsigned long *outlen);
+int lzop_stream_finish(void *stream);
+
 /*
  * Return values (< 0 = Error)
  */
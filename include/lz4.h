@@ -0,0 +1,27 @@
+/*
+ * LZ4 decompression
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+#ifndef __LZ4_H__
+#define __LZ4_H__
+
+/**
+ * lz4_decompress() - Decompress LZ4 data
+ *
+ * Takes one or more LZ4 frames as written by the lz4 tool, or data in the
+ * legacy format (lz4 -l) used for compressed Linux kernels. Block and
+ * content checksums are not verified.
+ *
+ * @src:	compressed data
+ * @src_len:	bytes at @src
+ * @dst:	where the data goes
+ * @dst_len:	room at @dst on entry, bytes written on return
+ * @return 0 if OK, -EINVAL if the data is corrupt, -ENOSPC if @dst is too
+ * small, -EPROTONOSUPPORT if the data uses an unsupported feature
+ */
+int lz4_decompress(const void *src, size_t src_len, void *dst,
+		   size_t *dst_len);
+
+#endif /* __LZ4_H__ */
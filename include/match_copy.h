@@ -0,0 +1,64 @@
+/*
+ * Copy of an LZ77 match, shared by inflate and LZ4
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+#ifndef __MATCH_COPY_H__
+#define __MATCH_COPY_H__
+
+/* Shorter matches are copied byte by byte */
+#define MATCH_COPY_MIN_LEN	16
+
+#if defined(CONFIG_ARMV7_NEON) && !defined(USE_HOSTCC)
+/* arch/arm/lib/match_copy_neon.S, @len is a multiple of 16 */
+void match_copy_neon(unsigned char *dst, const unsigned char *src,
+		     size_t len);
+#endif
+
+/**
+ * match_copy() - Copy a match from earlier in the output
+ *
+ * Source and destination overlap when @dist is less than @len, the
+ * copied bytes then repeat every @dist bytes.
+ *
+ * @out:	where the match goes
+ * @dist:	how far back the match starts
+ * @len:	bytes to copy
+ * @return @out + @len
+ */
+static inline unsigned char *match_copy(unsigned char *out, size_t dist,
+					size_t len)
+{
+	const unsigned char *from = out - dist;
+	size_t n;
+
+	if (len < MATCH_COPY_MIN_LEN) {
+		while (len--)
+			*out++ = *from++;
+		return out;
+	}
+
+#if defined(CONFIG_ARMV7_NEON) && !defined(USE_HOSTCC)
+	/* 16 bytes per load and store, a load never sees its own store */
+	if (dist >= 16 && len >= 32) {
+		n = len & ~15;
+		match_copy_neon(out, from, n);
+		out += n;
+		from += n;
+		len -= n;
+	}
+#endif
+
+	/* [from, out) repeats every @dist bytes, each copy of it doubles it */
+	for (n = out - from; len > n; n = out - from) {
+		memcpy(out, from, n);
+		out += n;
+		len -= n;
+	}
+	memcpy(out, from, len);
+
+	return out + len;
+}
+
+#endif /* __MATCH_COPY_H__ */
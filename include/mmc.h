@@ -39,6 +39,7 @@
 #define MMC_MODE_SPI		(1 << 4)
 #define MMC_MODE_HC		(1 << 5)
 #define MMC_MODE_DDR_52MHz	(1 << 6)
+#define MMC_MODE_SG		(1 << 7)	/* host takes MMC_DATA_SG */
 
 #define SD_DATA_4BIT	0x00040000
 
@@ -46,6 +47,12 @@
 
 #define MMC_DATA_READ		1
 #define MMC_DATA_WRITE		2
+#define MMC_DATA_SG		4	/* data is in sg[], see mmc_bread_sg() */
+#define MMC_DATA_ASYNC		8	/* send_cmd returns once the command is
+					 * accepted, finish with data_poll */
+
+/* Maximum number of segments in one MMC_DATA_SG transfer */
+#define MMC_SG_MAX		16
 
 #define NO_CARD_ERR		-16 /* No SD/MMC card inserted */
 #define UNUSABLE_ERR		-17 /* Unusable Card */
@@ -104,6 +111,8 @@
 #define OCR_ACCESS_MODE		0x60000000
 
 #define SECURE_ERASE		0x80000000
+#define MMC_ERASE_ARG		0x00000000
+#define MMC_TRIM_ARG		0x00000001
 
 #define MMC_STATUS_MASK		(~0x0206BF7F)
 #define MMC_STATUS_SWITCH_ERROR	(1 << 7)
@@ -154,6 +163,7 @@
 #define EXT_CSD_ERASE_GROUP_DEF		175	/* R/W */
 #define EXT_CSD_BOOT_BUS_WIDTH		177
 #define EXT_CSD_PART_CONF		179	/* R/W */
+#define EXT_CSD_ERASED_MEM_CONT		181	/* RO */
 #define EXT_CSD_BUS_WIDTH		183	/* R/W */
 #define EXT_CSD_HS_TIMING		185	/* R/W */
 #define EXT_CSD_REV			192	/* RO */
@@ -162,6 +172,7 @@
 #define EXT_CSD_HC_WP_GRP_SIZE		221	/* RO */
 #define EXT_CSD_HC_ERASE_GRP_SIZE	224	/* RO */
 #define EXT_CSD_BOOT_MULT		226	/* RO */
+#define EXT_CSD_SEC_FEATURE_SUPPORT	231	/* RO */
 
 /*
  * EXT_CSD field definitions
@@ -184,6 +195,8 @@
 #define EXT_CSD_DDR_BUS_WIDTH_4	5	/* Card is in 4 bit DDR mode */
 #define EXT_CSD_DDR_BUS_WIDTH_8	6	/* Card is in 8 bit DDR mode */
 
+#define EXT_CSD_SEC_GB_CL_EN		(1 << 4)	/* TRIM supported */
+
 #define EXT_CSD_BOOT_ACK_ENABLE			(1 << 6)
 #define EXT_CSD_BOOT_PARTITION_ENABLE		(1 << 3)
 #define EXT_CSD_PARTITION_ACCESS_ENABLE		(1 << 0)
@@ -247,14 +260,22 @@ struct mmc_cmd {
 	uint response[4];
 };
 
+/* One buffer of a scattered transfer */
+struct mmc_sg {
+	void *addr;
+	uint len;
+};
+
 struct mmc_data {
 	union {
 		char *dest;
 		const char *src; /* src buffers don't get written to */
+		struct mmc_sg *sg; /* with MMC_DATA_SG */
 	};
 	uint flags;
 	uint blocks;
 	uint blocksize;
+	uint sg_len;	/* only valid with MMC_DATA_SG */
 };
 
 /* forward decl. */
@@ -267,6 +288,11 @@ struct mmc_ops {
 	int (*init)(struct mmc *mmc);
 	int (*getcd)(struct mmc *mmc);
 	int (*getwp)(struct mmc *mmc);
+	/*
+	 * Completion check for data sent with MMC_DATA_ASYNC, optional.
+	 * Returns -EBUSY while the transfer runs, then the send_cmd status.
+	 */
+	int (*data_poll)(struct mmc *mmc, struct mmc_data *data);
 };
 
 struct mmc_config {
@@ -304,6 +330,8 @@ struct mmc {
 	uint read_bl_len;
 	uint write_bl_len;
 	uint erase_grp_size;
+	char can_trim;		/* 1 if the card supports TRIM */
+	u8 erased_byte;		/* contents of erased blocks */
 	u64 capacity;
 	u64 capacity_user;
 	u64 capacity_boot;
@@ -314,6 +342,7 @@ struct mmc {
 	char init_in_progress;	/* 1 if we have done mmc_start_init() */
 	char preinit;		/* start init as early as possible */
 	uint op_cond_response;	/* the response byte from the last op_cond */
+	struct mmc_data async_data;	/* read started by block_read_async */
 };
 
 int mmc_register(struct mmc *mmc);
@@ -322,6 +351,21 @@ void mmc_destroy(struct mmc *mmc);
 int mmc_initialize(bd_t *bis);
 int mmc_init(struct mmc *mmc);
 int mmc_read(struct mmc *mmc, u64 src, uchar *dst, int size);
+/**
+ * mmc_bread_sg() - Read consecutive blocks into a list of buffers
+ *
+ * Every buffer must hold a whole number of blocks. Hosts with MMC_MODE_SG
+ * read up to b_max blocks per command regardless of the buffer layout,
+ * other hosts take one or more commands per buffer.
+ *
+ * @dev_num	Device number
+ * @start	First block
+ * @sg		Buffers, filled in order
+ * @sg_len	Number of buffers
+ * @return number of blocks read, 0 on error
+ */
+ulong mmc_bread_sg(int dev_num, lbaint_t start, struct mmc_sg *sg,
+		   uint sg_len);
 void mmc_set_clock(struct mmc *mmc, uint clock);
 struct mmc *find_mmc_device(int dev_num);
 int mmc_set_dev(int dev_num);
@@ -95,6 +95,14 @@ struct eth_device {
 	struct eth_device *next;
 	int index;
 	void *priv;
+	/*
+	 * Optional zero-copy receive: recv_pkt() hands out the next frame
+	 * in the driver's own receive buffer and returns its length, 0 for a
+	 * frame to drop or -EAGAIN if there is none. free_pkt() gives each
+	 * frame back to the driver once the stack is done with it.
+	 */
+	int  (*recv_pkt) (struct eth_device *, uchar **packetp);
+	int  (*free_pkt) (struct eth_device *, uchar *packet, int length);
 };
 
 extern int eth_initialize(bd_t *bis);	/* Initialize network subsystem */
@@ -154,6 +154,23 @@ void *os_realloc(void *ptr, size_t length);
  */
 void os_usleep(unsigned long usec);
 
+/**
+ * Start a host thread
+ *
+ * The thread shares the whole of U-Boot's memory and ends when \p fn
+ * returns. It must not call into drivers or the console.
+ *
+ * \param fn	Function to run in the new thread
+ * \param arg	Argument passed to \p fn
+ * \return 0 if OK, -1 on error
+ */
+int os_thread_start(void (*fn)(int arg), int arg);
+
+/**
+ * Give up the host CPU to other threads
+ */
+void os_thread_yield(void);
+
 /**
  * Gets a monotonic increasing number of nano seconds from the OS
  *
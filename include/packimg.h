@@ -1,25 +1,61 @@
 #ifndef _PACKIMG_H
 #define _PACKIMG_H
 
+#ifdef USE_HOSTCC
+#include <stdint.h>
+#else
 #include <common.h>
+#endif
 
-#define PACK_MAGIC 0x4b434150
+#define PACK_MAGIC 0x4b434150	/* "PACK", version 1 */
+#define PACK_MAGIC_V2 0x324b4150	/* "PAK2" */
 #define PACK_NAME_MAX 32
 
+/*
+ * Version 2 images carry a real digest per entry and protect the header
+ * with a CRC32 instead of the additive sum of version 1.
+ *
+ * Version 1: pack_header without version/digest, 48 byte entries without
+ * digest, header crc and entry crc are 32-bit additive sums.
+ *
+ * Version 2: magic PACK_MAGIC_V2, header crc is the CRC32 of the header
+ * (with crc zero) and all entries, every entry carries a digest of the
+ * type in the header.
+ * CRC32 digests are stored big endian in the first 4 bytes.
+ *
+ * Version 1 headers are converted to the version 2 layout when they are
+ * loaded, so users only ever see the version 2 structures.
+ */
+#define PACK_VERSION		2
+
+#define PACK_DIGEST_SUM		0	/* version 1 additive sum, in crc */
+#define PACK_DIGEST_CRC32	1
+#define PACK_DIGEST_SHA256	2
+#define PACK_DIGEST_MAX		32
+
 struct pack_header {
 	uint32_t magic;
 	uint32_t nentry;
 	uint32_t crc;
+	uint16_t version;
+	uint16_t digest;
 };
 
 struct pack_entry {
 	uint32_t offset;
 	uint32_t size;
 	uint32_t ldaddr;
-	uint32_t crc;
+	uint32_t crc;		/* version 1 only */
 	char name[PACK_NAME_MAX];
+	uint8_t digest[PACK_DIGEST_MAX];
 };
 
+/* On-disk size of the version 1 structures */
+#define PACK_V1_HEADER_SIZE	12
+#define PACK_V1_ENTRY_SIZE	48
+
+#ifndef USE_HOSTCC
+
 #if defined(CONFIG_SPL_SPI_SUPPORT)
 #include <spi_flash.h>
 int sf_load_packimg(struct spi_flash *flash, uint32_t offs, char *name);
@@ -42,4 +78,6 @@ int nand_packimg_write(nand_info_t *nand, uint32_t nand_off, uint32_t nand_size,
 				  uint32_t mem_size, uint32_t max_copy);
 #endif
 
+#endif /* !USE_HOSTCC */
+
 #endif
@@ -38,9 +38,105 @@ typedef struct block_dev_desc {
 	unsigned long   (*block_erase)(int dev,
 				       lbaint_t start,
 				       lbaint_t blkcnt);
+	/* make blocks read back as zeroes without writing them, optional */
+	unsigned long   (*block_zero)(int dev,
+				      lbaint_t start,
+				      lbaint_t blkcnt);
+	/*
+	 * start a read and return before it completes, optional. Returns 0
+	 * if the read was started, non-zero to make the caller fall back to
+	 * block_read. Only one async read per device may be in flight.
+	 */
+	int		(*block_read_async)(int dev,
+					    lbaint_t start,
+					    lbaint_t blkcnt,
+					    void *buffer);
+	/* -EBUSY while the async read runs, then 0 and the blocks read */
+	int		(*block_read_poll)(int dev,
+					   unsigned long *blkread);
+	unsigned long	async_blkread;	/* result for blk_read_wait() */
+	unsigned char	async_busy;	/* async read in flight */
 	void		*priv;		/* driver private struct pointer */
 }block_dev_desc_t;
 
+/**
+ * blk_read_submit() - Start reading blocks in the background
+ *
+ * Uses block_read_async when the driver has it and falls back to a
+ * synchronous block_read otherwise. The buffer must not be touched until
+ * blk_read_done() returned 1 or blk_read_wait() returned.
+ */
+static inline void blk_read_submit(block_dev_desc_t *dev_desc, lbaint_t start,
+				   lbaint_t blkcnt, void *buffer)
+{
+	dev_desc->async_busy = dev_desc->block_read_async &&
+		!dev_desc->block_read_async(dev_desc->dev, start, blkcnt,
+					    buffer);
+	if (!dev_desc->async_busy)
+		dev_desc->async_blkread = dev_desc->block_read(dev_desc->dev,
+							       start, blkcnt,
+							       buffer);
+}
+
+/* blk_read_done() - 1 once the read started by blk_read_submit() is done */
+static inline int blk_read_done(block_dev_desc_t *dev_desc)
+{
+	if (dev_desc->async_busy &&
+	    !dev_desc->block_read_poll(dev_desc->dev, &dev_desc->async_blkread))
+		dev_desc->async_busy = 0;
+
+	return !dev_desc->async_busy;
+}
+
+/* blk_read_wait() - Wait for blk_read_submit(), returns the blocks read */
+static inline unsigned long blk_read_wait(block_dev_desc_t *dev_desc)
+{
+	while (!blk_read_done(dev_desc))
+		;
+
+	return dev_desc->async_blkread;
+}
+
+#ifdef CONFIG_BLOCK_CACHE
+struct blkcache_stats {
+	unsigned hits;
+	unsigned misses;
+	unsigned entries;		/* in use */
+	unsigned max_blocks_per_entry;	/* larger reads are not cached */
+	unsigned max_entries;
+};
+
+/* drivers/block/blkcache.c */
+unsigned long blk_dread(block_dev_desc_t *dev_desc, lbaint_t start,
+			lbaint_t blkcnt, void *buffer);
+unsigned long blk_dwrite(block_dev_desc_t *dev_desc, lbaint_t start,
+			 lbaint_t blkcnt, const void *buffer);
+/*
+ * blkcache_invalidate() - Drop cached blocks after a write or rescan. Each
+ * block driver calls it from its block_write function.
+ */
+void blkcache_invalidate(int iftype, int devnum);
+void blkcache_configure(unsigned blocks, unsigned entries);
+/* blkcache_stats() - Get the counters, hits and misses restart at 0 */
+void blkcache_stats(struct blkcache_stats *blkstats);
+#else
+static inline unsigned long blk_dread(block_dev_desc_t *dev_desc,
+				      lbaint_t start, lbaint_t blkcnt,
+				      void *buffer)
+{
+	return dev_desc->block_read(dev_desc->dev, start, blkcnt, buffer);
+}
+
+static inline unsigned long blk_dwrite(block_dev_desc_t *dev_desc,
+				       lbaint_t start, lbaint_t blkcnt,
+				       const void *buffer)
+{
+	return dev_desc->block_write(dev_desc->dev, start, blkcnt, buffer);
+}
+
+static inline void blkcache_invalidate(int iftype, int devnum) {}
+#endif
+
 #define BLOCK_CNT(size, block_dev_desc) (PAD_COUNT(size, block_dev_desc->blksz))
 #define PAD_TO_BLOCKSIZE(size, block_dev_desc) \
 	(PAD_SIZE(size, block_dev_desc->blksz))
@@ -11,6 +11,11 @@ struct host_block_dev {
 	block_dev_desc_t blk_dev;
 	char *filename;
 	int fd;
+	/* read started by block_read_async */
+	lbaint_t async_start;
+	lbaint_t async_blkcnt;
+	void *async_buffer;
+	int async_polls;
 };
 
 int host_dev_bind(int dev, char *filename);
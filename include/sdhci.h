@@ -223,6 +223,45 @@ struct sdhci_host;
  */
 #define SDHCI_DEFAULT_BOUNDARY_SIZE	(512 * 1024)
 #define SDHCI_DEFAULT_BOUNDARY_ARG	(7)
+
+/*
+ * ADMA2 descriptor table, 32-bit addressing. Each descriptor moves up to
+ * SDHCI_ADMA_MAX_LEN bytes, so the table is sized for b_max blocks of 512
+ * bytes plus one extra descriptor per scatter buffer.
+ */
+#define SDHCI_ADMA_VALID	(1 << 0)
+#define SDHCI_ADMA_END		(1 << 1)
+#define SDHCI_ADMA_INT		(1 << 2)
+#define SDHCI_ADMA_TRAN		(2 << 4)
+#define SDHCI_ADMA_MAX_LEN	65532
+#define SDHCI_ADMA_DESC_COUNT	\
+	(CONFIG_SYS_MMC_MAX_BLK_COUNT / (SDHCI_ADMA_MAX_LEN / 512) + \
+	 MMC_SG_MAX + 1)
+
+struct sdhci_adma_desc {
+	u16 attr;
+	u16 len;
+	u32 addr;
+} __packed;
+
+/**
+ * sdhci_adma_prepare() - Describe a data transfer in an ADMA2 table
+ *
+ * Also does the cache maintenance needed before the transfer starts.
+ *
+ * @table	Table of SDHCI_ADMA_DESC_COUNT descriptors
+ * @data	Transfer, single buffer or MMC_DATA_SG
+ * @return 0 if OK, -1 if a buffer is not 32-bit aligned or the table is
+ * too small
+ */
+int sdhci_adma_prepare(struct sdhci_adma_desc *table, struct mmc_data *data);
+
+/**
+ * sdhci_adma_complete() - Cache maintenance after an ADMA2 read
+ *
+ * @data	Transfer passed to sdhci_adma_prepare()
+ */
+void sdhci_adma_complete(struct mmc_data *data);
 struct sdhci_ops {
 #ifdef CONFIG_MMC_SDHCI_IO_ACCESSORS
 	u32             (*read_l)(struct sdhci_host *host, int reg);
@@ -252,6 +291,9 @@ struct sdhci_host {
 	void (*set_control_reg)(struct sdhci_host *host);
 	void (*set_clock)(int dev_index, unsigned int div);
 	uint	voltages;
+#ifdef CONFIG_MMC_SDHCI_ADMA
+	ulong	data_start;	/* get_timer() when an async read started */
+#endif
 
 	struct mmc_config cfg;
 };
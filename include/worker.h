@@ -0,0 +1,85 @@
+/*
+ * Worker cores
+ *
+ * U-Boot runs on a single core. On SoCs with more cores the secondaries
+ * can be parked in a small job loop and handed CPU-bound work such as
+ * decryption or checksumming of loaded images. Core 0 keeps ownership of
+ * all devices; jobs must only touch memory.
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+#ifndef __WORKER_H__
+#define __WORKER_H__
+
+struct worker_job {
+	void (*fn)(void *arg);
+	void *arg;
+	volatile int done;
+};
+
+#ifdef CONFIG_WORKER
+
+/**
+ * worker_init() - Start the worker cores
+ *
+ * Starting is done once, later calls just return the number of workers.
+ *
+ * @return number of worker cores running, 0 if jobs will run inline
+ */
+int worker_init(void);
+
+/**
+ * worker_submit() - Run a job on an idle worker
+ *
+ * Waits for a worker to become idle. Without workers the job is run
+ * on the calling core before returning.
+ *
+ * @job		Job to run, must stay valid until worker_wait() returns
+ */
+void worker_submit(struct worker_job *job);
+
+/**
+ * worker_wait() - Wait for a submitted job to complete
+ *
+ * @job		Job passed to worker_submit()
+ */
+void worker_wait(struct worker_job *job);
+
+/**
+ * worker_stop() - Park the worker cores for good
+ *
+ * Must be called before control is passed to an operating system.
+ */
+void worker_stop(void);
+
+/* Architecture hooks */
+int arch_worker_start(int cpu, void (*entry)(int cpu));
+void arch_worker_stop(int cpu);
+void arch_worker_idle(void);
+void arch_worker_kick(void);
+
+#else
+
+static inline int worker_init(void)
+{
+	return 0;
+}
+
+static inline void worker_submit(struct worker_job *job)
+{
+	job->fn(job->arg);
+	job->done = 1;
+}
+
+static inline void worker_wait(struct worker_job *job)
+{
+}
+
+static inline void worker_stop(void)
+{
+}
+
+#endif /* CONFIG_WORKER */
+
+#endif /* __WORKER_H__ */
@@ -26,6 +26,12 @@
 
 #define tole(x) cpu_to_le32(x)
 
+#if defined(CONFIG_CRC32_SLICE8) && !defined(DYNAMIC_CRC_TABLE) && \
+    __BYTE_ORDER == __LITTLE_ENDIAN
+#define CRC32_SLICE8
+#include "crc32_slice8.h"
+#endif
+
 #ifdef DYNAMIC_CRC_TABLE
 
 local int crc_table_empty = 1;
@@ -176,6 +182,42 @@ const uint32_t * ZEXPORT get_crc_table()
 /* No ones complement version. JFFS2 (and other things ?)
  * don't use ones compliment in their CRC calculations.
  */
+#ifdef CRC32_SLICE8
+/*
+ * Slicing-by-8: fold in eight bytes per step through eight tables, one
+ * for each byte position, instead of one table lookup per byte.
+ */
+uint32_t ZEXPORT crc32_no_comp(uint32_t crc, const Bytef *buf, uInt len)
+{
+    const uint32_t *b;
+    uint32_t one, two;
+
+    while (len && ((long)buf & 3)) {
+	 crc = crc_table[(crc ^ *buf++) & 255] ^ (crc >> 8);
+	 len--;
+    }
+
+    b = (const uint32_t *)buf;
+    for (; len >= 8; len -= 8) {
+	 one = *b++ ^ crc;
+	 two = *b++;
+	 crc = crc_table_slice[6][one & 255] ^
+	       crc_table_slice[5][(one >> 8) & 255] ^
+	       crc_table_slice[4][(one >> 16) & 255] ^
+	       crc_table_slice[3][one >> 24] ^
+	       crc_table_slice[2][two & 255] ^
+	       crc_table_slice[1][(two >> 8) & 255] ^
+	       crc_table_slice[0][(two >> 16) & 255] ^
+	       crc_table[two >> 24];
+    }
+
+    buf = (const Bytef *)b;
+    while (len--)
+	 crc = crc_table[(crc ^ *buf++) & 255] ^ (crc >> 8);
+
+    return crc;
+}
+#else
 uint32_t ZEXPORT crc32_no_comp(uint32_t crc, const Bytef *buf, uInt len)
 {
     const uint32_t *tab = crc_table;
@@ -216,6 +258,8 @@ uint32_t ZEXPORT crc32_no_comp(uint32_t crc, const Bytef *buf, uInt len)
 
     return le32_to_cpu(crc);
 }
+#endif /* CRC32_SLICE8 */
+
 #undef DO_CRC
 
 uint32_t ZEXPORT crc32 (uint32_t crc, const Bytef *p, uInt len)
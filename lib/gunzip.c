@@ -102,3 +102,171 @@ int zunzip(void *dst, int dstlen, unsigned char *src, unsigned long *lenp,
 
 	return 0;
 }
+
+#ifdef CONFIG_DECOMP_STREAM
+/*
+ * Streaming gunzip: the compressed data may arrive in pieces of any size,
+ * each piece is inflated straight to the destination as it is fed. Like
+ * gunzip() the CRC32 and length in the gzip trailer are not checked.
+ */
+enum {
+	GZ_FIXED,		/* magic, method, flags, mtime, xfl, os */
+	GZ_EXTRA_LEN,
+	GZ_EXTRA,
+	GZ_NAME,
+	GZ_COMMENT,
+	GZ_HCRC,
+	GZ_DATA,
+};
+
+struct gzip_stream {
+	z_stream s;
+	int stage;		/* GZ_... header field being parsed */
+	int pos;		/* bytes of the field seen */
+	unsigned char hdr[10];
+	int flags;
+	unsigned long skip;	/* extra field bytes left */
+	int done;
+};
+
+/* Move on to the next header field present in the flags */
+static void gzip_stream_next(struct gzip_stream *gz)
+{
+	gz->pos = 0;
+	if (gz->stage < GZ_EXTRA_LEN && (gz->flags & EXTRA_FIELD))
+		gz->stage = GZ_EXTRA_LEN;
+	else if (gz->stage < GZ_NAME && (gz->flags & ORIG_NAME))
+		gz->stage = GZ_NAME;
+	else if (gz->stage < GZ_COMMENT && (gz->flags & COMMENT))
+		gz->stage = GZ_COMMENT;
+	else if (gz->stage < GZ_HCRC && (gz->flags & HEAD_CRC))
+		gz->stage = GZ_HCRC;
+	else
+		gz->stage = GZ_DATA;
+}
+
+static int gzip_stream_header(struct gzip_stream *gz,
+			      const unsigned char **src, unsigned long *len)
+{
+	unsigned char c;
+
+	while (*len && gz->stage != GZ_DATA) {
+		c = *(*src)++;
+		(*len)--;
+
+		switch (gz->stage) {
+		case GZ_FIXED:
+			gz->hdr[gz->pos++] = c;
+			if (gz->pos < sizeof(gz->hdr))
+				break;
+			gz->flags = gz->hdr[3];
+			if (gz->hdr[2] != DEFLATED ||
+			    (gz->flags & RESERVED) != 0) {
+				puts("Error: Bad gzipped data\n");
+				return -1;
+			}
+			gzip_stream_next(gz);
+			break;
+		case GZ_EXTRA_LEN:
+			gz->skip |= (unsigned long)c << (8 * gz->pos++);
+			if (gz->pos < 2)
+				break;
+			if (gz->skip)
+				gz->stage = GZ_EXTRA;
+			else
+				gzip_stream_next(gz);
+			break;
+		case GZ_EXTRA:
+			if (--gz->skip == 0)
+				gzip_stream_next(gz);
+			break;
+		case GZ_NAME:
+		case GZ_COMMENT:
+			if (c == 0)
+				gzip_stream_next(gz);
+			break;
+		case GZ_HCRC:
+			if (++gz->pos == 2)
+				gzip_stream_next(gz);
+			break;
+		}
+	}
+
+	return 0;
+}
+
+void *gzip_stream_init(void *dst, unsigned long dstlen)
+{
+	struct gzip_stream *gz;
+	int r;
+
+	gz = calloc(1, sizeof(*gz));
+	if (!gz)
+		return NULL;
+
+	gz->s.zalloc = gzalloc;
+	gz->s.zfree = gzfree;
+	r = inflateInit2(&gz->s, -MAX_WBITS);
+	if (r != Z_OK) {
+		printf("Error: inflateInit2() returned %d\n", r);
+		free(gz);
+		return NULL;
+	}
+	gz->s.next_out = dst;
+	gz->s.avail_out = dstlen;
+
+	return gz;
+}
+
+/*
+ * Inflate the next @len bytes of the gzip stream. @outlen returns the
+ * number of bytes written to the destination so far.
+ * Returns 0 if more data is needed, 1 once the end of the compressed data
+ * was seen and -1 on error. Data after the end is ignored.
+ */
+int gzip_stream_feed(void *stream, const void *src, unsigned long len,
+		     unsigned long *outlen)
+{
+	struct gzip_stream *gz = stream;
+	const unsigned char *p = src;
+	int r;
+
+	if (gz->stage != GZ_DATA && gzip_stream_header(gz, &p, &len))
+		return -1;
+
+	if (!gz->done && len) {
+		gz->s.next_in = (unsigned char *)p;
+		gz->s.avail_in = len;
+		r = inflate(&gz->s, Z_NO_FLUSH);
+		if (r == Z_STREAM_END) {
+			gz->done = 1;
+		} else if (r != Z_OK) {
+			printf("Error: inflate() returned %d\n", r);
+			return -1;
+		} else if (gz->s.avail_in) {
+			puts("Error: gunzip out of room\n");
+			return -1;
+		}
+	}
+
+	*outlen = gz->s.total_out;
+
+	return gz->done;
+}
+
+/* Free the stream, returns -1 if the compressed data was incomplete */
+int gzip_stream_finish(void *stream)
+{
+	struct gzip_stream *gz = stream;
+	int done = gz->done;
+
+	inflateEnd(&gz->s);
+	free(gz);
+	if (!done) {
+		puts("Error: gunzip out of data\n");
+		return -1;
+	}
+
+	return 0;
+}
+#endif /* CONFIG_DECOMP_STREAM */
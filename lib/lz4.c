@@ -0,0 +1,232 @@
+/*
+ * LZ4 decompression, see include/lz4.h
+ *
+ * An LZ4 block is a series of sequences, each a run of literals followed
+ * by a match of at least four bytes from up to 64 KiB back. The frame
+ * format wraps blocks with a descriptor and optional checksums, the
+ * legacy format just puts the size in front of each block. Anything
+ * after the data that does not start with a magic is ignored, images are
+ * often padded.
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+#include <common.h>
+#include <errno.h>
+#include <lz4.h>
+#include <match_copy.h>
+#include <asm/unaligned.h>
+
+#define LZ4_FRAME_MAGIC		0x184d2204
+#define LZ4_LEGACY_MAGIC	0x184c2102
+#define LZ4_SKIP_MAGIC		0x184d2a50	/* low four bits are free */
+#define LZ4_SKIP_MAGIC_MASK	0xfffffff0
+
+#define LZ4_MIN_MATCH		4
+
+/* Frame descriptor flags */
+#define LZ4_FLG_VERSION_MASK	0xc0
+#define LZ4_FLG_VERSION		0x40
+#define LZ4_FLG_BLOCK_INDEP	0x20
+#define LZ4_FLG_BLOCK_CSUM	0x10
+#define LZ4_FLG_CONTENT_SIZE	0x08
+#define LZ4_FLG_CONTENT_CSUM	0x04
+#define LZ4_FLG_DICT_ID		0x01
+
+/* High bit of a block size: the block is stored uncompressed */
+#define LZ4_BLOCK_RAW		0x80000000
+
+/* Add up a length continued in bytes of 255 */
+static int lz4_length(const u8 **ipp, const u8 *ip_end, size_t *len)
+{
+	const u8 *ip = *ipp;
+	u8 b;
+
+	do {
+		if (ip >= ip_end)
+			return -EINVAL;
+		b = *ip++;
+		*len += b;
+	} while (b == 255);
+	*ipp = ip;
+
+	return 0;
+}
+
+/*
+ * Decompress one block to *@opp. Matches may reach back as far as @base,
+ * the start of the block or, for linked blocks, of the output.
+ */
+static int lz4_block(const u8 *ip, size_t in_len, u8 *base, u8 **opp,
+		     u8 *op_end)
+{
+	const u8 *ip_end = ip + in_len;
+	u8 *op = *opp;
+	size_t len, dist;
+	u8 token;
+
+	while (ip < ip_end) {
+		token = *ip++;
+
+		len = token >> 4;
+		if (len == 15 && lz4_length(&ip, ip_end, &len))
+			return -EINVAL;
+		if (len > ip_end - ip)
+			return -EINVAL;
+		if (len > op_end - op)
+			return -ENOSPC;
+		memcpy(op, ip, len);
+		op += len;
+		ip += len;
+
+		/* the last sequence has no match */
+		if (ip == ip_end)
+			break;
+
+		if (ip_end - ip < 2)
+			return -EINVAL;
+		dist = get_unaligned_le16(ip);
+		ip += 2;
+		if (!dist || dist > op - base)
+			return -EINVAL;
+
+		len = token & 15;
+		if (len == 15 && lz4_length(&ip, ip_end, &len))
+			return -EINVAL;
+		len += LZ4_MIN_MATCH;
+		if (len > op_end - op)
+			return -ENOSPC;
+		op = match_copy(op, dist, len);
+	}
+	*opp = op;
+
+	return 0;
+}
+
+/* One frame after the magic, returns the bytes used from @ip */
+static int lz4_frame(const u8 *ip, const u8 *ip_end, u8 *dst, u8 **opp,
+		     u8 *op_end)
+{
+	const u8 *start = ip;
+	u8 *base;
+	size_t hdr_len = 3;
+	u32 size;
+	u8 flg;
+	int ret;
+
+	if (ip_end - ip < hdr_len)
+		return -EINVAL;
+	flg = ip[0];
+	if ((flg & LZ4_FLG_VERSION_MASK) != LZ4_FLG_VERSION)
+		return -EPROTONOSUPPORT;
+	/* a dictionary would have to come from somewhere else */
+	if (flg & LZ4_FLG_DICT_ID)
+		return -EPROTONOSUPPORT;
+	if (flg & LZ4_FLG_CONTENT_SIZE)
+		hdr_len += 8;
+	if (ip_end - ip < hdr_len)
+		return -EINVAL;
+	/* the header checksum is not checked */
+	ip += hdr_len;
+
+	for (;;) {
+		if (ip_end - ip < 4)
+			return -EINVAL;
+		size = get_unaligned_le32(ip);
+		ip += 4;
+		if (!size)
+			break;
+
+		if ((size & ~LZ4_BLOCK_RAW) > ip_end - ip)
+			return -EINVAL;
+		if (size & LZ4_BLOCK_RAW) {
+			size &= ~LZ4_BLOCK_RAW;
+			if (size > op_end - *opp)
+				return -ENOSPC;
+			memcpy(*opp, ip, size);
+			*opp += size;
+		} else {
+			base = flg & LZ4_FLG_BLOCK_INDEP ? *opp : dst;
+			ret = lz4_block(ip, size, base, opp, op_end);
+			if (ret)
+				return ret;
+		}
+		ip += size;
+
+		if (flg & LZ4_FLG_BLOCK_CSUM)
+			ip += 4;
+	}
+
+	if (flg & LZ4_FLG_CONTENT_CSUM)
+		ip += 4;
+	if (ip > ip_end)
+		return -EINVAL;
+
+	return ip - start;
+}
+
+/* Legacy blocks after the magic, up to the end or the next magic */
+static int lz4_legacy(const u8 *ip, const u8 *ip_end, u8 **opp, u8 *op_end)
+{
+	const u8 *start = ip;
+	u32 size;
+	int ret;
+
+	while (ip_end - ip >= 4) {
+		size = get_unaligned_le32(ip);
+		if (size == LZ4_LEGACY_MAGIC || size == LZ4_FRAME_MAGIC)
+			break;
+		ip += 4;
+
+		/* the kernel build appends the uncompressed size */
+		if (ip == ip_end)
+			break;
+		if (size > ip_end - ip)
+			return -EINVAL;
+		ret = lz4_block(ip, size, *opp, opp, op_end);
+		if (ret)
+			return ret;
+		ip += size;
+	}
+
+	return ip - start;
+}
+
+int lz4_decompress(const void *src, size_t src_len, void *dst,
+		   size_t *dst_len)
+{
+	const u8 *ip = src;
+	const u8 *ip_end = ip + src_len;
+	u8 *op = dst;
+	u8 *op_end = op + *dst_len;
+	u32 magic;
+	int ret;
+
+	while (ip_end - ip >= 4) {
+		magic = get_unaligned_le32(ip);
+		if (magic == LZ4_FRAME_MAGIC) {
+			ret = lz4_frame(ip + 4, ip_end, dst, &op, op_end);
+		} else if (magic == LZ4_LEGACY_MAGIC) {
+			ret = lz4_legacy(ip + 4, ip_end, &op, op_end);
+		} else if ((magic & LZ4_SKIP_MAGIC_MASK) == LZ4_SKIP_MAGIC) {
+			if (ip_end - ip < 8)
+				return -EINVAL;
+			ret = get_unaligned_le32(ip + 4) + 4;
+			if (ret < 4 || ret > ip_end - ip - 4)
+				return -EINVAL;
+		} else {
+			break;
+		}
+		if (ret < 0)
+			return ret;
+		ip += 4 + ret;
+	}
+
+	/* no data at all */
+	if (ip == src)
+		return -EINVAL;
+
+	*dst_len = op - (u8 *)dst;
+
+	return 0;
+}
@@ -121,4 +121,135 @@ int lzmaBuffToBuffDecompress (unsigned char *outStream, SizeT *uncompressedSize,
     return res;
 }
 
+#ifdef CONFIG_DECOMP_STREAM
+/*
+ * Streaming variant of lzmaBuffToBuffDecompress(): the LZMA_Alone data may
+ * arrive in pieces of any size. The destination buffer is used as the
+ * dictionary, so nothing is copied.
+ */
+struct lzma_stream {
+    CLzmaDec dec;
+    ISzAlloc alloc;
+    unsigned char hdr[LZMA_DATA_OFFSET];
+    int hdr_len;
+    SizeT limit;        /* uncompressed size, or the room at dst */
+    int sized;          /* uncompressed size is in the header */
+    int done;
+};
+
+void *lzmaStreamInit(void *dst, unsigned long dstlen)
+{
+    struct lzma_stream *ls;
+
+    ls = calloc(1, sizeof(*ls));
+    if (!ls)
+        return NULL;
+
+    LzmaDec_Construct(&ls->dec);
+    ls->alloc.Alloc = SzAlloc;
+    ls->alloc.Free = SzFree;
+    ls->dec.dic = dst;
+    ls->dec.dicBufSize = dstlen;
+
+    return ls;
+}
+
+static int lzmaStreamHeader(struct lzma_stream *ls)
+{
+    UInt32 low, high;
+    int i, res;
+
+    low = high = 0;
+    for (i = 0; i < 4; i++) {
+        low |= (UInt32)ls->hdr[LZMA_SIZE_OFFSET + i] << (i * 8);
+        high |= (UInt32)ls->hdr[LZMA_SIZE_OFFSET + 4 + i] << (i * 8);
+    }
+
+    ls->limit = ls->dec.dicBufSize;
+    if (low != (UInt32)-1 || high != (UInt32)-1) {
+        if (high != 0 || low > ls->dec.dicBufSize)
+            return SZ_ERROR_OUTPUT_EOF;
+        ls->limit = low;
+        ls->sized = 1;
+    }
+
+    debug("LZMA: Uncompresed size............ 0x%zx%s\n", ls->limit,
+          ls->sized ? "" : " (room)");
+
+    res = LzmaDec_AllocateProbs(&ls->dec, ls->hdr, LZMA_PROPS_SIZE,
+                                &ls->alloc);
+    if (res != SZ_OK)
+        return res;
+    LzmaDec_Init(&ls->dec);
+    ls->done = ls->sized && !ls->limit;
+
+    return SZ_OK;
+}
+
+/*
+ * Decompress the next @len bytes. @outlen returns the number of bytes
+ * written to the destination so far.
+ * Returns 0 if more data is needed, 1 at the end of the stream and a
+ * negative SZ_ERROR_... on error.
+ */
+int lzmaStreamFeed(void *stream, const void *src, unsigned long len,
+                   unsigned long *outlen)
+{
+    struct lzma_stream *ls = stream;
+    const unsigned char *p = src;
+    ELzmaStatus status;
+    SizeT in;
+    int n, res;
+
+    if (ls->hdr_len < LZMA_DATA_OFFSET) {
+        n = min((unsigned long)(LZMA_DATA_OFFSET - ls->hdr_len), len);
+        memcpy(ls->hdr + ls->hdr_len, p, n);
+        ls->hdr_len += n;
+        p += n;
+        len -= n;
+        if (ls->hdr_len == LZMA_DATA_OFFSET) {
+            res = lzmaStreamHeader(ls);
+            if (res != SZ_OK)
+                return -res;
+        }
+    }
+
+    while (len && !ls->done) {
+        WATCHDOG_RESET();
+
+        in = len;
+        res = LzmaDec_DecodeToDic(&ls->dec, ls->limit, p, &in,
+                                  LZMA_FINISH_ANY, &status);
+        if (res != SZ_OK)
+            return -res;
+        if (!in && ls->dec.dicPos < ls->limit)
+            return -SZ_ERROR_DATA;
+        p += in;
+        len -= in;
+
+        if (status == LZMA_STATUS_FINISHED_WITH_MARK ||
+            (ls->sized && ls->dec.dicPos == ls->limit))
+            ls->done = 1;
+        else if (ls->dec.dicPos == ls->limit)
+            return -SZ_ERROR_OUTPUT_EOF;
+    }
+
+    *outlen = ls->dec.dicPos;
+
+    return ls->done;
+}
+
+/* Free the stream, returns SZ_ERROR_INPUT_EOF if the data was incomplete */
+int lzmaStreamFinish(void *stream)
+{
+    struct lzma_stream *ls = stream;
+    int done = ls->done;
+
+    LzmaDec_FreeProbs(&ls->dec, &ls->alloc);
+    free(ls);
+
+    return done ? SZ_OK : SZ_ERROR_INPUT_EOF;
+}
+#endif /* CONFIG_DECOMP_STREAM */
+
 #endif
@@ -16,4 +16,9 @@
 
 extern int lzmaBuffToBuffDecompress (unsigned char *outStream, SizeT *uncompressedSize,
 			      unsigned char *inStream,  SizeT  length);
+
+extern void *lzmaStreamInit(void *dst, unsigned long dstlen);
+extern int lzmaStreamFeed(void *stream, const void *src, unsigned long len,
+			  unsigned long *outlen);
+extern int lzmaStreamFinish(void *stream);
 #endif
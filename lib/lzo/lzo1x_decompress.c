@@ -12,6 +12,7 @@
  */
 
 #include <common.h>
+#include <malloc.h>
 #include <linux/lzo.h>
 #include <asm/byteorder.h>
 #include <asm/unaligned.h>
@@ -62,13 +63,40 @@ static inline const unsigned char *parse_header(const unsigned char *src)
 	return src;
 }
 
+/* Decompress one lzop block of @slen bytes into @dlen bytes at @dst */
+static int lzop_decompress_block(const unsigned char *src, u32 slen,
+				 unsigned char *dst, u32 dlen, size_t remaining)
+{
+	size_t tmp;
+	int r;
+
+	if (slen <= 0 || slen > dlen)
+		return LZO_E_ERROR;
+
+	/* abort if buffer ran out of room */
+	if (dlen > remaining)
+		return LZO_E_OUTPUT_OVERRUN;
+
+	/* decompress */
+	tmp = dlen;
+	r = lzo1x_decompress_safe(src, slen, dst, &tmp);
+
+	if (r != LZO_E_OK)
+		return r;
+
+	if (dlen != tmp)
+		return LZO_E_ERROR;
+
+	return LZO_E_OK;
+}
+
 int lzop_decompress(const unsigned char *src, size_t src_len,
 		    unsigned char *dst, size_t *dst_len)
 {
 	unsigned char *start = dst;
 	const unsigned char *send = src + src_len;
 	u32 slen, dlen;
-	size_t tmp, remaining;
+	size_t remaining;
 	int r;
 
 	src = parse_header(src);
@@ -91,23 +119,10 @@ int lzop_decompress(const unsigned char *src, size_t src_len,
 		slen = get_unaligned_be32(src);
 		src += 8;
 
-		if (slen <= 0 || slen > dlen)
-			return LZO_E_ERROR;
-
-		/* abort if buffer ran out of room */
-		if (dlen > remaining)
-			return LZO_E_OUTPUT_OVERRUN;
-
-		/* decompress */
-		tmp = dlen;
-		r = lzo1x_decompress_safe((u8 *) src, slen, dst, &tmp);
-
+		r = lzop_decompress_block(src, slen, dst, dlen, remaining);
 		if (r != LZO_E_OK)
 			return r;
 
-		if (dlen != tmp)
-			return LZO_E_ERROR;
-
 		src += slen;
 		dst += dlen;
 		remaining -= dlen;
@@ -335,3 +350,212 @@ lookbehind_overrun:
 	*out_len = op - out;
 	return LZO_E_LOOKBEHIND_OVERRUN;
 }
+
+#ifdef CONFIG_DECOMP_STREAM
+/*
+ * Streaming lzop_decompress(): the data may arrive in pieces of any size.
+ * Blocks that arrive in one piece are decompressed in place, only blocks
+ * split across pieces are gathered in a buffer first.
+ */
+enum {
+	LZOP_HEADER,
+	LZOP_BLOCK,		/* block sizes and checksum */
+	LZOP_DATA,
+	LZOP_DONE,
+};
+
+/* Enough for the largest header and for every block header */
+#define LZOP_BUF_MIN		512
+
+struct lzop_stream {
+	unsigned char *dst;
+	size_t dst_len;
+	size_t out;
+	int stage;		/* LZOP_... */
+	unsigned char *buf;	/* gathers the header and split blocks */
+	size_t buf_size;
+	size_t have;		/* bytes in buf */
+	size_t need;		/* bytes needed to finish the stage */
+	u32 dlen, slen;
+};
+
+/*
+ * Size of the lzop header as far as it is known from the first @have bytes,
+ * grows as more of the variable part is seen.
+ */
+static size_t lzop_header_size(const unsigned char *h, size_t have)
+{
+	size_t n = ARRAY_SIZE(lzop_magic) + 7;
+	u16 version;
+
+	if (have < n)
+		return n;
+	version = get_unaligned_be16(h + ARRAY_SIZE(lzop_magic));
+	if (version >= 0x0940)
+		n++;
+
+	if (have < n + 4)
+		return n + 4;
+	if (get_unaligned_be32(h + n) & HEADER_HAS_FILTER)
+		n += 4;
+	n += 12;
+	if (version >= 0x0940)
+		n += 4;
+
+	if (have < n + 1)
+		return n + 1;
+
+	return n + 1 + h[n] + 4;
+}
+
+void *lzop_stream_init(void *dst, unsigned long dstlen)
+{
+	struct lzop_stream *ls;
+
+	ls = calloc(1, sizeof(*ls));
+	if (!ls)
+		return NULL;
+
+	ls->buf = malloc(LZOP_BUF_MIN);
+	if (!ls->buf) {
+		free(ls);
+		return NULL;
+	}
+	ls->buf_size = LZOP_BUF_MIN;
+	ls->dst = dst;
+	ls->dst_len = dstlen;
+	ls->stage = LZOP_HEADER;
+	ls->need = lzop_header_size(NULL, 0);
+
+	return ls;
+}
+
+static int lzop_stream_block(struct lzop_stream *ls, const unsigned char *src)
+{
+	int r;
+
+	r = lzop_decompress_block(src, ls->slen, ls->dst + ls->out, ls->dlen,
+				  ls->dst_len - ls->out);
+	if (r != LZO_E_OK)
+		return r;
+
+	ls->out += ls->dlen;
+	ls->stage = LZOP_BLOCK;
+	ls->need = 4;
+
+	return LZO_E_OK;
+}
+
+/* The data in buf completes the current stage */
+static int lzop_stream_stage(struct lzop_stream *ls)
+{
+	size_t need;
+	int r;
+
+	switch (ls->stage) {
+	case LZOP_HEADER:
+		need = lzop_header_size(ls->buf, ls->have);
+		if (need > ls->have) {
+			ls->need = need;
+			return LZO_E_OK;
+		}
+		if (!parse_header(ls->buf))
+			return LZO_E_ERROR;
+		ls->stage = LZOP_BLOCK;
+		ls->need = 4;
+		break;
+	case LZOP_BLOCK:
+		if (ls->need == 4) {
+			ls->dlen = get_unaligned_be32(ls->buf);
+			if (ls->dlen == 0) {
+				ls->stage = LZOP_DONE;
+				return LZO_E_OK;
+			}
+			/* compressed size and block checksum */
+			ls->need = 12;
+			return LZO_E_OK;
+		}
+		ls->slen = get_unaligned_be32(ls->buf + 4);
+		if (ls->slen <= 0 || ls->slen > ls->dlen)
+			return LZO_E_ERROR;
+		ls->stage = LZOP_DATA;
+		ls->need = ls->slen;
+		break;
+	case LZOP_DATA:
+		r = lzop_stream_block(ls, ls->buf);
+		if (r != LZO_E_OK)
+			return r;
+		break;
+	}
+
+	ls->have = 0;
+
+	return LZO_E_OK;
+}
+
+/*
+ * Decompress the next @len bytes. @outlen returns the number of bytes
+ * written to the destination so far.
+ * Returns 0 if more data is needed, 1 after the end marker and a negative
+ * LZO_E_... on error. Data after the end marker is ignored.
+ */
+int lzop_stream_feed(void *stream, const void *src, unsigned long len,
+		     unsigned long *outlen)
+{
+	struct lzop_stream *ls = stream;
+	const unsigned char *p = src;
+	const unsigned char *end = p + len;
+	unsigned char *buf;
+	size_t n;
+	int r;
+
+	while (p < end && ls->stage != LZOP_DONE) {
+		/* whole block at hand, no need to gather it */
+		if (ls->stage == LZOP_DATA && !ls->have &&
+		    end - p >= ls->slen) {
+			r = lzop_stream_block(ls, p);
+			if (r != LZO_E_OK)
+				return r;
+			p += ls->slen;
+			continue;
+		}
+
+		if (ls->need > ls->buf_size) {
+			buf = malloc(ls->need);
+			if (!buf)
+				return LZO_E_OUT_OF_MEMORY;
+			memcpy(buf, ls->buf, ls->have);
+			free(ls->buf);
+			ls->buf = buf;
+			ls->buf_size = ls->need;
+		}
+
+		n = min(ls->need - ls->have, (size_t)(end - p));
+		memcpy(ls->buf + ls->have, p, n);
+		ls->have += n;
+		p += n;
+
+		if (ls->have == ls->need) {
+			r = lzop_stream_stage(ls);
+			if (r != LZO_E_OK)
+				return r;
+		}
+	}
+
+	*outlen = ls->out;
+
+	return ls->stage == LZOP_DONE;
+}
+
+/* Free the stream, returns LZO_E_INPUT_OVERRUN if the data was incomplete */
+int lzop_stream_finish(void *stream)
+{
+	struct lzop_stream *ls = stream;
+	int done = ls->stage == LZOP_DONE;
+
+	free(ls->buf);
+	free(ls);
+
+	return done ? LZO_E_OK : LZO_E_INPUT_OVERRUN;
+}
+#endif /* CONFIG_DECOMP_STREAM */
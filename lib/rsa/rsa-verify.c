@@ -7,6 +7,7 @@
 #ifndef USE_HOSTCC
 #include <common.h>
 #include <fdtdec.h>
+#include <malloc.h>
 #include <asm/types.h>
 #include <asm/byteorder.h>
 #include <asm/errno.h>
@@ -29,6 +30,31 @@
 /* Default public exponent for backward compatibility */
 #define RSA_DEFAULT_PUBEXP	65537
 
+/* Widest exponent window, pow_mod() keeps 2^(bits - 1) odd powers */
+#define RSA_MAX_WINDOW_BITS	3
+
+/* Keys kept while the signatures of one FIT are checked */
+#define RSA_KEY_CACHE_SIZE	4
+
+/**
+ * struct rsa_cached_key - a key node read into a public key
+ *
+ * @blob:	FDT holding the key node
+ * @node:	Offset of the key node
+ * @key:	The key, its modulus and rr point into @words
+ * @words:	Room for the modulus and rr
+ */
+struct rsa_cached_key {
+	const void *blob;
+	int node;
+	struct rsa_public_key key;
+	uint32_t words[];
+};
+
+/* FIT the cached keys are used for, most recently read key first */
+static const void *rsa_key_cache_fit;
+static struct rsa_cached_key *rsa_key_cache[RSA_KEY_CACHE_SIZE];
+
 /**
  * subtract_modulus() - subtract modulus from the given value
  *
@@ -69,60 +95,51 @@ static int greater_equal_modulus(const struct rsa_public_key *key,
 	return 1;  /* equal */
 }
 
-/**
- * montgomery_mul_add_step() - Perform montgomery multiply-add step
- *
- * Operation: montgomery result[] += a * b[] / n0inv % modulus
- *
- * @key:	RSA key
- * @result:	Place to put result, as little endian word array
- * @a:		Multiplier
- * @b:		Multiplicand, as little endian word array
- */
-static void montgomery_mul_add_step(const struct rsa_public_key *key,
-		uint32_t result[], const uint32_t a, const uint32_t b[])
-{
-	uint64_t acc_a, acc_b;
-	uint32_t d0;
-	uint i;
-
-	acc_a = (uint64_t)a * b[0] + result[0];
-	d0 = (uint32_t)acc_a * key->n0inv;
-	acc_b = (uint64_t)d0 * key->modulus[0] + (uint32_t)acc_a;
-	for (i = 1; i < key->len; i++) {
-		acc_a = (acc_a >> 32) + (uint64_t)a * b[i] + result[i];
-		acc_b = (acc_b >> 32) + (uint64_t)d0 * key->modulus[i] +
-				(uint32_t)acc_a;
-		result[i - 1] = (uint32_t)acc_b;
-	}
-
-	acc_a = (acc_a >> 32) + (acc_b >> 32);
-
-	result[i - 1] = (uint32_t)acc_a;
-
-	if (acc_a >> 32)
-		subtract_modulus(key, result);
-}
-
 /**
  * montgomery_mul() - Perform montgomery mutitply
  *
  * Operation: montgomery result[] = a[] * b[] / n0inv % modulus
  *
+ * Each word of a[] is multiplied in and one word of the result reduced
+ * away in the same pass over b[] and the modulus, both products
+ * accumulated in 64 bits. The key is read into locals once, the compiler
+ * cannot keep it in registers over the stores to result[].
+ *
  * @key:	RSA key
  * @result:	Place to put result, as little endian word array
  * @a:		Multiplier, as little endian word array
  * @b:		Multiplicand, as little endian word array
  */
 static void montgomery_mul(const struct rsa_public_key *key,
-		uint32_t result[], uint32_t a[], const uint32_t b[])
+		uint32_t result[], const uint32_t a[], const uint32_t b[])
 {
-	uint i;
+	const uint32_t *modulus = key->modulus;
+	const uint32_t n0inv = key->n0inv;
+	const uint len = key->len;
+	uint64_t acc_a, acc_b;
+	uint32_t ai, d0;
+	uint i, j;
+
+	memset(result, 0, len * sizeof(result[0]));
+	for (i = 0; i < len; i++) {
+		/* result[] += a[i] * b[] + d0 * modulus[], then one word down */
+		ai = a[i];
+		acc_a = (uint64_t)ai * b[0] + result[0];
+		d0 = (uint32_t)acc_a * n0inv;
+		acc_b = (uint64_t)d0 * modulus[0] + (uint32_t)acc_a;
+		for (j = 1; j < len; j++) {
+			acc_a = (acc_a >> 32) + (uint64_t)ai * b[j] + result[j];
+			acc_b = (acc_b >> 32) + (uint64_t)d0 * modulus[j] +
+					(uint32_t)acc_a;
+			result[j - 1] = (uint32_t)acc_b;
+		}
+
+		acc_a = (acc_a >> 32) + (acc_b >> 32);
+		result[len - 1] = (uint32_t)acc_a;
 
-	for (i = 0; i < key->len; ++i)
-		result[i] = 0;
-	for (i = 0; i < key->len; ++i)
-		montgomery_mul_add_step(key, result, a[i], b);
+		if (acc_a >> 32)
+			subtract_modulus(key, result);
+	}
 }
 
 /**
@@ -164,36 +181,36 @@ static int num_public_exponent_bits(const struct rsa_public_key *key,
 static int is_public_exponent_bit_set(const struct rsa_public_key *key,
 		int pos)
 {
-	return key->exponent & (1ULL << pos);
+	return (key->exponent >> pos) & 1;
 }
 
 /**
  * pow_mod() - in-place public exponentiation
  *
+ * The exponent is worked through from the top in windows of up to
+ * RSA_MAX_WINDOW_BITS bits that end in a one, each window is one multiply
+ * by an odd power of the value from a table. Short exponents like 65537
+ * use one bit windows and no table. Everything is in Montgomery form
+ * until the last multiply, by the plain value for the lowest exponent
+ * bit, which is always set.
+ *
  * @key:	RSA key
  * @inout:	Big-endian word array containing value and result
  */
 static int pow_mod(const struct rsa_public_key *key, uint32_t *inout)
 {
-	uint32_t *result, *ptr;
+	uint32_t *result, *ptr, *acc, *tmp;
+	uint64_t exp;
 	uint i;
-	int j, k;
+	int j, k, l, win, win_bits;
 
 	/* Sanity check for stack size - key->len is in 32-bit words */
-	if (key->len > RSA_MAX_KEY_BITS / 32) {
+	if (!key->len || key->len > RSA_MAX_KEY_BITS / 32) {
 		debug("RSA key words %u exceeds maximum %d\n", key->len,
 		      RSA_MAX_KEY_BITS / 32);
 		return -EINVAL;
 	}
 
-	uint32_t val[key->len], acc[key->len], tmp[key->len];
-	uint32_t a_scaled[key->len];
-	result = tmp;  /* Re-use location. */
-
-	/* Convert from big endian byte array to little endian word array. */
-	for (i = 0, ptr = inout + key->len - 1; i < key->len; i++, ptr--)
-		val[i] = get_unaligned_be32(ptr);
-
 	if (0 != num_public_exponent_bits(key, &k))
 		return -EINVAL;
 
@@ -208,27 +225,64 @@ static int pow_mod(const struct rsa_public_key *key, uint32_t *inout)
 		return -EINVAL;
 	}
 
-	/* the bit at e[k-1] is 1 by definition, so start with: C := M */
-	montgomery_mul(key, acc, val, key->rr); /* acc = a * RR / R mod n */
-	/* retain scaled version for intermediate use */
-	memcpy(a_scaled, acc, key->len * sizeof(a_scaled[0]));
+	/* A table pays off once there are more than a few ones to multiply */
+	win_bits = k > 23 ? RSA_MAX_WINDOW_BITS : 1;
 
-	for (j = k - 2; j > 0; --j) {
-		montgomery_mul(key, tmp, acc, acc); /* tmp = acc^2 / R mod n */
+	uint32_t val[key->len], buf1[key->len], buf2[key->len];
+	uint32_t odd[1 << (win_bits - 1)][key->len];
 
-		if (is_public_exponent_bit_set(key, j)) {
-			/* acc = tmp * val / R mod n */
-			montgomery_mul(key, acc, tmp, a_scaled);
-		} else {
-			/* e[j] == 0, copy tmp back to acc for next operation */
-			memcpy(acc, tmp, key->len * sizeof(acc[0]));
+	/* Convert from big endian byte array to little endian word array. */
+	for (i = 0, ptr = inout + key->len - 1; i < key->len; i++, ptr--)
+		val[i] = get_unaligned_be32(ptr);
+
+	/* odd[i] = val^(2i + 1) * R mod n */
+	montgomery_mul(key, odd[0], val, key->rr);
+	if (win_bits > 1) {
+		montgomery_mul(key, buf1, odd[0], odd[0]);
+		for (i = 1; i < 1 << (win_bits - 1); i++)
+			montgomery_mul(key, odd[i], odd[i - 1], buf1);
+	}
+
+	/*
+	 * Bits k - 1 down to 1, the products go back and forth between the
+	 * two buffers. The top bit is set, its window starts things off.
+	 */
+	acc = NULL;
+	tmp = buf1;
+	exp = key->exponent;
+	for (j = k - 1; j > 0; j = l - 1) {
+		l = j;
+		win = 0;
+		if (exp & (1ULL << j)) {
+			/* the widest window from bit j that ends in a one */
+			l = j - win_bits + 1;
+			if (l < 1)
+				l = 1;
+			while (!(exp & (1ULL << l)))
+				l++;
+			win = (exp >> l) & ((1 << (j - l + 1)) - 1);
+		}
+		if (!acc) {
+			acc = odd[win >> 1];
+			continue;
+		}
+
+		for (i = j - l + 1; i > 0; i--) {
+			montgomery_mul(key, tmp, acc, acc);
+			acc = tmp;
+			tmp = tmp == buf1 ? buf2 : buf1;
+		}
+		if (win) {
+			montgomery_mul(key, tmp, acc, odd[win >> 1]);
+			acc = tmp;
+			tmp = tmp == buf1 ? buf2 : buf1;
 		}
 	}
 
-	/* the bit at e[0] is always 1 */
-	montgomery_mul(key, tmp, acc, acc); /* tmp = acc^2 / R mod n */
-	montgomery_mul(key, acc, tmp, val); /* acc = tmp * a / R mod M */
-	memcpy(result, acc, key->len * sizeof(result[0]));
+	/* the bit at e[0] is always 1, this also leaves Montgomery form */
+	montgomery_mul(key, tmp, acc, acc);
+	result = tmp == buf1 ? buf2 : buf1;
+	montgomery_mul(key, result, tmp, val);
 
 	/* Make sure result < mod; result is at most 1x mod too large. */
 	if (greater_equal_modulus(key, result))
@@ -299,20 +353,51 @@ static void rsa_convert_big_endian(uint32_t *dst, const uint32_t *src, int len)
 		dst[i] = fdt32_to_cpu(src[len - 1 - i]);
 }
 
-static int rsa_verify_with_keynode(struct image_sign_info *info,
-		const void *hash, uint8_t *sig, uint sig_len, int node)
+/**
+ * rsa_get_key() - Get the public key of a key node
+ *
+ * The images and configurations of a FIT are usually all signed with the
+ * same key or two, so keys read while one FIT is checked are kept for
+ * its other signatures. The key nodes are in the control FDT, which does
+ * not change under us, so a kept key is found by its blob and node alone.
+ *
+ * @info:	Specifies key and FIT information
+ * @node:	Key node in info->fdt_blob
+ * @keyp:	Returns the key
+ * @return 0 if OK, -ve on error
+ */
+static int rsa_get_key(struct image_sign_info *info, int node,
+		       const struct rsa_public_key **keyp)
 {
 	const void *blob = info->fdt_blob;
+	struct rsa_cached_key *entry;
 	struct rsa_public_key key;
 	const void *modulus, *rr;
 	const uint64_t *public_exponent;
 	int length;
-	int ret;
+	int i;
 
 	if (node < 0) {
 		debug("%s: Skipping invalid node", __func__);
 		return -EBADF;
 	}
+
+	if (info->fit != rsa_key_cache_fit) {
+		for (i = 0; i < RSA_KEY_CACHE_SIZE; i++) {
+			free(rsa_key_cache[i]);
+			rsa_key_cache[i] = NULL;
+		}
+		rsa_key_cache_fit = info->fit;
+	}
+
+	for (i = 0; i < RSA_KEY_CACHE_SIZE; i++) {
+		entry = rsa_key_cache[i];
+		if (entry && entry->blob == blob && entry->node == node) {
+			*keyp = &entry->key;
+			return 0;
+		}
+	}
+
 	if (!fdt_getprop(blob, node, "rsa,n0-inverse", NULL)) {
 		debug("%s: Missing rsa,n0-inverse", __func__);
 		return -EFAULT;
@@ -338,19 +423,42 @@ static int rsa_verify_with_keynode(struct image_sign_info *info,
 		return -EFAULT;
 	}
 	key.len /= sizeof(uint32_t) * 8;
-	uint32_t key1[key.len], key2[key.len];
 
-	key.modulus = key1;
-	key.rr = key2;
-	rsa_convert_big_endian(key.modulus, modulus, key.len);
-	rsa_convert_big_endian(key.rr, rr, key.len);
-	if (!key.modulus || !key.rr) {
+	entry = malloc(sizeof(*entry) + 2 * key.len * sizeof(uint32_t));
+	if (!entry) {
 		debug("%s: Out of memory", __func__);
 		return -ENOMEM;
 	}
+	entry->blob = blob;
+	entry->node = node;
+	entry->key = key;
+	entry->key.modulus = entry->words;
+	entry->key.rr = entry->words + key.len;
+	rsa_convert_big_endian(entry->key.modulus, modulus, key.len);
+	rsa_convert_big_endian(entry->key.rr, rr, key.len);
+
+	/* the least recently read key makes room */
+	free(rsa_key_cache[RSA_KEY_CACHE_SIZE - 1]);
+	for (i = RSA_KEY_CACHE_SIZE - 1; i > 0; i--)
+		rsa_key_cache[i] = rsa_key_cache[i - 1];
+	rsa_key_cache[0] = entry;
+
+	*keyp = &entry->key;
+	return 0;
+}
+
+static int rsa_verify_with_keynode(struct image_sign_info *info,
+		const void *hash, uint8_t *sig, uint sig_len, int node)
+{
+	const struct rsa_public_key *key;
+	int ret;
+
+	ret = rsa_get_key(info, node, &key);
+	if (ret)
+		return ret;
 
-	debug("key length %d\n", key.len);
-	ret = rsa_verify_key(&key, sig, sig_len, hash, info->algo->checksum);
+	debug("key length %d\n", key->len);
+	ret = rsa_verify_key(key, sig, sig_len, hash, info->algo->checksum);
 	if (ret) {
 		printf("%s: RSA failed to verify: %d\n", __func__, ret);
 		return ret;
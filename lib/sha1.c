@@ -36,8 +36,15 @@
 #include <string.h>
 #endif /* USE_HOSTCC */
 #include <watchdog.h>
+#include <hash.h>
 #include <u-boot/sha1.h>
 
+#if defined(CONFIG_ARMV7_NEON) && !defined(USE_HOSTCC)
+#include <asm/sha_neon.h>
+#else
+#undef CONFIG_ARMV7_NEON
+#endif
+
 /*
  * 32-bit integer manipulation macros (big endian)
  */
@@ -227,6 +234,39 @@ static void sha1_process(sha1_context *ctx, const unsigned char data[64])
 	ctx->state[4] += E;
 }
 
+static void sha1_blocks_c(void *ctx, const unsigned char *input,
+			  unsigned int blocks)
+{
+	while (blocks--) {
+		sha1_process(ctx, input);
+		input += 64;
+	}
+}
+
+#ifdef CONFIG_ARMV7_NEON
+/* unsigned long is 32 bits on ARMv7, state[] is the uint32_t[5] wanted */
+static void sha1_blocks_neon(void *ctx, const unsigned char *input,
+			     unsigned int blocks)
+{
+	sha1_neon_blocks((uint32_t *)((sha1_context *)ctx)->state, input,
+			 blocks);
+}
+#endif
+
+const struct hash_backend sha1_backends[] = {
+#ifdef CONFIG_ARMV7_NEON
+	{ "neon", sha_neon_usable, sha1_blocks_neon },
+#endif
+	{ "c", NULL, sha1_blocks_c },
+};
+
+/* Hash whole blocks with the best backend this CPU can run now */
+static void sha1_blocks(sha1_context *ctx, const unsigned char *input,
+			unsigned int blocks)
+{
+	hash_pick_backend(sha1_backends)->blocks(ctx, input, blocks);
+}
+
 /*
  * SHA-1 process buffer
  */
@@ -250,16 +290,16 @@ void sha1_update(sha1_context *ctx, const unsigned char *input,
 
 	if (left && ilen >= fill) {
 		memcpy ((void *) (ctx->buffer + left), (void *) input, fill);
-		sha1_process (ctx, ctx->buffer);
+		sha1_blocks(ctx, ctx->buffer, 1);
 		input += fill;
 		ilen -= fill;
 		left = 0;
 	}
 
-	while (ilen >= 64) {
-		sha1_process (ctx, input);
-		input += 64;
-		ilen -= 64;
+	if (ilen >= 64) {
+		sha1_blocks(ctx, input, ilen / 64);
+		input += ilen & ~0x3F;
+		ilen &= 0x3F;
 	}
 
 	if (ilen > 0) {
@@ -13,8 +13,15 @@
 #include <string.h>
 #endif /* USE_HOSTCC */
 #include <watchdog.h>
+#include <hash.h>
 #include <u-boot/sha256.h>
 
+#if defined(CONFIG_ARMV7_NEON) && !defined(USE_HOSTCC)
+#include <asm/sha_neon.h>
+#else
+#undef CONFIG_ARMV7_NEON
+#endif
+
 /*
  * 32-bit integer manipulation macros (big endian)
  */
@@ -181,6 +188,37 @@ static void sha256_process(sha256_context *ctx, const uint8_t data[64])
 	ctx->state[7] += H;
 }
 
+static void sha256_blocks_c(void *ctx, const unsigned char *input,
+			    unsigned int blocks)
+{
+	while (blocks--) {
+		sha256_process(ctx, input);
+		input += 64;
+	}
+}
+
+#ifdef CONFIG_ARMV7_NEON
+static void sha256_blocks_neon(void *ctx, const unsigned char *input,
+			       unsigned int blocks)
+{
+	sha256_neon_blocks(((sha256_context *)ctx)->state, input, blocks);
+}
+#endif
+
+const struct hash_backend sha256_backends[] = {
+#ifdef CONFIG_ARMV7_NEON
+	{ "neon", sha_neon_usable, sha256_blocks_neon },
+#endif
+	{ "c", NULL, sha256_blocks_c },
+};
+
+/* Hash whole blocks with the best backend this CPU can run now */
+static void sha256_blocks(sha256_context *ctx, const uint8_t *input,
+			  uint32_t blocks)
+{
+	hash_pick_backend(sha256_backends)->blocks(ctx, input, blocks);
+}
+
 void sha256_update(sha256_context *ctx, const uint8_t *input, uint32_t length)
 {
 	uint32_t left, fill;
@@ -199,16 +237,16 @@ void sha256_update(sha256_context *ctx, const uint8_t *input, uint32_t length)
 
 	if (left && length >= fill) {
 		memcpy((void *) (ctx->buffer + left), (void *) input, fill);
-		sha256_process(ctx, ctx->buffer);
+		sha256_blocks(ctx, ctx->buffer, 1);
 		length -= fill;
 		input += fill;
 		left = 0;
 	}
 
-	while (length >= 64) {
-		sha256_process(ctx, input);
-		length -= 64;
-		input += 64;
+	if (length >= 64) {
+		sha256_blocks(ctx, input, length / 64);
+		input += length & ~0x3F;
+		length &= 0x3F;
 	}
 
 	if (length)
@@ -252,6 +252,10 @@ void inflate_fast(z_streamp strm, unsigned start)
                             PUP(out) = PUP(from);
                     }
                 }
+                else if (len >= MATCH_COPY_MIN_LEN) {
+                    /* long match from the output, see match_copy.h */
+                    out = match_copy(out + OFF, dist, len) - OFF;
+                }
                 else {
 		    unsigned short *sout;
 		    unsigned long loops;
@@ -376,6 +376,9 @@ u32 ether_crc(size_t len, unsigned char const *p)
 #endif
 
 
+/* Set by eth_halt(), the driver may reset its receive ring after that */
+static int eth_rx_halted;
+
 int eth_init(bd_t *bis)
 {
 	struct eth_device *old_current, *dev;
@@ -422,6 +425,7 @@ void eth_halt(void)
 	eth_current->halt(eth_current);
 
 	eth_current->state = ETH_STATE_PASSIVE;
+	eth_rx_halted = 1;
 }
 
 int eth_send(void *packet, int length)
@@ -432,12 +436,41 @@ int eth_send(void *packet, int length)
 	return eth_current->send(eth_current, packet, length);
 }
 
+/* Frames handled per eth_rx() call with a zero-copy driver */
+#define ETH_RX_BATCH	32
+
 int eth_rx(void)
 {
-	if (!eth_current)
+	struct eth_device *dev = eth_current;
+	uchar *packet;
+	int i, len;
+
+	if (!dev)
 		return -1;
 
-	return eth_current->recv(eth_current);
+	if (!dev->recv_pkt)
+		return dev->recv(dev);
+
+	/*
+	 * Pass the frames to the stack straight from the driver's buffers
+	 * and drain what has arrived in one go, the caller only comes back
+	 * after checking for ctrl-c and timeouts.
+	 */
+	for (i = 0; i < ETH_RX_BATCH; i++) {
+		len = dev->recv_pkt(dev, &packet);
+		if (len < 0)
+			break;
+
+		eth_rx_halted = 0;
+		if (len > 0)
+			NetReceive(packet, len);
+		/* a restart from the handler has taken the ring back */
+		if (eth_rx_halted)
+			break;
+		dev->free_pkt(dev, packet, len);
+	}
+
+	return i;
 }
 
 #ifdef CONFIG_API
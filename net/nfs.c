@@ -26,6 +26,7 @@
 #include <command.h>
 #include <net.h>
 #include <malloc.h>
+#include <asm/io.h>
 #include "nfs.h"
 #include "bootp.h"
 
@@ -42,10 +43,26 @@
 
 static int fs_mounted;
 static unsigned long rpc_id;
-static int nfs_offset = -1;
-static int nfs_len;
 static ulong nfs_timeout = NFS_TIMEOUT;
 
+/*
+ * READ requests in flight. Up to NFS_READ_WINDOW of them are outstanding
+ * at a time, so that the transfer is not bound by the round trip time.
+ * Replies are matched to their request by the RPC xid and stored at their
+ * offset, whatever order they come in.
+ */
+struct nfs_read {
+	unsigned long id;	/* xid, 0 if the slot is free */
+	unsigned offset;
+	unsigned len;
+};
+
+static struct nfs_read nfs_reads[NFS_READ_WINDOW];
+static int nfs_read_window;	/* "nfsreadwindow", at most NFS_READ_WINDOW */
+static unsigned nfs_offset;	/* next offset to ask for */
+static unsigned nfs_filesize;	/* from the attributes in the replies */
+static unsigned nfs_received;
+
 static char dirfh[NFS_FHSIZE];	/* file handle of directory */
 static char filefh[NFS_FHSIZE]; /* file handle of kernel image */
 
@@ -93,7 +110,10 @@ store_block(uchar *src, unsigned offset, unsigned len)
 	} else
 #endif /* CONFIG_SYS_DIRECT_FLASH_NFS */
 	{
-		(void)memcpy((void *)(load_addr + offset), src, len);
+		void *ptr = map_sysmem(load_addr + offset, len);
+
+		memcpy(ptr, src, len);
+		unmap_sysmem(ptr);
 	}
 
 	if (NetBootFileXferSize < (offset+len))
@@ -131,7 +151,7 @@ dirname(char *path)
 /**************************************************************************
 RPC_ADD_CREDENTIALS - Add RPC authentication/verifier entries
 **************************************************************************/
-static long *rpc_add_credentials(long *p)
+static uint32_t *rpc_add_credentials(uint32_t *p)
 {
 	int hl;
 	int hostnamelen;
@@ -243,7 +263,7 @@ nfs_mount_req(char *path)
 	pathlen = strlen(path);
 
 	p = &(data[0]);
-	p = (uint32_t *)rpc_add_credentials((long *)p);
+	p = rpc_add_credentials(p);
 
 	*p++ = htonl(pathlen);
 	if (pathlen & 3)
@@ -271,7 +291,7 @@ nfs_umountall_req(void)
 		return;
 
 	p = &(data[0]);
-	p = (uint32_t *)rpc_add_credentials((long *)p);
+	p = rpc_add_credentials(p);
 
 	len = (uint32_t *)p - (uint32_t *)&(data[0]);
 
@@ -293,7 +313,7 @@ nfs_readlink_req(void)
 	int len;
 
 	p = &(data[0]);
-	p = (uint32_t *)rpc_add_credentials((long *)p);
+	p = rpc_add_credentials(p);
 
 	memcpy(p, filefh, NFS_FHSIZE);
 	p += (NFS_FHSIZE / 4);
@@ -317,7 +337,7 @@ nfs_lookup_req(char *fname)
 	fnamelen = strlen(fname);
 
 	p = &(data[0]);
-	p = (uint32_t *)rpc_add_credentials((long *)p);
+	p = rpc_add_credentials(p);
 
 	memcpy(p, dirfh, NFS_FHSIZE);
 	p += (NFS_FHSIZE / 4);
@@ -336,24 +356,80 @@ nfs_lookup_req(char *fname)
 NFS_READ - Read File on NFS Server
 **************************************************************************/
 static void
-nfs_read_req(int offset, int readlen)
+nfs_read_req(struct nfs_read *req)
 {
 	uint32_t data[1024];
 	uint32_t *p;
 	int len;
 
 	p = &(data[0]);
-	p = (uint32_t *)rpc_add_credentials((long *)p);
+	p = rpc_add_credentials(p);
 
 	memcpy(p, filefh, NFS_FHSIZE);
 	p += (NFS_FHSIZE / 4);
-	*p++ = htonl(offset);
-	*p++ = htonl(readlen);
+	*p++ = htonl(req->offset);
+	*p++ = htonl(req->len);
 	*p++ = 0;
 
 	len = (uint32_t *)p - (uint32_t *)&(data[0]);
 
 	rpc_req(PROG_NFS, NFS_READ, data, len);
+	req->id = rpc_id;
+}
+
+/* Start reading the file, no size known yet */
+static void
+nfs_read_start(void)
+{
+	memset(nfs_reads, 0, sizeof(nfs_reads));
+	nfs_read_window = getenv_ulong("nfsreadwindow", 10, NFS_READ_WINDOW);
+	nfs_read_window = max(1, min(nfs_read_window, NFS_READ_WINDOW));
+	nfs_offset = 0;
+	nfs_filesize = ~0U;
+	nfs_received = 0;
+}
+
+/* Send READ requests until the window is full or the whole file asked for */
+static void
+nfs_read_fill(void)
+{
+	struct nfs_read *req;
+	int i;
+
+	for (i = 0; i < nfs_read_window && nfs_offset < nfs_filesize; i++) {
+		req = &nfs_reads[i];
+		if (req->id)
+			continue;
+
+		req->offset = nfs_offset;
+		req->len = min(nfs_filesize - nfs_offset,
+			       (unsigned)NFS_READ_SIZE);
+		nfs_read_req(req);
+		nfs_offset += req->len;
+	}
+}
+
+/* Ask again for everything still outstanding */
+static void
+nfs_read_resend(void)
+{
+	int i;
+
+	for (i = 0; i < NFS_READ_WINDOW; i++)
+		if (nfs_reads[i].id)
+			nfs_read_req(&nfs_reads[i]);
+}
+
+static int
+nfs_read_busy(void)
+{
+	int i;
+
+	for (i = 0; i < NFS_READ_WINDOW; i++)
+		if (nfs_reads[i].id)
+			return 1;
+
+	return 0;
 }
 
 /**************************************************************************
@@ -382,7 +458,10 @@ NfsSend(void)
 		nfs_lookup_req(nfs_filename);
 		break;
 	case STATE_READ_REQ:
-		nfs_read_req(nfs_offset, nfs_len);
+		if (nfs_read_busy())
+			nfs_read_resend();
+		else
+			nfs_read_fill();
 		break;
 	case STATE_READLINK_REQ:
 		nfs_readlink_req();
@@ -542,15 +621,23 @@ static int
 nfs_read_reply(uchar *pkt, unsigned len)
 {
 	struct rpc_t rpc_pkt;
-	int rlen;
+	struct nfs_read *req = NULL;
+	unsigned hashes;
+	int i, rlen;
 
 	debug("%s\n", __func__);
 
+	if (len < sizeof(rpc_pkt.u.reply))
+		return -NFS_RPC_DROP;
 	memcpy((uchar *)&rpc_pkt, pkt, sizeof(rpc_pkt.u.reply));
 
-	if (ntohl(rpc_pkt.u.reply.id) > rpc_id)
-		return -NFS_RPC_ERR;
-	else if (ntohl(rpc_pkt.u.reply.id) < rpc_id)
+	for (i = 0; i < NFS_READ_WINDOW; i++) {
+		if (nfs_reads[i].id &&
+		    nfs_reads[i].id == ntohl(rpc_pkt.u.reply.id))
+			req = &nfs_reads[i];
+	}
+	/* a resent request or one from before */
+	if (!req)
 		return -NFS_RPC_DROP;
 
 	if (rpc_pkt.u.reply.rstatus  ||
@@ -564,17 +651,40 @@ nfs_read_reply(uchar *pkt, unsigned len)
 		return -ntohl(rpc_pkt.u.reply.data[0]);
 	}
 
-	if ((nfs_offset != 0) && !((nfs_offset) %
-			(NFS_READ_SIZE / 2 * 10 * HASHES_PER_LINE)))
-		puts("\n\t ");
-	if (!(nfs_offset % ((NFS_READ_SIZE / 2) * 10)))
-		putc('#');
-
+	/* status, then the file attributes with the size, then the data */
 	rlen = ntohl(rpc_pkt.u.reply.data[18]);
+	if (rlen > req->len || len < sizeof(rpc_pkt.u.reply) + rlen)
+		return -NFS_RPC_DROP;
+	nfs_filesize = ntohl(rpc_pkt.u.reply.data[6]);
+
 	if (store_block((uchar *)pkt + sizeof(rpc_pkt.u.reply),
-			nfs_offset, rlen))
+			req->offset, rlen))
 		return -9999;
 
+	hashes = nfs_received / (NFS_READ_SIZE / 2 * 10);
+	nfs_received += rlen;
+	while (hashes < nfs_received / (NFS_READ_SIZE / 2 * 10)) {
+		if (hashes && !(hashes % HASHES_PER_LINE))
+			puts("\n\t ");
+		putc('#');
+		hashes++;
+	}
+
+	if (rlen && rlen < req->len && req->offset + rlen < nfs_filesize) {
+		/* short read, ask for the rest */
+		req->offset += rlen;
+		req->len -= rlen;
+		nfs_read_req(req);
+	} else {
+		req->id = 0;
+	}
+
+	/* the file is smaller than we asked for, or shrank meanwhile */
+	if (!rlen && req->offset < nfs_filesize)
+		nfs_filesize = req->offset;
+	if (nfs_offset > nfs_filesize)
+		nfs_offset = nfs_filesize;
+
 	return rlen;
 }
 
@@ -660,8 +770,7 @@ NfsHandler(uchar *pkt, unsigned dest, IPaddr_t sip, unsigned src, unsigned len)
 			NfsSend();
 		} else {
 			NfsState = STATE_READ_REQ;
-			nfs_offset = 0;
-			nfs_len = NFS_READ_SIZE;
+			nfs_read_start();
 			NfsSend();
 		}
 		break;
@@ -686,17 +795,22 @@ NfsHandler(uchar *pkt, unsigned dest, IPaddr_t sip, unsigned src, unsigned len)
 
 	case STATE_READ_REQ:
 		rlen = nfs_read_reply(pkt, len);
+		if (rlen == -NFS_RPC_DROP)
+			break;
 		NetSetTimeout(nfs_timeout, NfsTimeout);
-		if (rlen > 0) {
-			nfs_offset += rlen;
+		if (rlen >= 0) {
+			nfs_read_fill();
+			if (nfs_read_busy())
+				break;
+			/* all of the file is in */
+			nfs_download_state = NETLOOP_SUCCESS;
+			NfsState = STATE_UMOUNT_REQ;
 			NfsSend();
 		} else if ((rlen == -NFSERR_ISDIR) || (rlen == -NFSERR_INVAL)) {
 			/* symbolic link */
 			NfsState = STATE_READLINK_REQ;
 			NfsSend();
 		} else {
-			if (!rlen)
-				nfs_download_state = NETLOOP_SUCCESS;
 			NfsState = STATE_UMOUNT_REQ;
 			NfsSend();
 		}
@@ -44,6 +44,18 @@
 #define NFS_READ_SIZE 1024 /* biggest power of two that fits Ether frame */
 #endif
 
+/* NFSv2 reads at most 8 KiB per request */
+#if NFS_READ_SIZE > 8192
+#error "CONFIG_NFS_READ_SIZE is larger than NFSv2 allows"
+#endif
+
+/* Number of READ requests kept in flight */
+#ifdef CONFIG_NFS_READ_WINDOW
+#define NFS_READ_WINDOW CONFIG_NFS_READ_WINDOW
+#else
+#define NFS_READ_WINDOW 8
+#endif
+
 #define NFS_MAXLINKDEPTH 16
 
 struct rpc_t {
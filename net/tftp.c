@@ -9,6 +9,7 @@
 #include <common.h>
 #include <command.h>
 #include <net.h>
+#include <asm/io.h>
 #include "tftp.h"
 #include "bootp.h"
 #ifdef CONFIG_SYS_DIRECT_FLASH_TFTP
@@ -130,6 +131,31 @@ static char tftp_filename[MAX_LEN];
 static unsigned short TftpBlkSize = TFTP_BLOCK_SIZE;
 static unsigned short TftpBlkSizeOption = TFTP_MTU_BLOCKSIZE;
 
+/*
+ * RFC 7440 windowsize: the server sends this many blocks per ACK instead
+ * of one, so a download is no longer bound by the round trip time. The
+ * blocks of a window are tracked in a bitmap, which limits the window.
+ */
+#ifdef CONFIG_TFTP_WINDOWSIZE
+#define TFTP_WINDOWSIZE		CONFIG_TFTP_WINDOWSIZE
+#else
+#define TFTP_WINDOWSIZE		1
+#endif
+#define TFTP_WINDOWSIZE_MAX	64
+
+static unsigned short TftpWindowSize = 1;
+static unsigned short TftpWindowSizeOption = TFTP_WINDOWSIZE;
+/* block at which the server expects our next ACK, and the last ACK */
+static ulong	TftpWindowAck;
+static ulong	TftpWindowAcked;
+/* blocks after TftpLastBlock already stored, bit 0 is TftpLastBlock + 1 */
+static unsigned long long TftpWindowMap;
+/* the short block ending the file has been stored */
+static int	TftpWindowEnd;
+static ulong	TftpWindowEndBlock;
+/* we answered a resent block with our ACK already */
+static int	TftpWindowReAck;
+
 #ifdef CONFIG_MCAST_TFTP
 #include <malloc.h>
 #define MTFTP_BITMAPSIZE	0x1000
@@ -184,7 +210,10 @@ store_block(int block, uchar *src, unsigned len)
 	} else
 #endif /* CONFIG_SYS_DIRECT_FLASH_TFTP */
 	{
-		(void)memcpy((void *)(load_addr + offset), src, len);
+		void *ptr = map_sysmem(load_addr + offset, len);
+
+		memcpy(ptr, src, len);
+		unmap_sysmem(ptr);
 	}
 #ifdef CONFIG_MCAST_TFTP
 	if (Multicast)
@@ -201,6 +230,11 @@ static void new_transfer(void)
 	TftpLastBlock = 0;
 	TftpBlockWrap = 0;
 	TftpBlockWrapOffset = 0;
+	TftpWindowAck = TftpWindowSize;
+	TftpWindowAcked = 0;
+	TftpWindowMap = 0;
+	TftpWindowEnd = 0;
+	TftpWindowReAck = 0;
 #ifdef CONFIG_CMD_TFTPPUT
 	TftpFinalBlock = 0;
 #endif
@@ -359,6 +393,9 @@ TftpSend(void)
 		/* try for more effic. blk size */
 		pkt += sprintf((char *)pkt, "blksize%c%d%c",
 				0, TftpBlkSizeOption, 0);
+		if (TftpWindowSizeOption > 1)
+			pkt += sprintf((char *)pkt, "windowsize%c%d%c",
+					0, TftpWindowSizeOption, 0);
 #ifdef CONFIG_MCAST_TFTP
 		/* Check all preconditions before even trying the option */
 		if (!ProhibitMcast) {
@@ -442,6 +479,79 @@ static void icmp_handler(unsigned type, unsigned code, unsigned dest,
 }
 #endif
 
+/* Acknowledge the blocks received in order, the server goes on from there */
+static void tftp_window_ack(void)
+{
+	TftpBlock = TftpLastBlock;
+	TftpWindowAcked = TftpLastBlock;
+	TftpWindowAck = (unsigned short)(TftpLastBlock + TftpWindowSize);
+	TftpWindowReAck = 0;
+	TftpSend();
+}
+
+/*
+ * Store a data block of a windowsize transfer. Blocks of the current
+ * window are stored wherever they fall, even if an earlier one is still
+ * missing. Once the last block of the window is in, the blocks received
+ * in order are acknowledged: with nothing lost that is the whole window,
+ * else the server resends from the first missing block right away,
+ * without waiting for a timeout.
+ */
+static void tftp_window_data(uchar *src, unsigned len)
+{
+	ulong block = TftpBlock;
+	unsigned ahead = (unsigned short)(block - TftpLastBlock);
+	unsigned resent = (unsigned short)(block - TftpWindowAcked);
+
+	if (ahead == 0 || ahead > TftpWindowSize) {
+		/*
+		 * Already stored. Blocks after our last ACK are the resent
+		 * window we asked for, anything older means the server
+		 * missed that ACK: tell it once where we are.
+		 */
+		if ((resent == 0 || resent > TftpWindowSize) &&
+		    !TftpWindowReAck) {
+			tftp_window_ack();
+			TftpWindowReAck = 1;
+		}
+		return;
+	}
+
+	store_block(TftpLastBlock + ahead - 1, src, len);
+	TftpWindowMap |= 1ULL << (ahead - 1);
+	if (len < TftpBlkSize) {
+		TftpWindowEnd = 1;
+		TftpWindowEndBlock = block;
+	}
+
+	if (TftpWindowMap & 1) {
+		TftpTimeoutCount = 0;
+		TftpTimeoutCountMax = TIMEOUT_COUNT;
+		NetSetTimeout(TftpTimeoutMSecs, TftpTimeout);
+	}
+
+	while (TftpWindowMap & 1) {
+		TftpWindowMap >>= 1;
+		TftpLastBlock = (unsigned short)(TftpLastBlock + 1);
+		if (TftpLastBlock == 0) {
+			TftpBlockWrap++;
+			TftpBlockWrapOffset += TftpBlkSize * TFTP_SEQUENCE_SIZE;
+		}
+		TftpBlock = TftpLastBlock;
+		show_block_marker();
+	}
+
+	if (TftpWindowEnd && TftpLastBlock == TftpWindowEndBlock) {
+		tftp_window_ack();
+		tftp_complete();
+	} else if (block == TftpWindowAck ||
+		   (TftpWindowEnd && block == TftpWindowEndBlock)) {
+		debug("TFTP window: block %ld missing\n",
+		      (ulong)(unsigned short)(TftpLastBlock + 1));
+		tftp_window_ack();
+	}
+}
+
 static void
 TftpHandler(uchar *pkt, unsigned dest, IPaddr_t sip, unsigned src,
 	    unsigned len)
@@ -528,6 +638,15 @@ TftpHandler(uchar *pkt, unsigned dest, IPaddr_t sip, unsigned src,
 				debug("Blocksize ack: %s, %d\n",
 					(char *)pkt+i+8, TftpBlkSize);
 			}
+			if (strcmp((char *)pkt+i, "windowsize") == 0) {
+				TftpWindowSize = (unsigned short)
+					simple_strtoul((char *)pkt+i+11, NULL,
+						       10);
+				if (TftpWindowSize > TftpWindowSizeOption)
+					TftpWindowSize = TftpWindowSizeOption;
+				debug("Windowsize ack: %s, %d\n",
+				      (char *)pkt+i+11, TftpWindowSize);
+			}
 #ifdef CONFIG_TFTP_TSIZE
 			if (strcmp((char *)pkt+i, "tsize") == 0) {
 				TftpTsize = simple_strtoul((char *)pkt+i+6,
@@ -539,6 +658,8 @@ TftpHandler(uchar *pkt, unsigned dest, IPaddr_t sip, unsigned src,
 		}
 #ifdef CONFIG_MCAST_TFTP
 		parse_multicast_oack((char *)pkt, len-1);
+		if (Multicast)
+			TftpWindowSize = 1;
 		if ((Multicast) && (!MasterClient))
 			TftpState = STATE_DATA;	/* passive.. */
 		else
@@ -558,6 +679,17 @@ TftpHandler(uchar *pkt, unsigned dest, IPaddr_t sip, unsigned src,
 		len -= 2;
 		TftpBlock = ntohs(*(__be16 *)pkt);
 
+		/* only ever negotiated by the OACK of a read request */
+		if (TftpWindowSize > 1) {
+			if (TftpState == STATE_OACK) {
+				TftpState = STATE_DATA;
+				TftpRemotePort = src;
+				new_transfer();
+			}
+			tftp_window_data(pkt + 2, len);
+			break;
+		}
+
 		update_block_number();
 
 		if (TftpState == STATE_SEND_RRQ)
@@ -679,7 +811,9 @@ TftpTimeout(void)
 	} else {
 		puts("T ");
 		NetSetTimeout(TftpTimeoutMSecs, TftpTimeout);
-		if (TftpState != STATE_RECV_WRQ)
+		if (TftpWindowSize > 1 && TftpState == STATE_DATA)
+			tftp_window_ack();
+		else if (TftpState != STATE_RECV_WRQ)
 			TftpSend();
 	}
 }
@@ -701,6 +835,13 @@ void TftpStart(enum proto_t protocol)
 	if (ep != NULL)
 		TftpTimeoutMSecs = simple_strtol(ep, NULL, 10);
 
+	TftpWindowSizeOption = getenv_ulong("tftpwindowsize", 10,
+					    TFTP_WINDOWSIZE);
+	if (TftpWindowSizeOption < 1)
+		TftpWindowSizeOption = 1;
+	if (TftpWindowSizeOption > TFTP_WINDOWSIZE_MAX)
+		TftpWindowSizeOption = TFTP_WINDOWSIZE_MAX;
+
 	if (TftpTimeoutMSecs < 1000) {
 		printf("TFTP timeout (%ld ms) too low, "
 			"set minimum = 1000 ms\n",
@@ -708,8 +849,8 @@ void TftpStart(enum proto_t protocol)
 		TftpTimeoutMSecs = 1000;
 	}
 
-	debug("TFTP blocksize = %i, timeout = %ld ms\n",
-		TftpBlkSizeOption, TftpTimeoutMSecs);
+	debug("TFTP blocksize = %i, windowsize = %i, timeout = %ld ms\n",
+		TftpBlkSizeOption, TftpWindowSizeOption, TftpTimeoutMSecs);
 
 	TftpRemoteIP = NetServerIP;
 	if (BootFile[0] == '\0') {
@@ -807,8 +948,9 @@ void TftpStart(enum proto_t protocol)
 
 	/* zero out server ether in case the server ip has changed */
 	memset(NetServerEther, 0, 6);
-	/* Revert TftpBlkSize to dflt */
+	/* Revert TftpBlkSize and TftpWindowSize to dflt */
 	TftpBlkSize = TFTP_BLOCK_SIZE;
+	TftpWindowSize = 1;
 #ifdef CONFIG_MCAST_TFTP
 	mcast_cleanup();
 #endif
@@ -837,8 +979,9 @@ TftpStartServer(void)
 	TftpTimeoutMSecs = TIMEOUT;
 	NetSetTimeout(TftpTimeoutMSecs, TftpTimeout);
 
-	/* Revert TftpBlkSize to dflt */
+	/* Revert TftpBlkSize and TftpWindowSize to dflt */
 	TftpBlkSize = TFTP_BLOCK_SIZE;
+	TftpWindowSize = 1;
 	TftpBlock = 0;
 	TftpOurPort = WELL_KNOWN_PORT;
 
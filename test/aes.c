@@ -0,0 +1,136 @@
+/*
+ * AES-128 known-answer test and engine throughput
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+#include <common.h>
+#include <command.h>
+#include <malloc.h>
+#include <aes.h>
+
+/* FIPS-197, appendix C.1 */
+static const u8 fips_key[AES_KEY_LENGTH] = {
+	0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+	0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f,
+};
+
+static const u8 fips_plain[AES_KEY_LENGTH] = {
+	0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77,
+	0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff,
+};
+
+static const u8 fips_cipher[AES_KEY_LENGTH] = {
+	0x69, 0xc4, 0xe0, 0xd8, 0x6a, 0x7b, 0x04, 0x30,
+	0xd8, 0xcd, 0xb7, 0x80, 0x70, 0xb4, 0xc5, 0x5a,
+};
+
+#define TEST_BUFFER_SIZE	(4 << 20)
+
+#define errcheck(statement) if (!(statement)) { \
+	fprintf(stderr, "\tFailed: %s\n", #statement); \
+	ret = 1; \
+	goto out; \
+}
+
+typedef void (*aes_blocks_func)(u8 *key_exp, u8 *src, u8 *dst,
+				u32 num_aes_blocks);
+
+/* The byte-wise engine, one aes_encrypt() call per block */
+static void ref_encrypt_blocks(u8 *key_exp, u8 *src, u8 *dst,
+			       u32 num_aes_blocks)
+{
+	u32 i;
+
+	for (i = 0; i < num_aes_blocks; i++)
+		aes_encrypt(src + i * AES_KEY_LENGTH, key_exp,
+			    dst + i * AES_KEY_LENGTH);
+}
+
+static void ref_decrypt_blocks(u8 *key_exp, u8 *src, u8 *dst,
+			       u32 num_aes_blocks)
+{
+	u32 i;
+
+	for (i = 0; i < num_aes_blocks; i++)
+		aes_decrypt(src + i * AES_KEY_LENGTH, key_exp,
+			    dst + i * AES_KEY_LENGTH);
+}
+
+static ulong run_bench(aes_blocks_func func, u8 *key_exp, u8 *src, u8 *dst)
+{
+	ulong start, msecs;
+
+	start = get_timer(0);
+	func(key_exp, src, dst, TEST_BUFFER_SIZE / AES_KEY_LENGTH);
+	msecs = max(get_timer(start), 1UL);
+
+	/* KiB per millisecond is close enough to MB/s */
+	return (TEST_BUFFER_SIZE >> 10) / msecs;
+}
+
+static int do_test_aes(cmd_tbl_t *cmdtp, int flag, int argc,
+		       char * const argv[])
+{
+	u8 key_exp[AES_EXPAND_KEY_LENGTH];
+	u8 block[AES_KEY_LENGTH];
+	u8 *plain = NULL, *cipher = NULL, *check = NULL;
+	int i, ret;
+
+	aes_expand_key((u8 *)fips_key, key_exp);
+
+	printf(" testing vectors ...\n");
+	aes_encrypt((u8 *)fips_plain, key_exp, block);
+	errcheck(memcmp(block, fips_cipher, sizeof(block)) == 0);
+	aes_decrypt((u8 *)fips_cipher, key_exp, block);
+	errcheck(memcmp(block, fips_plain, sizeof(block)) == 0);
+	aes_encrypt_blocks(key_exp, (u8 *)fips_plain, block, 1);
+	errcheck(memcmp(block, fips_cipher, sizeof(block)) == 0);
+	aes_decrypt_blocks(key_exp, (u8 *)fips_cipher, block, 1);
+	errcheck(memcmp(block, fips_plain, sizeof(block)) == 0);
+
+	plain = malloc(TEST_BUFFER_SIZE);
+	cipher = malloc(TEST_BUFFER_SIZE);
+	check = malloc(TEST_BUFFER_SIZE);
+	errcheck(plain && cipher && check);
+	for (i = 0; i < TEST_BUFFER_SIZE; i++)
+		plain[i] = i * 7 + (i >> 8);
+
+	/* Both engines must agree on bulk data, in place too */
+	printf(" testing engines agree ...\n");
+	ref_encrypt_blocks(key_exp, plain, cipher,
+			   TEST_BUFFER_SIZE / AES_KEY_LENGTH);
+	memcpy(check, plain, TEST_BUFFER_SIZE);
+	aes_encrypt_blocks(key_exp, check, check,
+			   TEST_BUFFER_SIZE / AES_KEY_LENGTH);
+	errcheck(memcmp(check, cipher, TEST_BUFFER_SIZE) == 0);
+	aes_decrypt_blocks(key_exp, check, check,
+			   TEST_BUFFER_SIZE / AES_KEY_LENGTH);
+	errcheck(memcmp(check, plain, TEST_BUFFER_SIZE) == 0);
+
+	printf(" byte-wise: encrypt %lu MB/s, decrypt %lu MB/s\n",
+	       run_bench(ref_encrypt_blocks, key_exp, plain, check),
+	       run_bench(ref_decrypt_blocks, key_exp, cipher, check));
+#ifdef CONFIG_AES_TTABLE
+	printf(" t-table:   encrypt %lu MB/s, decrypt %lu MB/s\n",
+#else
+	printf(" blocks:    encrypt %lu MB/s, decrypt %lu MB/s\n",
+#endif
+	       run_bench(aes_encrypt_blocks, key_exp, plain, check),
+	       run_bench(aes_decrypt_blocks, key_exp, cipher, check));
+
+	ret = 0;
+out:
+	printf("test_aes %s\n", ret == 0 ? "ok" : "FAILED");
+
+	free(check);
+	free(cipher);
+	free(plain);
+
+	return ret;
+}
+
+U_BOOT_CMD(
+	test_aes,	1,	1,	do_test_aes,
+	"Test AES-128 vectors and benchmark the engines", ""
+);
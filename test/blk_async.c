@@ -0,0 +1,111 @@
+/*
+ * Async block read test: read a host backed device with blk_read_submit()
+ * and check the buffer stays untouched until the read is done
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+#include <common.h>
+#include <command.h>
+#include <malloc.h>
+#include <os.h>
+#include <part.h>
+#include <sandboxblockdev.h>
+
+#define TEST_DEV		(CONFIG_HOST_MAX_DEVICES - 1)
+#define TEST_BLKS		64
+#define TEST_START		8
+#define TEST_CNT		32
+
+static int test_blk_read(block_dev_desc_t *dev_desc, const u8 *expect,
+			 u8 *buf, const char *what)
+{
+	int polls = 0;
+
+	memset(buf, 0xa5, TEST_CNT * 512);
+	blk_read_submit(dev_desc, TEST_START, TEST_CNT, buf);
+	while (!blk_read_done(dev_desc))
+		polls++;
+	if (dev_desc->block_read_async && !polls) {
+		printf("\tFailed: %s read completed without polling\n", what);
+		return 1;
+	}
+
+	if (blk_read_wait(dev_desc) != TEST_CNT) {
+		printf("\tFailed: %s read returned short\n", what);
+		return 1;
+	}
+	if (memcmp(buf, expect + TEST_START * 512, TEST_CNT * 512)) {
+		printf("\tFailed: %s read data mismatch\n", what);
+		return 1;
+	}
+
+	printf(" %s read ok after %d polls\n", what, polls);
+	return 0;
+}
+
+static int do_test_blk_async(cmd_tbl_t *cmdtp, int flag, int argc,
+			     char * const argv[])
+{
+	const char *file = argc > 1 ? argv[1] : "blk_async.img";
+	block_dev_desc_t *dev_desc;
+	u8 *img, *buf;
+	int fd, i, ret = 1;
+
+	img = malloc(TEST_BLKS * 512);
+	buf = malloc(TEST_CNT * 512);
+	if (!img || !buf)
+		goto out;
+	for (i = 0; i < TEST_BLKS * 512; i++)
+		img[i] = i ^ (i >> 9);
+
+	fd = os_open(file, OS_O_RDWR | OS_O_CREAT);
+	if (fd < 0 || os_write(fd, img, TEST_BLKS * 512) != TEST_BLKS * 512) {
+		printf("\tFailed: can't write %s\n", file);
+		goto out;
+	}
+	os_close(fd);
+
+	if (host_dev_bind(TEST_DEV, (char *)file)) {
+		printf("\tFailed: can't bind %s\n", file);
+		goto out;
+	}
+	dev_desc = host_get_dev(TEST_DEV);
+
+	/* the submitted read must not land before it is polled */
+	memset(buf, 0xa5, TEST_CNT * 512);
+	blk_read_submit(dev_desc, TEST_START, TEST_CNT, buf);
+	for (i = 0; i < TEST_CNT * 512; i++)
+		if (buf[i] != 0xa5)
+			break;
+	blk_read_wait(dev_desc);
+	if (i != TEST_CNT * 512) {
+		printf("\tFailed: buffer written before the first poll\n");
+		goto unbind;
+	}
+
+	if (test_blk_read(dev_desc, img, buf, "async"))
+		goto unbind;
+
+	/* drivers without block_read_async fall back to block_read */
+	dev_desc->block_read_async = NULL;
+	if (test_blk_read(dev_desc, img, buf, "sync"))
+		goto unbind;
+
+	ret = 0;
+unbind:
+	host_dev_bind(TEST_DEV, NULL);
+	os_unlink(file);
+out:
+	printf("test_blk_async %s\n", ret == 0 ? "ok" : "FAILED");
+	free(buf);
+	free(img);
+
+	return ret;
+}
+
+U_BOOT_CMD(
+	test_blk_async,	2,	1,	do_test_blk_async,
+	"Read a host block device with blk_read_submit() and check the data",
+	"[file]"
+);
@@ -0,0 +1,120 @@
+/*
+ * Block cache test: repeated reads hit, writes (also those bypassing
+ * blk_dwrite()) and rebinds drop the cached blocks
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+#include <common.h>
+#include <command.h>
+#include <malloc.h>
+#include <os.h>
+#include <part.h>
+#include <sandboxblockdev.h>
+
+#define TEST_DEV		(CONFIG_HOST_MAX_DEVICES - 1)
+#define TEST_BLKS		16
+
+static int test_blkcache_read(block_dev_desc_t *dev_desc, lbaint_t start,
+			      u8 expect, unsigned hits, const char *what)
+{
+	struct blkcache_stats stats;
+	u8 buf[2 * 512];
+	int i;
+
+	if (blk_dread(dev_desc, start, 2, buf) != 2) {
+		printf("\tFailed: %s read error\n", what);
+		return 1;
+	}
+
+	blkcache_stats(&stats);
+	if (stats.hits != hits || stats.misses != !hits) {
+		printf("\tFailed: %s hits %u misses %u\n", what, stats.hits,
+		       stats.misses);
+		return 1;
+	}
+
+	for (i = 0; i < sizeof(buf); i++) {
+		if (buf[i] != (u8)(expect + i / 512)) {
+			printf("\tFailed: %s data at %d\n", what, i);
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+static int do_test_blkcache(cmd_tbl_t *cmdtp, int flag, int argc,
+			    char * const argv[])
+{
+	const char *file = argc > 1 ? argv[1] : "blkcache.img";
+	struct blkcache_stats stats;
+	block_dev_desc_t *dev_desc;
+	u8 img[TEST_BLKS * 512];
+	int fd, i, ret = 1;
+
+	for (i = 0; i < sizeof(img); i++)
+		img[i] = i / 512;
+
+	fd = os_open(file, OS_O_RDWR | OS_O_CREAT);
+	if (fd < 0 || os_write(fd, img, sizeof(img)) != sizeof(img)) {
+		printf("\tFailed: can't write %s\n", file);
+		goto out;
+	}
+	os_close(fd);
+
+	if (host_dev_bind(TEST_DEV, (char *)file)) {
+		printf("\tFailed: can't bind %s\n", file);
+		goto out;
+	}
+	dev_desc = host_get_dev(TEST_DEV);
+	blkcache_stats(&stats);
+
+	if (test_blkcache_read(dev_desc, 4, 4, 0, "first") ||
+	    test_blkcache_read(dev_desc, 4, 4, 1, "second"))
+		goto unbind;
+
+	/* write-through: the device gets the data, the cache forgets */
+	memset(img, 0x40, 512);
+	memset(img + 512, 0x41, 512);
+	if (blk_dwrite(dev_desc, 4, 2, img) != 2) {
+		printf("\tFailed: write error\n");
+		goto unbind;
+	}
+	if (test_blkcache_read(dev_desc, 4, 0x40, 0, "after write") ||
+	    test_blkcache_read(dev_desc, 4, 0x40, 1, "cached write"))
+		goto unbind;
+
+	/* so does a raw write through the driver, as "usb write" does */
+	memset(img, 0x50, 512);
+	memset(img + 512, 0x51, 512);
+	if (dev_desc->block_write(dev_desc->dev, 4, 2, img) != 2) {
+		printf("\tFailed: raw write error\n");
+		goto unbind;
+	}
+	if (test_blkcache_read(dev_desc, 4, 0x50, 0, "after raw write"))
+		goto unbind;
+
+	/* a rescan drops the device too */
+	host_dev_bind(TEST_DEV, (char *)file);
+	dev_desc = host_get_dev(TEST_DEV);
+	/* the partition probe of the bind reads through the cache */
+	blkcache_stats(&stats);
+	if (test_blkcache_read(dev_desc, 4, 0x50, 0, "after rebind"))
+		goto unbind;
+
+	ret = 0;
+unbind:
+	host_dev_bind(TEST_DEV, NULL);
+	os_unlink(file);
+out:
+	printf("test_blkcache %s\n", ret == 0 ? "ok" : "FAILED");
+
+	return ret;
+}
+
+U_BOOT_CMD(
+	test_blkcache,	2,	1,	do_test_blkcache,
+	"Check hits and invalidation of the block cache",
+	"[file]"
+);
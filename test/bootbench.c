@@ -0,0 +1,81 @@
+/*
+ * Boot benchmark phase runner for test/bootbench: run a command as a named
+ * phase, timed as a bootstage accumulator so it also shows up in the
+ * bootstage report, and print one line for the harness to parse:
+ *
+ *   bootbench: <phase> us=<time> bytes=<filesize> ret=<status>
+ *
+ * 'bytes' is the filesize the command left behind, 0 if it set none.
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+#include <common.h>
+#include <command.h>
+#include <malloc.h>
+
+/* Phase ids are taken from the top of the user range, down */
+#define BENCH_PHASES		8
+
+static char *bench_phase[BENCH_PHASES];
+
+static int bench_phase_id(const char *name)
+{
+	int i;
+
+	for (i = 0; i < BENCH_PHASES && bench_phase[i]; i++)
+		if (!strcmp(bench_phase[i], name))
+			break;
+	if (i == BENCH_PHASES)
+		return -1;
+	if (!bench_phase[i]) {
+		bench_phase[i] = strdup(name);
+		if (!bench_phase[i])
+			return -1;
+	}
+
+	return BOOTSTAGE_ID_COUNT - 1 - i;
+}
+
+static int do_bootbench(cmd_tbl_t *cmdtp, int flag, int argc,
+			char * const argv[])
+{
+	char cmd[CONFIG_SYS_CBSIZE];
+	uint32_t us;
+	int id, i, ret;
+
+	if (argc < 3)
+		return CMD_RET_USAGE;
+
+	id = bench_phase_id(argv[1]);
+	if (id < 0) {
+		printf("bootbench: too many phases\n");
+		return 1;
+	}
+
+	for (cmd[0] = '\0', i = 2; i < argc; i++) {
+		if (strlen(cmd) + strlen(argv[i]) + 2 > sizeof(cmd)) {
+			printf("bootbench: command too long\n");
+			return 1;
+		}
+		if (i > 2)
+			strcat(cmd, " ");
+		strcat(cmd, argv[i]);
+	}
+
+	setenv("filesize", NULL);
+	bootstage_start(id, bench_phase[BOOTSTAGE_ID_COUNT - 1 - id]);
+	ret = run_command(cmd, flag);
+	us = bootstage_accum(id);
+
+	printf("bootbench: %s us=%u bytes=%lu ret=%d\n", argv[1], us,
+	       getenv_hex("filesize", 0), ret);
+
+	return ret;
+}
+
+U_BOOT_CMD(
+	bootbench,	CONFIG_SYS_MAXARGS,	1,	do_bootbench,
+	"Run a command as a timed boot phase, see test/bootbench",
+	"<phase> <command...>"
+);
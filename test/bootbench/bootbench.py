@@ -0,0 +1,390 @@
+#!/usr/bin/python
+#
+# Boot time benchmark on sandbox with per-phase budgets
+#
+# SPDX-License-Identifier:	GPL-2.0+
+#
+# Builds a disk image (FAT and ext4 partitions), a SPI flash holding a
+# packimg and a simulated NAND with UBI (from the test_ubi command), then
+# runs the boot phases listed in test/bootbench/phases with the
+# environment of each board header. Every phase is timed inside U-Boot by
+# the 'bootbench' command. The result is printed as a table and optionally
+# written as JSON; the exit status is 1 if a phase fails or goes over its
+# budget.
+#
+# To run this:
+#
+# make O=sandbox sandbox_defconfig
+# make O=sandbox
+# ./test/bootbench/bootbench.py -u sandbox/u-boot [-j result.json]
+
+from __future__ import print_function
+
+from optparse import OptionParser
+import gzip
+import json
+import os
+import random
+import re
+import shutil
+import struct
+import subprocess
+import sys
+import tempfile
+
+base_path = os.path.dirname(os.path.abspath(sys.argv[0]))
+src_path = os.path.join(base_path, '../..')
+
+# How each board header is preprocessed
+boards = {
+    'rbctrl': ['-DCONFIG_MX6DL', '-DCONFIG_BOOT_SPI'],
+    'wisehmi': ['-DCONFIG_MX6Q', '-DCONFIG_BOOT_NAND'],
+}
+
+# Board addresses do not fit in sandbox RAM, move them there
+sandbox_env = {
+    'loadaddr': '1000000',
+    'fdt_addr': '1800000',
+    'initrd_addr': '1c00000',
+    'kernel_out': '2000000',
+    'mmcdev': '0',
+    'mmcpart': '1',
+}
+
+# Where the environment file is loaded
+ENV_ADDR = 0x100000
+
+SECTOR = 512
+PART_START = 2048       # first partition, in sectors
+FAT_SECTORS = 128 << 11 # 128 MiB
+EXT4_SECTORS = 64 << 11 # 64 MiB
+
+SF_SIZE = 2 << 20
+SF_PACK_OFFS = 0xc0000
+
+def run(args, **kwargs):
+    """Run a host command, return its output"""
+    proc = subprocess.Popen(args, stdout=subprocess.PIPE,
+                            stderr=subprocess.STDOUT, **kwargs)
+    out = proc.communicate()[0].decode('utf-8', 'replace')
+    if proc.returncode:
+        raise RuntimeError('%s failed:\n%s' % (' '.join(args), out))
+    return out
+
+def board_env(board):
+    """Get the default environment of a board from its header
+
+    Returns:
+        dict of variable name to value
+    """
+    tmp = tempfile.mkdtemp()
+    try:
+        # the headers want the asm/arch link of a configured tree
+        os.mkdir(os.path.join(tmp, 'asm'))
+        os.symlink(os.path.join(src_path, 'arch/arm/include/asm/arch-mx6'),
+                   os.path.join(tmp, 'asm/arch'))
+        src = os.path.join(tmp, 'env.c')
+        with open(src, 'w') as fd:
+            fd.write('bootbench_env CONFIG_EXTRA_ENV_SETTINGS\n')
+        out = run(['gcc', '-E', '-P', '-nostdinc', '-D__ASSEMBLY__',
+                   '-DCONFIG_DDR_MB=1024', '-I', tmp,
+                   '-I', os.path.join(src_path, 'include'),
+                   '-I', os.path.join(src_path, 'arch/arm/include')] +
+                  boards[board] +
+                  ['-include', os.path.join(src_path, 'include/configs',
+                                            board + '.h'), src])
+    finally:
+        shutil.rmtree(tmp)
+
+    line = [l for l in out.splitlines() if l.startswith('bootbench_env')][0]
+    text = ''.join(re.findall(r'"((?:[^"\\]|\\.)*)"', line))
+    text = text.replace('\\"', '"').replace('\\0', '\0')
+    env = {}
+    for var in text.split('\0'):
+        if '=' in var:
+            name, value = var.split('=', 1)
+            # loads from the eMMC come from the host disk image
+            env[name] = re.sub(r'\b(fatload|ext4load|load) mmc\b',
+                               r'\1 host', value)
+    env.update(sandbox_env)
+    return env
+
+def make_kernel(size):
+    """Make a kernel stand-in that compresses about as well as a kernel"""
+    rnd = random.Random(size)
+    words = [bytes(bytearray(rnd.getrandbits(8) for i in range(8)))
+             for j in range(512)]
+    data = b''.join(rnd.choice(words) for i in range(size // 8))
+    return gzip_data(data)
+
+def gzip_data(data):
+    tmp = tempfile.TemporaryFile()
+    with gzip.GzipFile(fileobj=tmp, mode='wb', mtime=0) as fd:
+        fd.write(data)
+    tmp.seek(0)
+    return tmp.read()
+
+def make_uimage(mkimage, tmpdir, gz):
+    """Wrap the compressed kernel the way rbctrl boots it"""
+    src = os.path.join(tmpdir, 'kernel.gz')
+    img = os.path.join(tmpdir, 'uImage')
+    with open(src, 'wb') as fd:
+        fd.write(gz)
+    run([mkimage, '-A', 'arm', '-O', 'linux', '-T', 'kernel', '-C', 'gzip',
+         '-a', '10008000', '-e', '10008000', '-n', 'bootbench', '-d', src,
+         img])
+    with open(img, 'rb') as fd:
+        return fd.read()
+
+def make_fat16(files, sectors, hidden):
+    """Make a FAT16 file system with files in its root directory
+
+    Args:
+        files: dict of 8.3 name to data
+        sectors: size of the file system
+        hidden: sector of the file system on the disk
+    """
+    spc, reserved, nfats, rootents = 8, 1, 2, 512
+    rootsecs = rootents * 32 // SECTOR
+    fatsecs = ((sectors // spc + 2) * 2 + SECTOR - 1) // SECTOR
+    data_start = reserved + nfats * fatsecs + rootsecs
+    clusters = (sectors - data_start) // spc
+
+    img = bytearray(sectors * SECTOR)
+    struct.pack_into('<3s8sHBHBHHBHHHII', img, 0, b'\xeb\x3c\x90',
+                     b'BOOTBNCH', SECTOR, spc, reserved, nfats, rootents, 0,
+                     0xf8, fatsecs, 32, 64, hidden, sectors)
+    struct.pack_into('<BBBI11s8s', img, 36, 0x80, 0, 0x29, 0x1234,
+                     b'BOOTBENCH  ', b'FAT16   ')
+    img[510:512] = b'\x55\xaa'
+
+    fat = [0xfff8, 0xffff] + [0] * clusters
+    cluster = 2
+    for i, (name, data) in enumerate(sorted(files.items())):
+        base, ext = (name.upper().split('.') + [''])[:2]
+        count = (len(data) + spc * SECTOR - 1) // (spc * SECTOR)
+        struct.pack_into('<8s3sB10xHHHI', img,
+                         (reserved + nfats * fatsecs) * SECTOR + i * 32,
+                         base.ljust(8).encode(), ext.ljust(3).encode(), 0x20,
+                         0, 0x21, cluster if count else 0, len(data))
+        offs = (data_start + (cluster - 2) * spc) * SECTOR
+        img[offs:offs + len(data)] = data
+        for c in range(cluster, cluster + count):
+            fat[c] = c + 1
+        if count:
+            fat[cluster + count - 1] = 0xffff
+        cluster += count
+    if cluster - 2 > clusters:
+        raise RuntimeError('files do not fit in the FAT image')
+
+    table = struct.pack('<%dH' % len(fat), *fat)
+    for i in range(nfats):
+        offs = (reserved + i * fatsecs) * SECTOR
+        img[offs:offs + len(table)] = table
+    return img
+
+def make_ext4(tmpdir, files, sectors):
+    """Make an ext4 file system with mke2fs, None if it can't"""
+    root = os.path.join(tmpdir, 'ext4')
+    img = os.path.join(tmpdir, 'ext4.img')
+    os.mkdir(root)
+    for name, data in files.items():
+        with open(os.path.join(root, name), 'wb') as fd:
+            fd.write(data)
+    try:
+        run(['mke2fs', '-q', '-F', '-t', 'ext4', '-d', root, img,
+             '%dk' % (sectors * SECTOR // 1024)])
+    except (OSError, RuntimeError) as e:
+        print('No ext4 partition: %s' % e)
+        return None
+    with open(img, 'rb') as fd:
+        return fd.read()
+
+def make_disk(fname, parts):
+    """Write a disk image with an MBR and the given partitions
+
+    Args:
+        parts: list of (type, sectors, data), data may be None
+    """
+    mbr = bytearray(SECTOR)
+    start = PART_START
+    with open(fname, 'wb') as fd:
+        for i, (ptype, sectors, data) in enumerate(parts):
+            struct.pack_into('<B3sB3sII', mbr, 446 + i * 16, 0, b'\xff' * 3,
+                             ptype, b'\xff' * 3, start, sectors)
+            fd.seek(start * SECTOR)
+            fd.write(data or bytes(bytearray(SECTOR)))
+            start += sectors
+        fd.truncate(start * SECTOR)
+        mbr[510:512] = b'\x55\xaa'
+        fd.seek(0)
+        fd.write(mbr)
+
+def make_sf(fname, pack):
+    """Write the SPI flash image with the packimg where rbctrl keeps it"""
+    with open(fname, 'wb') as fd:
+        fd.write(b'\xff' * SF_SIZE)
+        fd.seek(SF_PACK_OFFS)
+        fd.write(pack)
+
+def make_pack(mkpackimg, tmpdir, files):
+    """Pack files with mkpackimg, None if it is not built"""
+    if not os.path.exists(mkpackimg):
+        print('No packimg: %s not found' % mkpackimg)
+        return None
+    out = os.path.join(tmpdir, 'pack.img')
+    args = [mkpackimg, '-o', out]
+    for i, (name, data) in enumerate(sorted(files.items())):
+        fname = os.path.join(tmpdir, 'pack-' + name)
+        with open(fname, 'wb') as fd:
+            fd.write(data)
+        args.append('%s:%x:%s' % (fname, 0x18000000 + i * 0x100000, name))
+    run(args)
+    with open(out, 'rb') as fd:
+        return fd.read()
+
+def read_phases(fname):
+    """Read the phase list
+
+    Returns:
+        list of (board, phase, budget in us, command)
+    """
+    phases = []
+    with open(fname) as fd:
+        for line in fd:
+            line = line.strip()
+            if not line or line.startswith('#'):
+                continue
+            board, phase, budget, cmd = line.split(None, 3)
+            phases.append((board, phase, int(budget) * 1000, cmd))
+    return phases
+
+def run_board(u_boot, tmpdir, board, env, phases, files):
+    """Run the phases of a board in one sandbox session
+
+    Returns:
+        dict of phase to (us, bytes, ret)
+    """
+    env_file = os.path.join(tmpdir, board + '.env')
+    with open(env_file, 'w') as fd:
+        for name, value in sorted(env.items()):
+            fd.write('%s=%s\n' % (name, value))
+
+    cmds = ['sb bind 0 %s' % files['disk'],
+            'sb load hostfs - %x %s' % (ENV_ADDR, env_file),
+            'env import -t %x ${filesize}' % ENV_ADDR]
+    if [p for p in phases if p[3].startswith('ubi')]:
+        cmds.append('test_ubi')
+    for board_name, phase, budget, cmd in phases:
+        cmds.append("bootbench %s '%s'" % (phase, cmd))
+
+    args = [u_boot, '-c', '; '.join(cmds)]
+    if files.get('sf'):
+        args[1:1] = ['--spi_sf', '0:0:W25Q16CL:%s' % files['sf']]
+    proc = subprocess.Popen(args, stdout=subprocess.PIPE,
+                            stderr=subprocess.STDOUT)
+    out = proc.communicate()[0].decode('utf-8', 'replace')
+
+    result = {}
+    for m in re.finditer(r'^bootbench: (\S+) us=(\d+) bytes=(\d+) ret=(-?\d+)',
+                         out, re.M):
+        result[m.group(1)] = (int(m.group(2)), int(m.group(3)),
+                              int(m.group(4)))
+    return result, out
+
+def run_bench():
+    parser = OptionParser()
+    parser.add_option('-u', '--u-boot',
+            default=os.path.join(src_path, 'sandbox/u-boot'),
+            help='Select U-Boot sandbox binary')
+    parser.add_option('-p', '--phases',
+            default=os.path.join(base_path, 'phases'),
+            help='Phase list with budgets')
+    parser.add_option('-b', '--board', action='append',
+            help='Only run the phases of this board (may be repeated)')
+    parser.add_option('-j', '--json', help='Write the results as JSON')
+    parser.add_option('-s', '--kernel-size', type='int', default=16,
+            help='Uncompressed kernel size in MiB')
+    parser.add_option('-k', '--keep', action='store_true',
+            help="Don't delete temporary directory even when tests pass")
+    parser.add_option('-v', '--verbose', action='store_true',
+            help='Show the U-Boot output')
+    (options, args) = parser.parse_args()
+
+    tools = os.path.join(os.path.dirname(options.u_boot), 'tools')
+    phases = [p for p in read_phases(options.phases)
+              if not options.board or p[0] in options.board]
+
+    tmpdir = tempfile.mkdtemp(prefix='bootbench.')
+    gz = make_kernel(options.kernel_size << 20)
+    uimage = make_uimage(os.path.join(tools, 'mkimage'), tmpdir, gz)
+    fdt = bytes(bytearray(random.Random(1).getrandbits(8)
+                          for i in range(48 << 10)))
+
+    results = []
+    failed = False
+    for board in sorted(set(p[0] for p in phases)):
+        env = board_env(board)
+        env['kernel_data'] = '%x' % (int(env['loadaddr'], 16) + 64)
+        boot_files = {
+            env.get('image', 'uImage'): uimage,
+            env.get('kernel_file', 'zImage'): uimage,
+            env['fdt_file']: fdt,
+        }
+        os.mkdir(os.path.join(tmpdir, board))
+        ext4 = make_ext4(os.path.join(tmpdir, board), boot_files,
+                         EXT4_SECTORS)
+        fat = make_fat16(boot_files, FAT_SECTORS, PART_START)
+        files = {'disk': os.path.join(tmpdir, board + '.img')}
+        make_disk(files['disk'], [(0x0e, FAT_SECTORS, fat),
+                                  (0x83, EXT4_SECTORS, ext4)])
+        pack = make_pack(os.path.join(tools, 'mkpackimg'), tmpdir,
+                         {env['fdt_file']: fdt, 'splash': gz[:200 << 10]})
+        if pack:
+            files['sf'] = os.path.join(tmpdir, board + '.sf')
+            make_sf(files['sf'], pack)
+            env['pack_size'] = '%x' % len(pack)
+
+        board_phases = [p for p in phases if p[0] == board]
+        timing, out = run_board(options.u_boot, tmpdir, board, env,
+                                board_phases, files)
+        if options.verbose:
+            print(out)
+
+        for board_name, phase, budget, cmd in board_phases:
+            us, nbytes, ret = timing.get(phase, (0, 0, -1))
+            if ret:
+                status = 'failed'
+            elif us > budget:
+                status = 'over budget'
+            else:
+                status = 'ok'
+            failed |= status != 'ok'
+            results.append({
+                'board': board, 'phase': phase, 'command': cmd,
+                'us': us, 'bytes': nbytes, 'budget_us': budget,
+                'mib_per_s': round(nbytes / 1.048576 / us, 1)
+                             if us and nbytes else None,
+                'status': status,
+            })
+
+    print('%-8s %-12s %10s %10s %10s %8s  %s' % ('board', 'phase', 'us',
+          'budget', 'bytes', 'MiB/s', 'status'))
+    for r in results:
+        print('%-8s %-12s %10d %10d %10d %8s  %s' % (r['board'], r['phase'],
+              r['us'], r['budget_us'], r['bytes'],
+              r['mib_per_s'] if r['mib_per_s'] is not None else '-',
+              r['status']))
+
+    if options.json:
+        with open(options.json, 'w') as fd:
+            json.dump(results, fd, indent=1, sort_keys=True)
+
+    if failed or options.keep:
+        print('Images left in %s' % tmpdir)
+    else:
+        shutil.rmtree(tmpdir)
+    return 1 if failed else 0
+
+if __name__ == '__main__':
+    sys.exit(run_bench())
@@ -18,6 +18,11 @@
 #include <lzma/LzmaTools.h>
 
 #include <linux/lzo.h>
+#include <lz4.h>
+#include <match_copy.h>
+#include <decomp_stream.h>
+#include <asm/io.h>
+#include <asm/unaligned.h>
 
 static const char plain[] =
 	"I am a highly compressable bit of text.\n"
@@ -224,6 +229,128 @@ static int uncompress_using_lzo(void *in, unsigned long in_size,
 	return (ret != LZO_E_OK);
 }
 
+/* LZ4 frame header: independent blocks, 4 MiB maximum block size */
+static const unsigned char lz4_frame_hdr[] = {
+	0x04, 0x22, 0x4d, 0x18, 0x60, 0x70, 0x73
+};
+
+#define LZ4_BLOCK_MAX		(4 << 20)
+#define LZ4_HASH_BITS		12
+
+static unsigned char *lz4_put_len(unsigned char *op, ulong len)
+{
+	for (; len >= 255; len -= 255)
+		*op++ = 255;
+	*op++ = len;
+
+	return op;
+}
+
+/*
+ * Greedy LZ4 block compressor, only good enough to feed the decompressor.
+ * Returns the compressed size or 0 if it does not fit in @out_max.
+ */
+static ulong lz4_compress_block(const unsigned char *src, ulong len,
+				unsigned char *out, ulong out_max)
+{
+	u32 table[1 << LZ4_HASH_BITS];
+	const unsigned char *end = src + len;
+	const unsigned char *anchor = src, *p = src, *ref;
+	unsigned char *op = out, *op_end = out + out_max;
+	ulong lit, mlen;
+	u32 h;
+
+	memset(table, 0, sizeof(table));
+	/* the last match must start 12 bytes and end 5 bytes before the end */
+	while (len >= 12 && p < end - 12) {
+		h = (get_unaligned_le32(p) * 2654435761u) >> (32 - LZ4_HASH_BITS);
+		ref = src + table[h];
+		table[h] = p - src;
+		if (ref >= p || p - ref > 65535 ||
+		    get_unaligned_le32(ref) != get_unaligned_le32(p)) {
+			p++;
+			continue;
+		}
+		for (mlen = 4; p + mlen < end - 5 && p[mlen] == ref[mlen]; )
+			mlen++;
+
+		lit = p - anchor;
+		if (op_end - op < 1 + lit / 255 + 1 + lit + 2 + mlen / 255 + 1)
+			return 0;
+		*op++ = (min(lit, 15UL) << 4) | min(mlen - 4, 15UL);
+		if (lit >= 15)
+			op = lz4_put_len(op, lit - 15);
+		memcpy(op, anchor, lit);
+		op += lit;
+		put_unaligned_le16(p - ref, op);
+		op += 2;
+		if (mlen - 4 >= 15)
+			op = lz4_put_len(op, mlen - 4 - 15);
+		p += mlen;
+		anchor = p;
+	}
+
+	lit = end - anchor;
+	if (op_end - op < 1 + lit / 255 + 1 + lit)
+		return 0;
+	*op++ = min(lit, 15UL) << 4;
+	if (lit >= 15)
+		op = lz4_put_len(op, lit - 15);
+	memcpy(op, anchor, lit);
+	op += lit;
+
+	return op - out;
+}
+
+static int compress_using_lz4(void *in, unsigned long in_size,
+			      void *out, unsigned long out_max,
+			      unsigned long *out_size)
+{
+	unsigned char *op = out, *op_end = op + out_max;
+	ulong done, n, blk;
+
+	if (out_max < sizeof(lz4_frame_hdr))
+		return -1;
+	memcpy(op, lz4_frame_hdr, sizeof(lz4_frame_hdr));
+	op += sizeof(lz4_frame_hdr);
+
+	for (done = 0; done < in_size; done += n) {
+		n = min(in_size - done, (ulong)LZ4_BLOCK_MAX);
+		if (op_end - op < 4)
+			return -1;
+		blk = lz4_compress_block(in + done, n, op + 4, op_end - op - 4);
+		if (!blk)
+			return -1;
+		put_unaligned_le32(blk, op);
+		op += 4 + blk;
+	}
+
+	/* end mark */
+	if (op_end - op < 4)
+		return -1;
+	put_unaligned_le32(0, op);
+	op += 4;
+
+	if (out_size)
+		*out_size = op - (unsigned char *)out;
+
+	return 0;
+}
+
+static int uncompress_using_lz4(void *in, unsigned long in_size,
+				void *out, unsigned long out_max,
+				unsigned long *out_size)
+{
+	int ret;
+	size_t output_size = out_max;
+
+	ret = lz4_decompress(in, in_size, out, &output_size);
+	if (out_size)
+		*out_size = output_size;
+
+	return ret != 0;
+}
+
 #define errcheck(statement) if (!(statement)) { \
 	fprintf(stderr, "\tFailed: %s\n", #statement); \
 	ret = 1; \
@@ -313,16 +440,369 @@ out:
 	return ret;
 }
 
+/* Bit-at-a-time reference, independent of the tables in lib/crc32.c */
+static uint32_t crc32_bitwise(uint32_t crc, const unsigned char *p,
+			      unsigned int len)
+{
+	int k;
+
+	crc = ~crc;
+	while (len--) {
+		crc ^= *p++;
+		for (k = 0; k < 8; k++)
+			crc = (crc >> 1) ^ (crc & 1 ? 0xedb88320 : 0);
+	}
+
+	return ~crc;
+}
+
+#define CRC32_BENCH_SIZE	(4 << 20)
+#define CRC32_BENCH_LOOPS	8
+
+static int run_crc32_test(void)
+{
+	unsigned char *buf;
+	unsigned int i, off, len;
+	ulong start, msecs;
+	uint32_t crc = 0;
+	int ret;
+
+	printf(" testing crc32 ...\n");
+
+	buf = malloc(CRC32_BENCH_SIZE);
+	errcheck(buf != NULL);
+	for (i = 0; i < CRC32_BENCH_SIZE; i++)
+		buf[i] = (i * 2654435761u) >> 24;
+
+	errcheck(crc32(0, (const unsigned char *)"123456789", 9) ==
+		 0xcbf43926);
+
+	/* Every alignment and every tail length */
+	for (off = 0; off < 8; off++) {
+		for (len = 0; len < 64; len++)
+			errcheck(crc32(0x12345678, buf + off, len) ==
+				 crc32_bitwise(0x12345678, buf + off, len));
+	}
+	errcheck(crc32(0, buf + 3, 65536) == crc32_bitwise(0, buf + 3, 65536));
+
+	/* Chained calls give the same result as one */
+	errcheck(crc32(crc32(0, buf, 1001), buf + 1001, 3095) ==
+		 crc32(0, buf, 4096));
+	printf("\tmatches bitwise reference\n");
+
+	start = get_timer(0);
+	for (i = 0; i < CRC32_BENCH_LOOPS; i++)
+		crc ^= crc32(crc, buf, CRC32_BENCH_SIZE);
+	msecs = max(get_timer(start), 1UL);
+
+	/* KiB per millisecond is close enough to MB/s */
+	printf("\t%lu MB/s\n",
+	       (CRC32_BENCH_LOOPS * (CRC32_BENCH_SIZE >> 10)) / msecs);
+
+	ret = 0;
+
+out:
+	printf(" crc32: %s\n", ret == 0 ? "ok" : "FAILED");
+
+	free(buf);
+
+	return ret;
+}
+
+static int run_match_copy_test(void)
+{
+	unsigned char *buf = NULL, *ref = NULL;
+	ulong dist, len, i;
+	int ret;
+
+	printf(" testing match_copy ...\n");
+
+	buf = malloc(1024);
+	errcheck(buf != NULL);
+	ref = malloc(1024);
+	errcheck(ref != NULL);
+
+	/* Every short distance, lengths either side of the 16 byte steps */
+	for (dist = 1; dist <= 40; dist++) {
+		for (len = 1; len <= 300; len += len < 40 ? 1 : 13) {
+			for (i = 0; i < 1024; i++)
+				buf[i] = ref[i] = i * 7 + dist;
+			for (i = 0; i < len; i++)
+				ref[64 + i] = ref[64 + i - dist];
+			errcheck(match_copy(buf + 64, dist, len) ==
+				 buf + 64 + len);
+			errcheck(memcmp(buf, ref, 1024) == 0);
+		}
+	}
+	printf("\tmatches byte-wise copy\n");
+
+	ret = 0;
+
+out:
+	printf(" match_copy: %s\n", ret == 0 ? "ok" : "FAILED");
+
+	free(ref);
+	free(buf);
+
+	return ret;
+}
+
+#define DECOMP_BENCH_SIZE	(4 << 20)
+#define DECOMP_BENCH_LOOPS	4
+
+/* Decompress @comp_buf a few times, returns KiB per millisecond */
+static ulong decomp_bench(mutate_func uncompress, void *comp_buf,
+			  ulong comp_size, void *out, ulong size)
+{
+	ulong start, msecs, out_size;
+	int i;
+
+	start = get_timer(0);
+	for (i = 0; i < DECOMP_BENCH_LOOPS; i++) {
+		if (uncompress(comp_buf, comp_size, out, size, &out_size) ||
+		    out_size != size)
+			return 0;
+	}
+	msecs = max(get_timer(start), 1UL);
+
+	return (DECOMP_BENCH_LOOPS * (size >> 10)) / msecs;
+}
+
+/*
+ * Compare gzip and LZ4 decompression speed on @data, the kernel image for
+ * example, or on made up text when there is none.
+ */
+static int run_decomp_bench(void *data, ulong size)
+{
+	unsigned char *buf = NULL, *comp_buf = NULL, *out = NULL;
+	ulong comp_size, comp_max, i, n, rate;
+	u32 h;
+	int ret;
+
+	printf(" decompression speed ...\n");
+
+	if (!data) {
+		size = DECOMP_BENCH_SIZE;
+		buf = malloc(size);
+		errcheck(buf != NULL);
+		/* runs of text and of one byte, in pseudo-random lengths */
+		for (i = 0; i < size; i += n) {
+			h = i * 2654435761u;
+			n = min(size - i, 16 + (ulong)(h >> 26));
+			if (h & 0x300)
+				memcpy(buf + i, plain + (h & 0xff), n);
+			else
+				memset(buf + i, h >> 16, n);
+		}
+		data = buf;
+	}
+
+	comp_max = size + size / 8 + 1024;
+	comp_buf = malloc(comp_max);
+	errcheck(comp_buf != NULL);
+	out = malloc(size);
+	errcheck(out != NULL);
+
+	comp_size = comp_max;
+	errcheck(compress_using_gzip(data, size, comp_buf, comp_max,
+				     &comp_size) == 0);
+	rate = decomp_bench(uncompress_using_gzip, comp_buf, comp_size, out,
+			    size);
+	errcheck(rate && memcmp(data, out, size) == 0);
+	printf("\tgzip %lu -> %lu bytes: %lu MB/s\n", size, comp_size, rate);
+
+	comp_size = comp_max;
+	errcheck(compress_using_lz4(data, size, comp_buf, comp_max,
+				    &comp_size) == 0);
+	rate = decomp_bench(uncompress_using_lz4, comp_buf, comp_size, out,
+			    size);
+	errcheck(rate && memcmp(data, out, size) == 0);
+	printf("\tlz4  %lu -> %lu bytes: %lu MB/s\n", size, comp_size, rate);
+
+	ret = 0;
+
+out:
+	printf(" decompression speed: %s\n", ret == 0 ? "ok" : "FAILED");
+
+	free(out);
+	free(comp_buf);
+	free(buf);
+
+	return ret;
+}
+
+/* Feed @in to @ds in pieces of @step bytes, returns the last feed result */
+static int stream_feed(struct decomp_stream *ds, const void *in, ulong len,
+		       ulong step)
+{
+	ulong done, n;
+	int ret = 0;
+
+	for (done = 0; !ret && done < len; done += n) {
+		n = min(step, len - done);
+		ret = decomp_stream_feed(ds, in + done, n);
+	}
+
+	return ret;
+}
+
+static int run_stream_test(char *name, int comp, mutate_func compress)
+{
+	static const ulong steps[] = { 1, 3, 17, 64, TEST_BUFFER_SIZE };
+	ulong orig_size, compressed_size, out_size;
+	void *compressed_buf = NULL;
+	char *out_buf = NULL;
+	struct decomp_stream ds;
+	int i, ret;
+
+	printf(" testing %s stream ...\n", name);
+
+	orig_size = strlen(plain);
+	compressed_size = TEST_BUFFER_SIZE;
+	compressed_buf = malloc(TEST_BUFFER_SIZE);
+	errcheck(compressed_buf != NULL);
+	out_buf = malloc(TEST_BUFFER_SIZE);
+	errcheck(out_buf != NULL);
+	errcheck(compress((void *)plain, orig_size, compressed_buf,
+			  compressed_size, &compressed_size) == 0);
+
+	/* Any split of the input gives the same output */
+	for (i = 0; i < ARRAY_SIZE(steps); i++) {
+		memset(out_buf, 'A', TEST_BUFFER_SIZE);
+		errcheck(decomp_stream_init(&ds, comp, out_buf,
+					    TEST_BUFFER_SIZE) == 0);
+		errcheck(stream_feed(&ds, compressed_buf, compressed_size,
+				     steps[i]) == 1);
+		errcheck(decomp_stream_finish(&ds, &out_size) == 0);
+		errcheck(out_size == orig_size);
+		errcheck(memcmp(plain, out_buf, orig_size) == 0);
+		errcheck(out_buf[orig_size] == 'A');
+	}
+	printf("\tany split decompresses\n");
+
+	/* Data ending early is an error */
+	errcheck(decomp_stream_init(&ds, comp, out_buf, TEST_BUFFER_SIZE) == 0);
+	errcheck(stream_feed(&ds, compressed_buf, compressed_size / 2, 17) == 0);
+	errcheck(decomp_stream_finish(&ds, &out_size) != 0);
+
+	/* Make sure decompression does not over-run */
+	memset(out_buf, 'A', TEST_BUFFER_SIZE);
+	errcheck(decomp_stream_init(&ds, comp, out_buf, orig_size - 1) == 0);
+	stream_feed(&ds, compressed_buf, compressed_size, 17);
+	errcheck(decomp_stream_finish(&ds, &out_size) != 0);
+	errcheck(out_buf[orig_size - 1] == 'A');
+	printf("\tstream does not overrun\n");
+
+	ret = 0;
+
+out:
+	printf(" %s stream: %s\n", name, ret == 0 ? "ok" : "FAILED");
+
+	free(out_buf);
+	free(compressed_buf);
+
+	return ret;
+}
+
+/* A gzip compressed legacy image is unpacked to an uncompressed one */
+static int run_stream_image_test(void)
+{
+	ulong orig_size, compressed_size, out_size;
+	image_header_t *hdr, *out_hdr;
+	struct decomp_stream ds;
+	char *buf = NULL;
+	char *out_buf = NULL;
+	int ret;
+
+	printf(" testing image stream ...\n");
+
+	orig_size = strlen(plain);
+	buf = malloc(TEST_BUFFER_SIZE);
+	errcheck(buf != NULL);
+	out_buf = malloc(TEST_BUFFER_SIZE);
+	errcheck(out_buf != NULL);
+
+	hdr = (image_header_t *)buf;
+	compressed_size = TEST_BUFFER_SIZE - sizeof(*hdr);
+	errcheck(compress_using_gzip((void *)plain, orig_size, hdr + 1,
+				     compressed_size, &compressed_size) == 0);
+	memset(hdr, 0, sizeof(*hdr));
+	image_set_magic(hdr, IH_MAGIC);
+	image_set_size(hdr, compressed_size);
+	image_set_type(hdr, IH_TYPE_KERNEL);
+	image_set_comp(hdr, IH_COMP_GZIP);
+	image_set_dcrc(hdr, crc32(0, (void *)(hdr + 1), compressed_size));
+	image_set_hcrc(hdr, crc32(0, (void *)hdr, sizeof(*hdr)));
+
+	errcheck(decomp_stream_init_image(&ds, out_buf, TEST_BUFFER_SIZE) == 0);
+	errcheck(stream_feed(&ds, buf, sizeof(*hdr) + compressed_size, 7) == 1);
+	errcheck(decomp_stream_finish(&ds, &out_size) == 0);
+	errcheck(out_size == sizeof(*hdr) + orig_size);
+
+	out_hdr = (image_header_t *)out_buf;
+	errcheck(image_check_magic(out_hdr));
+	errcheck(image_check_hcrc(out_hdr));
+	errcheck(image_get_comp(out_hdr) == IH_COMP_NONE);
+	errcheck(image_get_data_size(out_hdr) == orig_size);
+	errcheck(image_check_dcrc(out_hdr));
+	errcheck(memcmp(plain, out_hdr + 1, orig_size) == 0);
+
+	/* A corrupted payload fails the data CRC */
+	buf[sizeof(*hdr) + compressed_size - 1] ^= 1;
+	errcheck(decomp_stream_init_image(&ds, out_buf, TEST_BUFFER_SIZE) == 0);
+	stream_feed(&ds, buf, sizeof(*hdr) + compressed_size, 64);
+	errcheck(decomp_stream_finish(&ds, &out_size) != 0);
+
+	/* Raw gzip data is recognised, other data copied */
+	errcheck(decomp_stream_init_image(&ds, out_buf, TEST_BUFFER_SIZE) == 0);
+	stream_feed(&ds, hdr + 1, compressed_size, 5);
+	errcheck(decomp_stream_finish(&ds, &out_size) == 0);
+	errcheck(out_size == orig_size);
+	errcheck(memcmp(plain, out_buf, orig_size) == 0);
+
+	errcheck(decomp_stream_init_image(&ds, out_buf, TEST_BUFFER_SIZE) == 0);
+	errcheck(stream_feed(&ds, plain, 10, 3) == 0);
+	errcheck(decomp_stream_finish(&ds, &out_size) == 0);
+	errcheck(out_size == 10);
+	errcheck(memcmp(plain, out_buf, 10) == 0);
+
+	ret = 0;
+
+out:
+	printf(" image stream: %s\n", ret == 0 ? "ok" : "FAILED");
+
+	free(out_buf);
+	free(buf);
+
+	return ret;
+}
 
 static int do_test_compression(cmd_tbl_t *cmdtp, int flag, int argc,
 			       char * const argv[])
 {
+	void *data = NULL;
+	ulong size = 0;
 	int err = 0;
 
+	if (argc == 3) {
+		size = simple_strtoul(argv[2], NULL, 16);
+		data = map_sysmem(simple_strtoul(argv[1], NULL, 16), size);
+	} else if (argc != 1) {
+		return CMD_RET_USAGE;
+	}
+
 	err += run_test("gzip", compress_using_gzip, uncompress_using_gzip);
 	err += run_test("bzip2", compress_using_bzip2, uncompress_using_bzip2);
 	err += run_test("lzma", compress_using_lzma, uncompress_using_lzma);
 	err += run_test("lzo", compress_using_lzo, uncompress_using_lzo);
+	err += run_test("lz4", compress_using_lz4, uncompress_using_lz4);
+	err += run_match_copy_test();
+	err += run_crc32_test();
+	err += run_stream_test("gzip", IH_COMP_GZIP, compress_using_gzip);
+	err += run_stream_test("lzma", IH_COMP_LZMA, compress_using_lzma);
+	err += run_stream_test("lzo", IH_COMP_LZO, compress_using_lzo);
+	err += run_stream_image_test();
+	err += run_decomp_bench(data, size);
 
 	printf("test_compression %s\n", err == 0 ? "ok" : "FAILED");
 
@@ -330,6 +810,9 @@ static int do_test_compression(cmd_tbl_t *cmdtp, int flag, int argc,
 }
 
 U_BOOT_CMD(
-	test_compression,	5,	1,	do_test_compression,
-	"Basic test of compressors: gzip bzip2 lzma lzo", ""
+	test_compression,	3,	1,	do_test_compression,
+	"Basic test of compressors: gzip bzip2 lzma lzo lz4, crc32 and streams",
+	"[addr len]\n"
+	"    - also compare gzip and lz4 decompression speed on the image at\n"
+	"      addr, a kernel for example, instead of on made up data"
 );
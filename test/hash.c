@@ -0,0 +1,189 @@
+/*
+ * SHA-1/SHA-256 known-answer tests and hash throughput
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+#include <common.h>
+#include <command.h>
+#include <hash.h>
+#include <malloc.h>
+#include <u-boot/sha1.h>
+#include <u-boot/sha256.h>
+
+#define TEST_BUFFER_SIZE	(4 << 20)
+#define MILLION_A		1000000
+
+#define errcheck(statement) if (!(statement)) { \
+	fprintf(stderr, "\tFailed: %s\n", #statement); \
+	ret = 1; \
+	goto out; \
+}
+
+/* FIPS 180-2 appendices A and B: "abc", two blocks, a million 'a's */
+static const char *const vector_msg[] = {
+	"abc",
+	"abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq",
+	NULL,
+};
+
+static const u8 sha1_sum[][SHA1_SUM_LEN] = {
+	{ 0xa9, 0x99, 0x3e, 0x36, 0x47, 0x06, 0x81, 0x6a, 0xba, 0x3e,
+	  0x25, 0x71, 0x78, 0x50, 0xc2, 0x6c, 0x9c, 0xd0, 0xd8, 0x9d, },
+	{ 0x84, 0x98, 0x3e, 0x44, 0x1c, 0x3b, 0xd2, 0x6e, 0xba, 0xae,
+	  0x4a, 0xa1, 0xf9, 0x51, 0x29, 0xe5, 0xe5, 0x46, 0x70, 0xf1, },
+	{ 0x34, 0xaa, 0x97, 0x3c, 0xd4, 0xc4, 0xda, 0xa4, 0xf6, 0x1e,
+	  0xeb, 0x2b, 0xdb, 0xad, 0x27, 0x31, 0x65, 0x34, 0x01, 0x6f, },
+};
+
+static const u8 sha256_sum[][SHA256_SUM_LEN] = {
+	{ 0xba, 0x78, 0x16, 0xbf, 0x8f, 0x01, 0xcf, 0xea,
+	  0x41, 0x41, 0x40, 0xde, 0x5d, 0xae, 0x22, 0x23,
+	  0xb0, 0x03, 0x61, 0xa3, 0x96, 0x17, 0x7a, 0x9c,
+	  0xb4, 0x10, 0xff, 0x61, 0xf2, 0x00, 0x15, 0xad, },
+	{ 0x24, 0x8d, 0x6a, 0x61, 0xd2, 0x06, 0x38, 0xb8,
+	  0xe5, 0xc0, 0x26, 0x93, 0x0c, 0x3e, 0x60, 0x39,
+	  0xa3, 0x3c, 0xe4, 0x59, 0x64, 0xff, 0x21, 0x67,
+	  0xf6, 0xec, 0xed, 0xd4, 0x19, 0xdb, 0x06, 0xc1, },
+	{ 0xcd, 0xc7, 0x6e, 0x5c, 0x99, 0x14, 0xfb, 0x92,
+	  0x81, 0xa1, 0xc7, 0xe2, 0x84, 0xd7, 0x3e, 0x67,
+	  0xf1, 0x80, 0x9a, 0x48, 0xa4, 0x97, 0x20, 0x0e,
+	  0x04, 0x6d, 0x39, 0xcc, 0xc7, 0x11, 0x2c, 0xd0, },
+};
+
+/*
+ * Check one algorithm through the hash_algo table: the FIPS vectors, every
+ * split of a buffer into two updates, unaligned input, hash_copy() and each
+ * of its block backends
+ */
+static int run_hash_test(const char *name, const u8 *sums, int sum_len,
+			 u8 *buf, u8 *copy)
+{
+	const struct hash_backend *be, *c;
+	struct hash_algo *algo;
+	struct hash_copy_op op;
+	u8 whole[32], part[32];
+	ulong start, msecs;
+	const u8 *msg;
+	uint len;
+	int i, ret;
+	void *ctx;
+
+	printf(" testing %s ...\n", name);
+	errcheck(hash_lookup_algo(name, &algo) == 0);
+	errcheck(algo->digest_size == sum_len);
+
+	for (i = 0; i < ARRAY_SIZE(vector_msg); i++) {
+		if (vector_msg[i]) {
+			msg = (const u8 *)vector_msg[i];
+			len = strlen(vector_msg[i]);
+		} else {
+			memset(copy, 'a', MILLION_A);
+			msg = copy;
+			len = MILLION_A;
+		}
+		algo->hash_func_ws(msg, len, whole, algo->chunk_size);
+		errcheck(memcmp(whole, sums + i * sum_len, sum_len) == 0);
+	}
+	printf("\tFIPS 180-2 vectors ok\n");
+
+	for (i = 0; i < 4096; i++)
+		buf[i] = i * 7 + (i >> 8);
+	algo->hash_func_ws(buf, 4096, whole, algo->chunk_size);
+
+	/* Buffered partial blocks must not change the result */
+	for (i = 0; i <= 300; i++) {
+		errcheck(algo->hash_init(algo, &ctx) == 0);
+		algo->hash_update(algo, ctx, buf, i, 0);
+		algo->hash_update(algo, ctx, buf + i, 4096 - i, 1);
+		errcheck(algo->hash_finish(algo, ctx, part, sizeof(part)) == 0);
+		errcheck(memcmp(whole, part, sum_len) == 0);
+	}
+
+	/* Unaligned input */
+	for (i = 1; i < 8; i++) {
+		memcpy(copy + i, buf, 4096);
+		algo->hash_func_ws(copy + i, 4096, part, algo->chunk_size);
+		errcheck(memcmp(whole, part, sum_len) == 0);
+	}
+	printf("\tsplit and unaligned updates ok\n");
+
+	for (i = 0; i < TEST_BUFFER_SIZE; i++)
+		buf[i] = i * 13 + (i >> 12);
+	algo->hash_func_ws(buf, TEST_BUFFER_SIZE, whole, algo->chunk_size);
+	op.algo = algo;
+	errcheck(algo->hash_init(algo, &op.ctx) == 0);
+	ret = hash_copy(copy, buf, TEST_BUFFER_SIZE - 3, &op, 1);
+	ret |= hash_copy(copy + TEST_BUFFER_SIZE - 3,
+			 buf + TEST_BUFFER_SIZE - 3, 3, &op, 1);
+	errcheck(algo->hash_finish(algo, op.ctx, part, sizeof(part)) == 0);
+	errcheck(ret == 0);
+	errcheck(memcmp(whole, part, sum_len) == 0);
+	errcheck(memcmp(copy, buf, TEST_BUFFER_SIZE) == 0);
+	printf("\thash_copy() ok\n");
+
+	/* Every backend this CPU can run must agree with the C one */
+	errcheck(algo->backends);
+	for (c = algo->backends; c->usable; c++)
+		;
+	errcheck(algo->hash_init(algo, &ctx) == 0);
+	c->blocks(ctx, buf + 1, TEST_BUFFER_SIZE / 64 - 1);
+	errcheck(algo->hash_finish(algo, ctx, whole, sizeof(whole)) == 0);
+	for (be = algo->backends; be <= c; be++) {
+		if (be->usable && !be->usable()) {
+			printf("\t%s blocks: not usable\n", be->name);
+			continue;
+		}
+		errcheck(algo->hash_init(algo, &ctx) == 0);
+		start = get_timer(0);
+		be->blocks(ctx, buf + 1, TEST_BUFFER_SIZE / 64 - 1);
+		msecs = max(get_timer(start), 1UL);
+		errcheck(algo->hash_finish(algo, ctx, part, sizeof(part)) == 0);
+		errcheck(memcmp(whole, part, sum_len) == 0);
+		printf("\t%s blocks: %lu MB/s\n", be->name,
+		       (TEST_BUFFER_SIZE >> 10) / msecs);
+	}
+
+	start = get_timer(0);
+	algo->hash_func_ws(buf, TEST_BUFFER_SIZE, part, algo->chunk_size);
+	msecs = max(get_timer(start), 1UL);
+
+	/* KiB per millisecond is close enough to MB/s */
+	printf("\t%s: %lu MB/s\n", name, (TEST_BUFFER_SIZE >> 10) / msecs);
+
+	ret = 0;
+out:
+	return ret;
+}
+
+static int do_test_hash(cmd_tbl_t *cmdtp, int flag, int argc,
+			char * const argv[])
+{
+	u8 *buf, *copy;
+	int ret = 0;
+
+	buf = malloc(TEST_BUFFER_SIZE);
+	copy = malloc(TEST_BUFFER_SIZE);
+	if (!buf || !copy) {
+		puts("Out of memory\n");
+		ret = 1;
+		goto out;
+	}
+
+	ret |= run_hash_test("sha1", sha1_sum[0], SHA1_SUM_LEN, buf, copy);
+	ret |= run_hash_test("sha256", sha256_sum[0], SHA256_SUM_LEN, buf,
+			     copy);
+
+out:
+	printf("test_hash %s\n", ret == 0 ? "ok" : "FAILED");
+
+	free(copy);
+	free(buf);
+
+	return ret;
+}
+
+U_BOOT_CMD(
+	test_hash,	1,	1,	do_test_hash,
+	"Test SHA-1/SHA-256 vectors and benchmark the hashes", ""
+);
@@ -44,6 +44,9 @@ base_its = '''
                         compression = "none";
                         load = <0x40000>;
                         entry = <0x8>;
+                        hash@1 {
+                                algo = "sha1";
+                        };
                 };
                 fdt@1 {
                         description = "snow";
@@ -272,7 +275,8 @@ def run_fit_test(mkimage, u_boot):
     """Basic sanity check of FIT loading in U-Boot
 
     TODO: Almost everything:
-       - hash algorithms - invalid hash/contents should be detected
+       - hash algorithms - invalid hash/contents should be detected for
+         images other than the kernel
        - signature algorithms - invalid sig/contents should be detected
        - compression
        - checking that errors are detected like:
@@ -368,6 +372,30 @@ def run_fit_test(mkimage, u_boot):
     if read_file(ramdisk) != read_file(ramdisk_out):
         fail('Ramdisk not loaded', stdout)
 
+    # The kernel moves to its load address and is checked on the way there,
+    # so a kernel which does not match its hash must not be loaded
+    set_test('Kernel with bad hash')
+    data = read_file(fit)
+    pos = data.find('this kernel 50 ')
+    with open(fit, 'w') as fd:
+        fd.write(data[:pos] + 'T' + data[pos + 1:])
+    os.remove(kernel_out)
+    stdout = command.Output(u_boot, '-d', control_dtb, '-c', cmd)
+    if 'Bad Data Hash' not in stdout:
+        fail('Bad kernel hash not detected', stdout)
+    # 'bootm loados' fails, which ends the script before anything is saved
+    if os.path.exists(kernel_out):
+        fail('Kernel loaded but should not be', stdout)
+
+    # A good kernel still goes through
+    set_test('Kernel with good hash')
+    fit = make_fit(mkimage, params)
+    stdout = command.Output(u_boot, '-d', control_dtb, '-c', cmd)
+    if 'Bad Data Hash' in stdout:
+        fail('Good kernel hash rejected', stdout)
+    if read_file(kernel) != read_file(kernel_out):
+        fail('Kernel not loaded', stdout)
+
 def run_tests():
     """Parse options, run the FIT tests and print the result"""
     global base_path, base_dir
@@ -0,0 +1,333 @@
+/*
+ * NFS test: load a file from an NFSv2 server stand-in behind a fake
+ * ethernet device with a simulated round trip time, one READ at a time
+ * and with a window of READs in flight. The server can answer a READ
+ * out of order and lose one reply to check the xid matching and the
+ * resend of what is still outstanding.
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+#include <common.h>
+#include <command.h>
+#include <malloc.h>
+#include <net.h>
+#include <asm/errno.h>
+#include <asm/io.h>
+#include "../net/nfs.h"
+
+#define TEST_ADDR		0x1000000
+#define TEST_SIZE		(256 << 10)
+#define TEST_RTT_US		1000
+
+#define MOUNT_PORT		635
+#define NFS_PORT		2049
+#define SERVER_QUEUE		64
+
+static const uchar server_ether[6] = { 0x02, 0x00, 0x00, 0x00, 0x00, 0x01 };
+static const uchar client_ether[6] = { 0x02, 0x00, 0x00, 0x00, 0x00, 0x02 };
+
+struct server_pkt {
+	ulong due;
+	int len;
+	uchar data[PKTSIZE_ALIGN];
+};
+
+struct nfs_server {
+	IPaddr_t ip;
+	uchar *file;
+	ulong size;
+	ulong reads;		/* READ calls answered */
+	ulong drop;		/* lose the reply to this READ call, once */
+	ulong late;		/* delay the reply to this READ call, once */
+	/* packets on the wire, delivered after TEST_RTT_US */
+	struct server_pkt *queue;
+	int head, tail;
+};
+
+static struct nfs_server server;
+
+static struct server_pkt *server_queue(int len, ulong delay)
+{
+	struct server_pkt *pkt = &server.queue[server.tail];
+
+	server.tail = (server.tail + 1) % SERVER_QUEUE;
+	if (server.tail == server.head)
+		panic("nfs server queue overflow");
+
+	pkt->due = timer_get_us() + delay;
+	pkt->len = ETHER_HDR_SIZE + len;
+	memcpy(pkt->data, client_ether, 6);
+	memcpy(pkt->data + 6, server_ether, 6);
+
+	return pkt;
+}
+
+/* Queue an RPC reply with 'len' bytes of results and return them */
+static uint32_t *server_reply(struct ip_udp_hdr *call, int len, ulong delay)
+{
+	struct rpc_t *rpc = (struct rpc_t *)(call + 1);
+	struct server_pkt *pkt;
+	struct ip_udp_hdr *ip;
+	struct rpc_t *reply;
+
+	len += sizeof(reply->u.reply) - sizeof(reply->u.reply.data);
+	pkt = server_queue(IP_UDP_HDR_SIZE + len, delay);
+	((struct ethernet_hdr *)pkt->data)->et_protlen = htons(PROT_IP);
+	ip = (struct ip_udp_hdr *)(pkt->data + ETHER_HDR_SIZE);
+	ip->ip_hl_v = 0x45;
+	ip->ip_tos = 0;
+	ip->ip_len = htons(IP_UDP_HDR_SIZE + len);
+	ip->ip_id = 0;
+	ip->ip_off = htons(IP_FLAGS_DFRAG);
+	ip->ip_ttl = 255;
+	ip->ip_p = IPPROTO_UDP;
+	ip->ip_sum = 0;
+	NetCopyIP(&ip->ip_src, &server.ip);
+	NetCopyIP(&ip->ip_dst, &NetOurIP);
+	ip->ip_sum = ~NetCksum((uchar *)ip, IP_HDR_SIZE >> 1);
+	ip->udp_src = call->udp_dst;
+	ip->udp_dst = call->udp_src;
+	ip->udp_len = htons(UDP_HDR_SIZE + len);
+	ip->udp_xsum = 0;
+
+	reply = (struct rpc_t *)(ip + 1);
+	memset(reply, 0, len);
+	reply->u.reply.id = rpc->u.call.id;
+	reply->u.reply.type = htonl(MSG_REPLY);
+
+	return reply->u.reply.data;
+}
+
+/* NFSv2 fattr, only the size matters to U-Boot */
+static uint32_t *server_fattr(uint32_t *p)
+{
+	p[0] = htonl(1);	/* NFREG */
+	p[5] = htonl(server.size);
+	return p + 17;
+}
+
+static void server_rpc(struct ip_udp_hdr *ip)
+{
+	struct rpc_t *rpc = (struct rpc_t *)(ip + 1);
+	uint32_t *args = rpc->u.call.data;
+	ulong offset, count, delay = TEST_RTT_US;
+	uint32_t *p;
+
+	/* skip the credential and the verifier */
+	args += 2 + (ntohl(args[1]) + 3) / 4;
+	args += 2 + (ntohl(args[1]) + 3) / 4;
+
+	switch (ntohl(rpc->u.call.prog) << 8 | ntohl(rpc->u.call.proc)) {
+	case PROG_PORTMAP << 8 | PORTMAP_GETPORT:
+		p = server_reply(ip, 4, delay);
+		*p = htonl(ntohl(args[0]) == PROG_MOUNT ? MOUNT_PORT :
+			   NFS_PORT);
+		break;
+	case PROG_MOUNT << 8 | MOUNT_ADDENTRY:
+		/* status and the directory handle */
+		server_reply(ip, 4 + NFS_FHSIZE, delay);
+		break;
+	case PROG_MOUNT << 8 | MOUNT_UMOUNTALL:
+		server_reply(ip, 0, delay);
+		break;
+	case PROG_NFS << 8 | NFS_LOOKUP:
+		p = server_reply(ip, 4 + NFS_FHSIZE + 17 * 4, delay);
+		server_fattr(p + 1 + NFS_FHSIZE / 4);
+		break;
+	case PROG_NFS << 8 | NFS_READ:
+		offset = ntohl(args[NFS_FHSIZE / 4]);
+		count = ntohl(args[NFS_FHSIZE / 4 + 1]);
+		offset = min(offset, server.size);
+		count = min(count, server.size - offset);
+
+		if (++server.reads == server.drop)
+			break;
+		if (server.reads == server.late)
+			delay += TEST_RTT_US;
+		p = server_reply(ip, 4 + 17 * 4 + 4 + ALIGN(count, 4), delay);
+		p = server_fattr(p + 1);
+		*p++ = htonl(count);
+		memcpy(p, server.file + offset, count);
+		break;
+	}
+}
+
+static int server_send(struct eth_device *dev, void *packet, int length)
+{
+	struct ethernet_hdr *et = packet;
+	struct ip_udp_hdr *ip;
+	struct arp_hdr *arp;
+	uchar *pkt;
+
+	switch (ntohs(et->et_protlen)) {
+	case PROT_ARP:
+		arp = (struct arp_hdr *)(et + 1);
+		if (ntohs(arp->ar_op) != ARPOP_REQUEST ||
+		    NetReadIP(&arp->ar_tpa) != server.ip)
+			break;
+		pkt = server_queue(ARP_HDR_SIZE, TEST_RTT_US)->data;
+		((struct ethernet_hdr *)pkt)->et_protlen = htons(PROT_ARP);
+		pkt += ETHER_HDR_SIZE;
+		memcpy(pkt, arp, ARP_HDR_SIZE);
+		arp = (struct arp_hdr *)pkt;
+		arp->ar_op = htons(ARPOP_REPLY);
+		memcpy(&arp->ar_tha, &arp->ar_sha, ARP_HLEN + ARP_PLEN);
+		memcpy(&arp->ar_sha, server_ether, ARP_HLEN);
+		NetWriteIP(&arp->ar_spa, server.ip);
+		break;
+
+	case PROT_IP:
+		ip = (struct ip_udp_hdr *)(et + 1);
+		if (ip->ip_p == IPPROTO_UDP)
+			server_rpc(ip);
+		break;
+	}
+
+	return 0;
+}
+
+static int server_recv_pkt(struct eth_device *dev, uchar **packetp)
+{
+	struct server_pkt *pkt;
+	int i;
+
+	/* hand out the first packet that is due, delayed ones stay behind */
+	for (i = server.head; i != server.tail; i = (i + 1) % SERVER_QUEUE) {
+		pkt = &server.queue[i];
+		if ((long)(timer_get_us() - pkt->due) >= 0)
+			break;
+	}
+	if (i == server.tail)
+		return -EAGAIN;
+
+	/* move it to the head, that is where server_free_pkt() frees */
+	if (i != server.head) {
+		struct server_pkt tmp = server.queue[i];
+
+		for (; i != server.head; i = (i + SERVER_QUEUE - 1) %
+		     SERVER_QUEUE)
+			server.queue[i] = server.queue[(i + SERVER_QUEUE - 1) %
+						       SERVER_QUEUE];
+		server.queue[server.head] = tmp;
+	}
+	*packetp = server.queue[server.head].data;
+
+	return server.queue[server.head].len;
+}
+
+static int server_free_pkt(struct eth_device *dev, uchar *packet, int length)
+{
+	server.head = (server.head + 1) % SERVER_QUEUE;
+
+	return 0;
+}
+
+static int server_recv(struct eth_device *dev)
+{
+	return 0;
+}
+
+static int server_init(struct eth_device *dev, bd_t *bis)
+{
+	server.head = server.tail = 0;
+
+	return 0;
+}
+
+static void server_halt(struct eth_device *dev)
+{
+}
+
+static int test_nfs_get(const char *what, int window, ulong drop, ulong late)
+{
+	ulong start, us;
+	char cmd[64];
+	int ret;
+
+	server.reads = 0;
+	server.drop = drop;
+	server.late = late;
+	setenv_ulong("nfsreadwindow", window);
+	memset(map_sysmem(TEST_ADDR, TEST_SIZE), 0, TEST_SIZE);
+
+	start = timer_get_us();
+	sprintf(cmd, "nfs %x /export/test.bin", TEST_ADDR);
+	ret = run_command(cmd, 0);
+	us = timer_get_us() - start;
+
+	if (ret || getenv_hex("filesize", 0) != TEST_SIZE) {
+		printf("\tFailed: %s download\n", what);
+		return 1;
+	}
+	if (memcmp(map_sysmem(TEST_ADDR, TEST_SIZE), server.file, TEST_SIZE)) {
+		printf("\tFailed: %s data mismatch\n", what);
+		return 1;
+	}
+
+	printf("%s: %lu READs, %lu KiB/s\n", what, server.reads,
+	       us ? (ulong)((u64)TEST_SIZE * 1000000 / 1024 / us) : 0);
+
+	return 0;
+}
+
+static int do_test_nfs(cmd_tbl_t *cmdtp, int flag, int argc,
+		       char * const argv[])
+{
+	struct eth_device *dev;
+	int i, ret = 1;
+
+	dev = calloc(1, sizeof(*dev));
+	server.file = malloc(TEST_SIZE);
+	server.queue = malloc(SERVER_QUEUE * sizeof(*server.queue));
+	if (!dev || !server.file || !server.queue)
+		goto out;
+
+	for (i = 0; i < TEST_SIZE; i++)
+		server.file[i] = i ^ (i >> 10);
+	server.size = TEST_SIZE;
+	server.ip = string_to_ip("192.168.1.1");
+
+	strcpy(dev->name, "nfs-sb");
+	memcpy(dev->enetaddr, client_ether, 6);
+	dev->init = server_init;
+	dev->send = server_send;
+	dev->recv = server_recv;
+	dev->recv_pkt = server_recv_pkt;
+	dev->free_pkt = server_free_pkt;
+	dev->halt = server_halt;
+	eth_register(dev);
+
+	setenv("ethact", dev->name);
+	if (!getenv("ethaddr"))
+		setenv("ethaddr", "02:00:00:00:00:02");
+	setenv("ipaddr", "192.168.1.2");
+	setenv("serverip", "192.168.1.1");
+	setenv("autostart", "no");
+
+	if (test_nfs_get("1 READ in flight", 1, 0, 0) ||
+	    test_nfs_get("8 READs in flight", 8, 0, 0) ||
+	    test_nfs_get("8 READs, one late", 8, 0, 20) ||
+	    test_nfs_get("8 READs, one lost", 8, 30, 0))
+		goto unregister;
+
+	ret = 0;
+unregister:
+	eth_halt();
+	eth_unregister(dev);
+	setenv("ethact", NULL);
+	setenv("nfsreadwindow", NULL);
+out:
+	printf("test_nfs %s\n", ret == 0 ? "ok" : "FAILED");
+	free(server.queue);
+	free(server.file);
+	free(dev);
+
+	return ret;
+}
+
+U_BOOT_CMD(
+	test_nfs,	1,	1,	do_test_nfs,
+	"Load a file from an NFS server stand-in with and without a READ window",
+	""
+);
@@ -0,0 +1,448 @@
+/*
+ * RSA signature check with 2048 and 4096 bit keys, and its speed
+ *
+ * The keys and signatures were made for this test. Each key has a
+ * signature of msg[] with the usual exponent 65537 and one with a 64-bit
+ * exponent, which takes the windowed path through the exponentiation.
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+#include <common.h>
+#include <command.h>
+#include <malloc.h>
+#include <image.h>
+#include <libfdt.h>
+#include <u-boot/rsa.h>
+
+#define RSA_E64			0xd6c0c1d2a9b2e41bULL
+#define RSA_BENCH_LOOPS		50
+
+#define errcheck(statement) if (!(statement)) { \
+	fprintf(stderr, "\tFailed: %s\n", #statement); \
+	ret = 1; \
+	goto out; \
+}
+
+static const char msg[] = "The quick brown fox jumps over the lazy dog";
+
+/* RSA-2048 key */
+static const u8 rsa2048_modulus[] = {
+	0xc1, 0xdc, 0x9d, 0x6d, 0xaa, 0x58, 0x99, 0xad, 0xef, 0x83, 0xe1, 0xf4,
+	0xf6, 0xc8, 0xff, 0xd4, 0x2d, 0x45, 0x68, 0x12, 0xd1, 0x21, 0xdd, 0x3d,
+	0xf7, 0xea, 0x4a, 0xb7, 0x44, 0x11, 0x31, 0xbf, 0xfe, 0x53, 0x16, 0x27,
+	0x59, 0xd9, 0x64, 0x67, 0x20, 0xe3, 0x1d, 0x57, 0xd4, 0x43, 0xe9, 0xe2,
+	0x29, 0xcf, 0x0f, 0x61, 0xac, 0xc4, 0x1f, 0x21, 0x37, 0xe7, 0xc2, 0xc4,
+	0x7e, 0xab, 0x65, 0x1e, 0x8a, 0xb5, 0x4f, 0x24, 0xbd, 0x81, 0xd1, 0xb5,
+	0x10, 0x67, 0x01, 0xe4, 0x89, 0x8b, 0x1f, 0x96, 0x5c, 0x63, 0xe8, 0x40,
+	0xe1, 0x34, 0x78, 0x56, 0x56, 0x76, 0x53, 0xcf, 0x15, 0x80, 0xd5, 0x9e,
+	0x10, 0xd5, 0xfe, 0x27, 0xe3, 0x53, 0xe2, 0x3c, 0xe6, 0xa6, 0x08, 0x38,
+	0x45, 0x43, 0xde, 0xf2, 0x53, 0x25, 0x42, 0x43, 0xd1, 0xba, 0x25, 0xd0,
+	0x91, 0xb8, 0xf5, 0x81, 0xca, 0xb9, 0xd4, 0xf7, 0xac, 0xdc, 0x72, 0x07,
+	0x65, 0xd3, 0x65, 0x34, 0xad, 0x25, 0x87, 0x70, 0xa4, 0x6e, 0x91, 0x26,
+	0xc2, 0x18, 0x00, 0x63, 0x29, 0x8f, 0xf9, 0x35, 0x6b, 0x10, 0x2e, 0x20,
+	0x01, 0x60, 0x9f, 0x2c, 0x84, 0x53, 0xe2, 0xf3, 0x0b, 0xcf, 0x27, 0x34,
+	0x96, 0xb4, 0xfd, 0x15, 0x36, 0xc9, 0x07, 0xb0, 0x0a, 0xff, 0x48, 0xd2,
+	0x1d, 0x23, 0xf4, 0xfc, 0x53, 0xeb, 0xd5, 0xbc, 0xb5, 0xbc, 0xd1, 0x5e,
+	0xac, 0xa7, 0x55, 0x4d, 0xa5, 0x38, 0xeb, 0x33, 0xa1, 0x06, 0x93, 0xd7,
+	0x78, 0xc3, 0x0e, 0xa1, 0x61, 0x9a, 0x6c, 0xd8, 0x3e, 0xbf, 0x14, 0x6f,
+	0x08, 0xda, 0xc0, 0x55, 0x5e, 0xd0, 0xb7, 0x22, 0xcc, 0xfb, 0xc3, 0xd6,
+	0x48, 0xb2, 0xe5, 0x00, 0x51, 0xbf, 0x36, 0xb8, 0x40, 0x02, 0xe5, 0x84,
+	0x9f, 0x93, 0xa9, 0x75, 0x72, 0x32, 0x69, 0xe5, 0xd3, 0x1b, 0x23, 0xf4,
+	0xcf, 0xb0, 0x5b, 0x63,
+};
+
+static const u8 rsa2048_rr[] = {
+	0x41, 0x8b, 0x11, 0x64, 0xa7, 0xda, 0x93, 0x8a, 0x39, 0xf5, 0x4e, 0x9b,
+	0x8e, 0x8d, 0x6b, 0x42, 0x63, 0xc3, 0x59, 0xdd, 0x34, 0xc3, 0x6c, 0x88,
+	0xd5, 0x3d, 0x3b, 0x3a, 0x7f, 0x00, 0x5f, 0xc7, 0x48, 0x04, 0x0d, 0x4a,
+	0xed, 0xee, 0xb8, 0x2f, 0x0e, 0x61, 0xc7, 0xbe, 0x06, 0xcc, 0x22, 0x1a,
+	0x2c, 0xd9, 0x31, 0xe5, 0x1c, 0xd6, 0xea, 0xb2, 0x3f, 0x0f, 0x9a, 0x5a,
+	0x27, 0xa2, 0x4c, 0x10, 0xcc, 0x38, 0x4c, 0x26, 0x18, 0xd8, 0x84, 0xdb,
+	0x65, 0xff, 0xc9, 0x7b, 0x18, 0xe7, 0x21, 0xf7, 0xc9, 0xda, 0x6b, 0x72,
+	0x3a, 0x45, 0x8d, 0x7c, 0x7e, 0x7b, 0xe2, 0xae, 0xa9, 0x44, 0x2a, 0x25,
+	0x16, 0x44, 0x03, 0xc3, 0x8f, 0xef, 0x87, 0x6c, 0xca, 0xf4, 0x4b, 0x8c,
+	0x7f, 0x2d, 0x2b, 0xf6, 0x94, 0xf8, 0x28, 0x12, 0x18, 0x3b, 0xe2, 0x72,
+	0x01, 0x12, 0x9f, 0x81, 0x3d, 0x4f, 0x25, 0xd4, 0x7e, 0x3d, 0x1d, 0x76,
+	0x78, 0x49, 0xfc, 0xa6, 0x5e, 0xff, 0xa7, 0x8e, 0x0a, 0xb6, 0x95, 0x4a,
+	0xa4, 0x95, 0x0a, 0x48, 0xe4, 0xe4, 0x95, 0xb7, 0x3f, 0xf5, 0x3f, 0x54,
+	0x6e, 0xe2, 0xfb, 0x1a, 0xe7, 0xc1, 0xce, 0x6a, 0x30, 0x43, 0xed, 0xc9,
+	0x7c, 0x69, 0xca, 0x63, 0xc9, 0x31, 0x2a, 0x04, 0x55, 0x4b, 0x4a, 0x3e,
+	0x09, 0xa7, 0xb2, 0x5e, 0xde, 0x60, 0xbe, 0xec, 0x32, 0xf6, 0x29, 0x4f,
+	0x99, 0x3c, 0xc0, 0x15, 0x33, 0x87, 0x14, 0x66, 0xa5, 0x58, 0x40, 0xda,
+	0xa0, 0x6d, 0xb6, 0x55, 0xf0, 0x77, 0x80, 0xe6, 0xae, 0x8d, 0x83, 0xd3,
+	0x3a, 0x90, 0x64, 0xb1, 0x00, 0x7a, 0xe4, 0x9d, 0x58, 0x88, 0xac, 0x00,
+	0xeb, 0xf0, 0x9f, 0x43, 0xb0, 0xc5, 0xc3, 0x4b, 0x2f, 0x16, 0x2b, 0xe1,
+	0x63, 0x02, 0xe3, 0xeb, 0xae, 0x75, 0x3f, 0x17, 0xfa, 0xa3, 0xa6, 0xbb,
+	0x3e, 0xe8, 0xf7, 0xec,
+};
+
+static const u8 rsa2048_sig[] = {
+	0xad, 0x44, 0xa3, 0xc4, 0x2a, 0xdd, 0x6d, 0xca, 0x47, 0x0e, 0x1a, 0x5f,
+	0x81, 0xf2, 0xe1, 0x54, 0xda, 0x4e, 0x14, 0x6a, 0xaf, 0xb2, 0xa1, 0x3c,
+	0xf8, 0x50, 0x58, 0x13, 0x5a, 0x29, 0x63, 0xe5, 0xfb, 0xc0, 0x94, 0xa9,
+	0x1a, 0x43, 0x21, 0x76, 0x28, 0x66, 0x1f, 0xa9, 0x5f, 0x43, 0xc5, 0x9d,
+	0x8f, 0x7a, 0x21, 0x9f, 0x2a, 0xad, 0x04, 0xe4, 0x61, 0x13, 0x10, 0x3d,
+	0x5d, 0xb5, 0xce, 0x49, 0x8b, 0xf5, 0xfa, 0x69, 0xc1, 0xb4, 0x3a, 0xf0,
+	0xd5, 0x69, 0xee, 0x05, 0x14, 0x63, 0x3b, 0x3e, 0xb2, 0x65, 0xd8, 0xc4,
+	0xb5, 0x4f, 0x81, 0x6e, 0x4d, 0x84, 0x6a, 0xf4, 0xc8, 0xd5, 0xe1, 0x35,
+	0x99, 0x17, 0xca, 0xbf, 0xc4, 0x6e, 0x01, 0x29, 0x8c, 0x1b, 0x5c, 0xcf,
+	0x74, 0xd3, 0xd1, 0x92, 0x42, 0xbc, 0x4d, 0xb2, 0x8f, 0x8f, 0x56, 0x31,
+	0xc5, 0x3e, 0x00, 0x29, 0x41, 0x04, 0xb4, 0x8a, 0x1a, 0x2b, 0x48, 0x69,
+	0x8b, 0x28, 0xba, 0x61, 0xcf, 0x8b, 0x15, 0x31, 0x61, 0x70, 0xc3, 0x9b,
+	0x6d, 0x0f, 0xf2, 0x1a, 0x2c, 0x7d, 0x08, 0xb2, 0x8d, 0x26, 0x19, 0xbc,
+	0x72, 0xb0, 0x50, 0x10, 0xbc, 0x79, 0x2a, 0xb3, 0xc2, 0x0f, 0x09, 0x54,
+	0xd6, 0x6a, 0x9d, 0x18, 0xa4, 0x76, 0xd2, 0xee, 0x3b, 0xe8, 0x8d, 0x47,
+	0xd2, 0xda, 0xb6, 0x0f, 0xac, 0xb1, 0x94, 0xa4, 0x87, 0x5b, 0x55, 0x02,
+	0x46, 0x4b, 0xdd, 0x71, 0x80, 0xf4, 0xcf, 0xa3, 0x60, 0x25, 0x98, 0x6e,
+	0x08, 0xed, 0x00, 0xeb, 0xa0, 0xf3, 0x8a, 0xfb, 0x06, 0xea, 0xab, 0xc5,
+	0xd6, 0xab, 0xc3, 0x7d, 0x31, 0x16, 0x67, 0x3a, 0x61, 0xb5, 0x82, 0x3c,
+	0x6c, 0x36, 0x82, 0xe0, 0xe1, 0xd2, 0x1c, 0x09, 0x69, 0xb2, 0x50, 0xf2,
+	0xf8, 0x25, 0x62, 0x54, 0xf5, 0xe4, 0x7a, 0xc3, 0x9b, 0x29, 0x02, 0xf1,
+	0x97, 0x60, 0x27, 0x3d,
+};
+
+static const u8 rsa2048_sig_e64[] = {
+	0xb4, 0xdd, 0xc1, 0x5c, 0x7c, 0xe4, 0x41, 0x18, 0xfe, 0xec, 0x01, 0xb5,
+	0x1a, 0x58, 0xce, 0x10, 0x08, 0x24, 0x13, 0x0a, 0xa1, 0x9f, 0x4d, 0x10,
+	0xb3, 0x8b, 0xb2, 0x84, 0x25, 0x06, 0x1e, 0xc4, 0x9e, 0x49, 0x77, 0x9d,
+	0xc8, 0x33, 0xa5, 0xa2, 0x54, 0x35, 0x70, 0x1f, 0x9e, 0xba, 0xfd, 0xf7,
+	0x17, 0xd4, 0x4a, 0x81, 0x30, 0xaa, 0xe5, 0xa4, 0x8a, 0x2b, 0xa8, 0x08,
+	0x0d, 0x8e, 0x37, 0xb2, 0xa2, 0xf0, 0x41, 0xb9, 0xfd, 0xcb, 0xe6, 0x0a,
+	0x7a, 0x86, 0x93, 0xd9, 0x01, 0x13, 0xaf, 0x7d, 0xd9, 0xd3, 0x95, 0x29,
+	0x99, 0x59, 0xcb, 0xdc, 0xe3, 0x1c, 0x45, 0x87, 0x72, 0x8a, 0xee, 0x19,
+	0x8c, 0xba, 0xfc, 0xdd, 0x42, 0x8d, 0x78, 0xea, 0x3f, 0xa7, 0x09, 0x9a,
+	0xcd, 0xbe, 0x47, 0x98, 0x96, 0xac, 0x04, 0x51, 0xae, 0xce, 0x88, 0xa0,
+	0xbc, 0xa4, 0x9e, 0xd3, 0x77, 0x60, 0xf0, 0x07, 0x6e, 0x11, 0xa7, 0xa9,
+	0x97, 0x58, 0xa9, 0x3b, 0xfb, 0xd6, 0xc6, 0xdf, 0xe0, 0x58, 0xe5, 0x97,
+	0x2b, 0x4c, 0x88, 0x3c, 0x60, 0xb0, 0x07, 0x2e, 0xde, 0xd5, 0x1e, 0x30,
+	0x07, 0x59, 0x77, 0xc8, 0x58, 0x05, 0x3c, 0xc6, 0xcc, 0x79, 0x1d, 0x99,
+	0xb4, 0x49, 0xe0, 0x76, 0x6f, 0x6d, 0x7a, 0x5a, 0x94, 0xea, 0x06, 0x6d,
+	0xc5, 0xdf, 0xc5, 0x58, 0x74, 0x54, 0x01, 0xfc, 0x32, 0x2a, 0xe8, 0xbf,
+	0xf3, 0x80, 0x6a, 0x81, 0x60, 0x09, 0xbf, 0x64, 0x8f, 0x0e, 0x2d, 0x8b,
+	0x0a, 0x53, 0xea, 0x11, 0xd1, 0x36, 0x67, 0xeb, 0x92, 0x32, 0xbf, 0xbf,
+	0x3c, 0x32, 0x91, 0x49, 0xb7, 0x88, 0xa2, 0xf8, 0xcb, 0x3a, 0x59, 0x3b,
+	0x3e, 0x50, 0x6e, 0xad, 0x3d, 0x83, 0x56, 0x6a, 0xf2, 0x63, 0x89, 0xf2,
+	0xfa, 0xbe, 0x3b, 0xa0, 0x73, 0xa9, 0x25, 0x5b, 0x0f, 0xb8, 0x81, 0xfe,
+	0x9c, 0xc8, 0x70, 0x8a,
+};
+
+/* RSA-4096 key */
+static const u8 rsa4096_modulus[] = {
+	0xdd, 0x82, 0xd6, 0x4e, 0x30, 0x98, 0x24, 0xa5, 0xd0, 0x3e, 0xe3, 0x98,
+	0xe1, 0x35, 0x3c, 0x55, 0x31, 0x95, 0xd3, 0x99, 0xcb, 0xcd, 0xd7, 0xa4,
+	0xe4, 0x23, 0xfa, 0x86, 0xa3, 0x74, 0x85, 0xf0, 0x52, 0x69, 0xe9, 0x30,
+	0xa8, 0x2a, 0xdb, 0x5d, 0x2d, 0xb9, 0x38, 0x1d, 0xd2, 0x3d, 0x58, 0x4f,
+	0x73, 0xa7, 0xfb, 0xad, 0xe2, 0xc0, 0x30, 0xc6, 0x17, 0xc9, 0xf2, 0x85,
+	0x99, 0x0f, 0x38, 0xf5, 0x61, 0x97, 0x89, 0x70, 0x67, 0x37, 0x36, 0x49,
+	0x82, 0x42, 0xe3, 0x9a, 0x24, 0x80, 0x9c, 0x66, 0x2b, 0x25, 0xb8, 0x41,
+	0x56, 0x8f, 0xb2, 0xc0, 0xbf, 0x64, 0xaa, 0xcd, 0x90, 0x1e, 0x34, 0x39,
+	0x8a, 0x93, 0x8e, 0xad, 0x85, 0xad, 0x60, 0x05, 0xba, 0x97, 0x13, 0xb8,
+	0xcb, 0x6e, 0x1c, 0x0d, 0x27, 0x47, 0x5c, 0x8f, 0x05, 0xaa, 0x15, 0x08,
+	0x1d, 0xcd, 0x0f, 0x55, 0x3d, 0x80, 0x14, 0xef, 0xbb, 0x81, 0x51, 0x6b,
+	0x17, 0xea, 0x11, 0x92, 0xea, 0x15, 0x94, 0x13, 0x65, 0x0e, 0x33, 0xa2,
+	0xa0, 0x7e, 0x59, 0xf7, 0xf7, 0x31, 0x84, 0x15, 0xa5, 0xdf, 0xe7, 0xf1,
+	0x8a, 0xe0, 0x33, 0x32, 0x71, 0xfb, 0x7d, 0xef, 0x57, 0x74, 0x0b, 0x9d,
+	0x7e, 0xa9, 0x65, 0xf7, 0x8e, 0xb0, 0xf3, 0x51, 0xf5, 0x37, 0xd7, 0x0d,
+	0xb6, 0x86, 0xd2, 0xfa, 0x1e, 0x0a, 0x63, 0x85, 0x1b, 0x6b, 0x01, 0x44,
+	0x9f, 0x4e, 0x20, 0x11, 0x64, 0x55, 0xef, 0x35, 0x57, 0x1e, 0x50, 0x35,
+	0x12, 0x16, 0x18, 0xe0, 0x60, 0x44, 0x17, 0x77, 0x41, 0xde, 0x38, 0x94,
+	0xd3, 0xab, 0xf9, 0xae, 0xd4, 0x3e, 0x4e, 0x66, 0x43, 0x43, 0x3c, 0xe1,
+	0x5f, 0xba, 0x60, 0xf9, 0xde, 0x0f, 0xe3, 0x05, 0x14, 0xb8, 0x40, 0x5c,
+	0x97, 0xac, 0xe5, 0x47, 0xc7, 0x60, 0x32, 0xc7, 0xf4, 0x80, 0xa6, 0xb8,
+	0xbc, 0x19, 0xaf, 0xf2, 0x4c, 0x48, 0x61, 0x27, 0x98, 0x82, 0x90, 0x8d,
+	0x35, 0x53, 0xee, 0xee, 0xbc, 0x0b, 0xbe, 0x24, 0x48, 0xa4, 0x7a, 0x5d,
+	0x91, 0x42, 0x65, 0x8f, 0x70, 0x47, 0x1f, 0xb9, 0x0c, 0x3c, 0xc4, 0xb0,
+	0x0a, 0xf8, 0xbc, 0x12, 0x68, 0x2d, 0xeb, 0x8c, 0x88, 0xea, 0xa5, 0x1f,
+	0xdb, 0x3e, 0x0e, 0x7e, 0x60, 0xd9, 0xad, 0xc4, 0x27, 0xa4, 0xca, 0x6f,
+	0xa9, 0xb5, 0xd8, 0xc2, 0xc6, 0xbd, 0x1a, 0x12, 0x12, 0x6d, 0xe8, 0xd5,
+	0xc5, 0x76, 0x03, 0x02, 0x1a, 0x75, 0x85, 0xa5, 0x73, 0x9a, 0xa2, 0xbb,
+	0x94, 0xa1, 0xa5, 0x40, 0x6a, 0xb6, 0x2b, 0x1d, 0xa9, 0x14, 0x5f, 0x72,
+	0x74, 0x95, 0xa3, 0x42, 0x31, 0xa5, 0xd3, 0x4f, 0xcd, 0x53, 0x06, 0x03,
+	0x9c, 0xb5, 0xf9, 0xde, 0x22, 0x8e, 0xd5, 0x51, 0xa2, 0xb9, 0x45, 0x66,
+	0x0d, 0x09, 0x0a, 0x8c, 0xe2, 0xf4, 0x4d, 0x68, 0x9b, 0xf8, 0xac, 0xc5,
+	0x7a, 0x25, 0x19, 0xac, 0x40, 0xb0, 0x1c, 0x08, 0xb7, 0xdd, 0x5a, 0xf1,
+	0xfc, 0x47, 0x17, 0xd2, 0x92, 0xc0, 0x0d, 0xdf, 0x10, 0x13, 0x22, 0x52,
+	0x7f, 0xae, 0x5f, 0xa2, 0x78, 0x12, 0x6c, 0xab, 0x2d, 0xad, 0x4f, 0x39,
+	0xb6, 0x44, 0xba, 0xd3, 0xa8, 0x3d, 0xbb, 0x44, 0xa6, 0xb3, 0x87, 0x1d,
+	0x7f, 0x51, 0x3f, 0x7d, 0x55, 0x72, 0x42, 0xe9, 0xbe, 0x43, 0x37, 0xb5,
+	0x6f, 0x0a, 0x79, 0xe4, 0x57, 0x0c, 0x77, 0x9d, 0xed, 0xfd, 0x6b, 0x73,
+	0x23, 0x5e, 0x13, 0x4a, 0x2b, 0x97, 0x8d, 0x4a, 0xa2, 0x5e, 0xab, 0x76,
+	0x27, 0xd2, 0x0f, 0x00, 0xde, 0x2f, 0x13, 0xeb, 0xaf, 0x55, 0x48, 0x7c,
+	0xe5, 0xc4, 0xbc, 0xf2, 0x1a, 0xba, 0x31, 0x39, 0x26, 0x03, 0x8d, 0xb0,
+	0x20, 0x14, 0x41, 0x6e, 0xeb, 0xac, 0x83, 0xd2, 0x38, 0x98, 0xc9, 0x6e,
+	0x1d, 0xb3, 0x30, 0xe6, 0x4b, 0xa4, 0x8a, 0xa1,
+};
+
+static const u8 rsa4096_rr[] = {
+	0x67, 0x46, 0xc7, 0x45, 0x0f, 0xce, 0xed, 0x0d, 0xc4, 0x1b, 0x7d, 0x1c,
+	0x27, 0xe5, 0x91, 0x30, 0x17, 0x89, 0xc2, 0x7e, 0xd2, 0xd6, 0x34, 0x7a,
+	0x68, 0x1f, 0x99, 0xb9, 0xb4, 0x7a, 0xb8, 0xe5, 0xe9, 0x8d, 0x39, 0xf2,
+	0xfc, 0x95, 0xa1, 0x8f, 0x82, 0x50, 0xcb, 0xe8, 0x63, 0xa5, 0x16, 0xdd,
+	0x60, 0x0a, 0x78, 0xe4, 0x10, 0x97, 0x85, 0xc4, 0x7f, 0x9e, 0x4a, 0x51,
+	0xa9, 0xc5, 0x4a, 0xb5, 0xf8, 0x70, 0xf3, 0x40, 0xd8, 0x0f, 0xe3, 0xad,
+	0xb6, 0xfe, 0x12, 0xe2, 0x83, 0x1a, 0x7c, 0x5a, 0x67, 0xf5, 0x56, 0xab,
+	0x37, 0xac, 0xd2, 0xab, 0x54, 0x4b, 0x32, 0x24, 0xc9, 0xab, 0xfe, 0x9e,
+	0xa1, 0xdd, 0x05, 0xf9, 0xf2, 0xc7, 0xd5, 0xd1, 0xb5, 0xe1, 0x1f, 0x8f,
+	0x0d, 0xda, 0x9f, 0xe0, 0x74, 0x13, 0x3a, 0x37, 0x09, 0x32, 0xca, 0xcf,
+	0xcd, 0x2d, 0xd8, 0x71, 0x10, 0xc9, 0xa5, 0x1f, 0xf3, 0xea, 0x27, 0x90,
+	0x41, 0x59, 0x79, 0x07, 0x38, 0xfe, 0xf8, 0x41, 0xa4, 0x1b, 0xd1, 0x0f,
+	0xf9, 0x95, 0xa1, 0xef, 0x1f, 0x1d, 0x42, 0x6d, 0xd5, 0x00, 0x45, 0xb4,
+	0x76, 0x55, 0x67, 0x85, 0x3e, 0x63, 0x4b, 0xe0, 0x71, 0xa6, 0x7b, 0x61,
+	0xb0, 0xbf, 0xd7, 0xc0, 0x2b, 0x81, 0x2e, 0xe8, 0xd8, 0xc4, 0xb8, 0xea,
+	0xb4, 0xa4, 0x62, 0x95, 0x40, 0x17, 0xc9, 0x2b, 0xfc, 0x04, 0x4e, 0x79,
+	0xba, 0x41, 0xd2, 0xa2, 0x93, 0xd1, 0x50, 0x94, 0xe4, 0x27, 0x8f, 0x62,
+	0x05, 0xbe, 0x58, 0xc4, 0xbb, 0x38, 0x8c, 0xd5, 0x61, 0x5c, 0xa7, 0x36,
+	0x88, 0x30, 0xc0, 0xf2, 0x22, 0x6d, 0x86, 0xde, 0xc8, 0xe5, 0x61, 0x26,
+	0xc0, 0x31, 0xc4, 0x50, 0x1b, 0x87, 0xac, 0x06, 0xa8, 0x16, 0x43, 0xaf,
+	0x51, 0x48, 0xeb, 0x3e, 0x29, 0x64, 0xb4, 0x42, 0x41, 0x6e, 0x25, 0xc6,
+	0x2d, 0x03, 0x04, 0x65, 0xee, 0x51, 0x80, 0xfb, 0x7b, 0x33, 0x51, 0x08,
+	0xd5, 0x88, 0x1a, 0xaa, 0x7c, 0xdc, 0x68, 0xfc, 0xeb, 0x6f, 0x9c, 0xc0,
+	0x47, 0x40, 0x20, 0x0a, 0x09, 0xe2, 0x52, 0x5f, 0x75, 0x4c, 0x5e, 0x9d,
+	0xa1, 0x64, 0x33, 0x5f, 0x41, 0xaf, 0x5e, 0xbb, 0xd9, 0xdc, 0xf6, 0xde,
+	0xce, 0xf9, 0xf8, 0xc5, 0x90, 0x45, 0x87, 0x80, 0x15, 0x31, 0xb2, 0x83,
+	0x23, 0x22, 0xca, 0x08, 0x57, 0x05, 0xa6, 0x49, 0xaa, 0xf2, 0x0b, 0x11,
+	0x36, 0xfc, 0x0d, 0x77, 0xb0, 0xbb, 0x16, 0xd8, 0xc6, 0xf4, 0xdf, 0xa8,
+	0xb4, 0x18, 0x4b, 0xa6, 0x95, 0x90, 0x22, 0xdb, 0x89, 0x25, 0x5d, 0xd9,
+	0x32, 0xc1, 0x46, 0xd8, 0x47, 0x1b, 0xc5, 0x66, 0x2c, 0xc5, 0x61, 0x78,
+	0xa2, 0xf6, 0x73, 0x80, 0xf9, 0x90, 0x3b, 0x16, 0x0d, 0xed, 0x9f, 0xe9,
+	0x1a, 0xf0, 0xd1, 0xa2, 0x07, 0x07, 0x3a, 0xcf, 0x8b, 0x4d, 0x97, 0x29,
+	0x85, 0x7e, 0x69, 0xaa, 0xbc, 0xbe, 0xe5, 0x3e, 0x59, 0x72, 0x0f, 0x9e,
+	0x45, 0x20, 0x0f, 0x27, 0xe4, 0x73, 0x0c, 0x63, 0x45, 0xb5, 0xf9, 0x2a,
+	0xc2, 0x0b, 0x38, 0x7f, 0xe5, 0xdc, 0x79, 0x9c, 0x7c, 0x39, 0x8d, 0xc4,
+	0xcc, 0x5f, 0xf8, 0xbc, 0x2c, 0x07, 0x9c, 0xdb, 0x89, 0x83, 0xf8, 0x77,
+	0x08, 0x1a, 0x59, 0x37, 0x30, 0x3f, 0xd9, 0xb0, 0x44, 0x42, 0x4b, 0xa3,
+	0x3a, 0x17, 0x22, 0xc7, 0x98, 0x83, 0x62, 0xa3, 0x66, 0xb7, 0xfa, 0x63,
+	0x7a, 0xe0, 0xd1, 0x94, 0x7f, 0xf5, 0x5f, 0xf4, 0xb7, 0xd7, 0xdc, 0xb8,
+	0x37, 0xfc, 0x2b, 0xcd, 0x84, 0xce, 0xf7, 0xdb, 0x88, 0x94, 0x7b, 0x5e,
+	0xf2, 0x52, 0x7b, 0x75, 0x70, 0x10, 0x31, 0xc4, 0xb2, 0x55, 0x6a, 0x0c,
+	0xeb, 0x22, 0xcd, 0x68, 0x23, 0xde, 0x18, 0x42, 0x9d, 0x6a, 0x76, 0xff,
+	0x13, 0xcc, 0xaa, 0x3b, 0xe6, 0x7d, 0x9b, 0xff,
+};
+
+static const u8 rsa4096_sig[] = {
+	0xd2, 0x63, 0x7e, 0xfc, 0x61, 0x33, 0xd9, 0x00, 0x46, 0xd2, 0xe1, 0x88,
+	0x23, 0x63, 0xfb, 0x88, 0x1b, 0x2a, 0x52, 0xfa, 0x30, 0x4e, 0x20, 0xa3,
+	0xef, 0x48, 0x1e, 0x58, 0xce, 0x33, 0xe4, 0x6e, 0xd0, 0x7f, 0x61, 0xfd,
+	0x0d, 0x2e, 0x7b, 0xc2, 0x23, 0x32, 0xcd, 0x30, 0x2f, 0x72, 0xa2, 0x75,
+	0xaa, 0xdb, 0xb7, 0xe2, 0x2b, 0x2d, 0x96, 0x06, 0x5f, 0x87, 0x3a, 0x77,
+	0xf7, 0x98, 0xba, 0xce, 0x1a, 0x87, 0x7a, 0x09, 0x9c, 0x67, 0x06, 0xb3,
+	0x84, 0xcc, 0x46, 0x1f, 0xbc, 0x50, 0x3e, 0xd9, 0xa5, 0x00, 0x0c, 0xab,
+	0x30, 0x5a, 0x66, 0x08, 0x5a, 0xcd, 0x58, 0x7a, 0xeb, 0xd3, 0x91, 0x99,
+	0x9d, 0xa9, 0x7f, 0xa9, 0x68, 0x19, 0x37, 0x13, 0x52, 0x36, 0x76, 0x50,
+	0xcb, 0x83, 0x56, 0x51, 0xd6, 0x32, 0xef, 0x38, 0x8b, 0x12, 0x0c, 0x49,
+	0x04, 0x67, 0x81, 0xaf, 0xc8, 0x7f, 0xa6, 0x3b, 0x36, 0xd8, 0x75, 0x8f,
+	0x3c, 0x59, 0xd2, 0xa3, 0x62, 0xda, 0x2b, 0x21, 0xb1, 0xce, 0x40, 0xe9,
+	0x2c, 0x87, 0xea, 0x7b, 0x16, 0xa3, 0xd6, 0x43, 0x8d, 0x63, 0xc8, 0x8c,
+	0xf3, 0x95, 0xd7, 0xe5, 0xa6, 0xef, 0xf1, 0x61, 0x54, 0x53, 0xe9, 0x05,
+	0x9b, 0x49, 0x09, 0x17, 0x92, 0x2d, 0xfd, 0x08, 0x40, 0x5b, 0x59, 0xfe,
+	0x47, 0x19, 0x3c, 0xce, 0x78, 0xd8, 0x7f, 0xe7, 0x86, 0xa2, 0x16, 0x6c,
+	0xf7, 0x44, 0x9e, 0x71, 0x1d, 0x45, 0xfa, 0xbe, 0xee, 0x91, 0xa3, 0xb8,
+	0xa0, 0x94, 0x50, 0x90, 0xed, 0xc0, 0xfd, 0x93, 0x31, 0x1b, 0xb8, 0xd2,
+	0x7b, 0xa3, 0xd2, 0x2d, 0x96, 0x60, 0xfd, 0x25, 0xcb, 0xf6, 0xdc, 0x1e,
+	0x3f, 0x96, 0x5c, 0x5b, 0x2a, 0x95, 0xfd, 0xf8, 0x05, 0xf6, 0x20, 0xdd,
+	0xf3, 0x7c, 0x8b, 0xc3, 0x8c, 0x5d, 0x0e, 0xcf, 0xe9, 0xa5, 0xe5, 0x50,
+	0xf8, 0x8c, 0x8d, 0xc7, 0x76, 0x8c, 0x6b, 0x03, 0x32, 0x99, 0x85, 0xed,
+	0x84, 0x5e, 0x10, 0x6a, 0x54, 0xc1, 0x80, 0x33, 0xe3, 0x55, 0xd6, 0xe6,
+	0xe4, 0x92, 0x5f, 0xce, 0x7a, 0xe2, 0xdb, 0xde, 0xd2, 0xf4, 0x9b, 0xa2,
+	0x00, 0x66, 0x1d, 0x20, 0x4f, 0x77, 0x5f, 0xba, 0x9b, 0x01, 0x2c, 0x56,
+	0xcb, 0x35, 0x3a, 0x1b, 0x7a, 0x5b, 0x65, 0x7b, 0x64, 0xea, 0xab, 0x55,
+	0xb3, 0xf4, 0x92, 0x35, 0xe2, 0x92, 0x6a, 0xd7, 0x28, 0x37, 0xa9, 0x04,
+	0x78, 0xd8, 0xcd, 0x5c, 0xc5, 0x72, 0x6e, 0x0c, 0x08, 0x9d, 0x7a, 0xfb,
+	0xaf, 0xd8, 0x3e, 0x27, 0x9d, 0x1e, 0x18, 0x56, 0xe6, 0xc0, 0x1e, 0xbd,
+	0x6f, 0x11, 0xbe, 0xf3, 0x41, 0x30, 0x11, 0xba, 0x33, 0xfb, 0x08, 0x10,
+	0xdf, 0x36, 0x73, 0x2a, 0xd5, 0x96, 0xa7, 0x62, 0xeb, 0xd4, 0x22, 0xb9,
+	0xc5, 0xe0, 0x51, 0x57, 0x6d, 0xde, 0x4e, 0x64, 0xd1, 0x11, 0x81, 0xe1,
+	0x6c, 0xe4, 0xb2, 0x03, 0xf3, 0x29, 0x4e, 0xf0, 0x0a, 0x67, 0xaf, 0x69,
+	0xee, 0x50, 0xa2, 0x3e, 0x2e, 0x6b, 0xca, 0x11, 0x27, 0x89, 0x26, 0x9f,
+	0x57, 0xac, 0xcd, 0x26, 0x49, 0xdb, 0xc6, 0xb6, 0x6c, 0xf8, 0xbc, 0x2a,
+	0x5a, 0xb3, 0xf9, 0xe2, 0x52, 0x72, 0x2a, 0xb6, 0x15, 0x4d, 0x1c, 0x7f,
+	0xd4, 0x88, 0xb4, 0x00, 0x2b, 0x25, 0x32, 0x39, 0xe2, 0x49, 0xc8, 0x20,
+	0x74, 0x35, 0x21, 0xa1, 0xac, 0xbc, 0xdc, 0xd8, 0x8b, 0x5a, 0xec, 0x89,
+	0xee, 0xcb, 0x59, 0xf1, 0x13, 0x4d, 0x7e, 0x5f, 0xb5, 0x52, 0x8b, 0x03,
+	0x8f, 0x2e, 0x05, 0xea, 0x5c, 0xf6, 0xad, 0xde, 0x9a, 0x8b, 0x26, 0x58,
+	0x5b, 0xf9, 0x84, 0x9f, 0xfa, 0xf1, 0xf7, 0x30, 0xaa, 0x05, 0xa4, 0xbe,
+	0x47, 0x05, 0x4c, 0x96, 0x35, 0x2a, 0x2a, 0x16, 0x09, 0xad, 0xad, 0x29,
+	0xc2, 0xea, 0x2b, 0x0c, 0x94, 0x26, 0x77, 0x86,
+};
+
+static const u8 rsa4096_sig_e64[] = {
+	0xb5, 0x74, 0x1a, 0xcb, 0xdb, 0xa1, 0xb8, 0xb3, 0x1b, 0x0e, 0x1e, 0x3f,
+	0xba, 0x10, 0x64, 0x2d, 0x16, 0x47, 0x7e, 0x29, 0x93, 0x2d, 0x58, 0x70,
+	0x82, 0x44, 0x7f, 0x2e, 0xb6, 0x8e, 0x50, 0xe8, 0x40, 0x5e, 0x18, 0x7b,
+	0x32, 0x00, 0xb5, 0x73, 0x53, 0x27, 0x7c, 0xc4, 0x86, 0xdc, 0x95, 0x8b,
+	0xdd, 0x54, 0xfd, 0x60, 0x71, 0xe2, 0x11, 0xf5, 0x6c, 0x72, 0x21, 0x81,
+	0xf3, 0x8f, 0x26, 0x22, 0xec, 0x03, 0x37, 0xb7, 0xa4, 0xf5, 0x91, 0x45,
+	0xc6, 0x78, 0xd3, 0xff, 0x52, 0x18, 0xb7, 0xed, 0x1e, 0x0c, 0xd0, 0x99,
+	0x5b, 0x0c, 0x4e, 0xf3, 0x3f, 0x10, 0xd7, 0xcc, 0xa5, 0xe7, 0x77, 0xd4,
+	0x9a, 0x98, 0x1d, 0x39, 0xc5, 0x25, 0xd5, 0xa2, 0xbd, 0x5f, 0xcb, 0xbb,
+	0xc1, 0xa7, 0xbe, 0x3a, 0x8a, 0x84, 0x55, 0x43, 0xa0, 0xb0, 0xe0, 0x01,
+	0x3d, 0xca, 0x6c, 0xc3, 0xe9, 0x22, 0x9f, 0x76, 0xe9, 0x74, 0x49, 0x80,
+	0xef, 0xa2, 0x88, 0xc4, 0x6d, 0xbe, 0x98, 0x00, 0x26, 0x2f, 0x13, 0x90,
+	0x88, 0xf7, 0x73, 0xd2, 0xff, 0xae, 0x77, 0x66, 0x9e, 0xb6, 0xc0, 0xa0,
+	0x0a, 0xaa, 0xfe, 0xbe, 0xa4, 0xce, 0x0d, 0x6b, 0x18, 0xd1, 0x5e, 0xf7,
+	0x0f, 0x5c, 0x44, 0xfe, 0xd7, 0x26, 0x45, 0xc5, 0x4c, 0x5e, 0x54, 0x8b,
+	0xeb, 0xcb, 0x67, 0x3c, 0xae, 0xb4, 0xd8, 0x84, 0x39, 0xba, 0x8e, 0x9a,
+	0xc0, 0x7a, 0x7a, 0x92, 0x80, 0x56, 0x94, 0x39, 0x9c, 0x10, 0xfa, 0x8c,
+	0x85, 0x8b, 0xe1, 0x59, 0xc9, 0xe7, 0x05, 0x1c, 0xff, 0x84, 0xfe, 0x06,
+	0x97, 0xfa, 0x33, 0x01, 0xb9, 0x86, 0xb0, 0x90, 0xe6, 0xbc, 0xb6, 0x81,
+	0xa1, 0xf1, 0xb1, 0x63, 0xeb, 0x82, 0x36, 0x8e, 0x27, 0x62, 0x4d, 0x89,
+	0x21, 0x3d, 0xaa, 0x20, 0x6f, 0x46, 0x87, 0xd9, 0xd9, 0x8e, 0x55, 0x72,
+	0xa3, 0x50, 0xd7, 0x77, 0x8f, 0xac, 0x67, 0xd8, 0xe1, 0x2d, 0x25, 0x1f,
+	0x34, 0x6a, 0xd3, 0x37, 0xd8, 0xe2, 0xde, 0x72, 0xbe, 0x01, 0x65, 0x19,
+	0xe0, 0x0d, 0xf4, 0x5c, 0xe5, 0xf5, 0x3f, 0x4d, 0x43, 0x85, 0x6c, 0x33,
+	0xf3, 0x8d, 0xb5, 0x26, 0xa0, 0x6a, 0xe9, 0xdb, 0x41, 0xde, 0x0d, 0xf6,
+	0xfb, 0x1d, 0x8c, 0x87, 0x2b, 0x59, 0x74, 0x4e, 0x2f, 0x9a, 0x46, 0x51,
+	0xf3, 0xeb, 0x5d, 0xd4, 0x1a, 0xb9, 0x47, 0xcd, 0x46, 0x85, 0xb7, 0xd9,
+	0xc2, 0x96, 0xbf, 0xb0, 0xc8, 0xe5, 0x23, 0x19, 0x04, 0x80, 0x89, 0x04,
+	0x21, 0xc9, 0xdd, 0x9b, 0x3c, 0x0e, 0x1f, 0xbe, 0x4d, 0xef, 0xe9, 0x74,
+	0xa5, 0xbe, 0x41, 0x70, 0x8c, 0x5c, 0xdb, 0xe8, 0xdc, 0x6b, 0xae, 0x92,
+	0x83, 0xb1, 0xd5, 0x43, 0xbe, 0x27, 0x07, 0xba, 0x5c, 0x3b, 0x9f, 0x34,
+	0x30, 0xaa, 0x0d, 0x85, 0x5f, 0xd4, 0xa2, 0x19, 0x79, 0x64, 0x16, 0xb0,
+	0x0f, 0x6f, 0x2d, 0xf4, 0x74, 0xc3, 0x09, 0x8f, 0x2e, 0x0c, 0x06, 0x74,
+	0x18, 0xa6, 0xde, 0x92, 0x0a, 0xfb, 0x6e, 0xc1, 0x34, 0xad, 0x04, 0x61,
+	0xc3, 0x89, 0xbc, 0xd3, 0x99, 0xab, 0x33, 0xab, 0x71, 0x34, 0x68, 0x6e,
+	0x57, 0x92, 0xc8, 0xd6, 0x9a, 0x67, 0x6d, 0x58, 0xf7, 0xc4, 0x71, 0x9d,
+	0x47, 0xb4, 0x1e, 0x5d, 0x8c, 0x0a, 0x7c, 0x75, 0x60, 0x8d, 0xce, 0x2f,
+	0xe2, 0x9f, 0x06, 0xd9, 0x98, 0x85, 0x5d, 0xc8, 0x08, 0x66, 0x46, 0xfe,
+	0x53, 0x18, 0x33, 0x48, 0x9a, 0xcb, 0x17, 0xbe, 0xca, 0x43, 0xbf, 0x17,
+	0xff, 0xa7, 0x78, 0x53, 0x3c, 0x42, 0x65, 0xd0, 0xba, 0x0c, 0x9e, 0x07,
+	0x3e, 0x1d, 0xec, 0x91, 0xc8, 0x4e, 0x00, 0xb6, 0x9f, 0xb5, 0x2e, 0x13,
+	0x9d, 0xe5, 0x81, 0x0a, 0x53, 0xaa, 0x76, 0x87, 0x0c, 0x8a, 0x34, 0xbe,
+	0x95, 0xa8, 0xc0, 0x6d, 0x01, 0xf7, 0x23, 0x52,
+};
+
+
+struct rsa_test_key {
+	int bits;
+	uint32_t n0inv;
+	const u8 *modulus;
+	const u8 *rr;
+	const u8 *sig;
+	const u8 *sig_e64;
+};
+
+static const struct rsa_test_key rsa_test_keys[] = {
+	{ 2048, 0x3c7c01b5, rsa2048_modulus, rsa2048_rr, rsa2048_sig,
+	  rsa2048_sig_e64 },
+	{ 4096, 0xd7fa269f, rsa4096_modulus, rsa4096_rr, rsa4096_sig,
+	  rsa4096_sig_e64 },
+};
+
+/* Put the key in a blob the way mkimage -K does */
+static int make_key_blob(void *blob, int size, const struct rsa_test_key *tk,
+			 uint64_t exponent)
+{
+	int sig_node, node;
+
+	if (fdt_create_empty_tree(blob, size))
+		return -1;
+	sig_node = fdt_add_subnode(blob, 0, FIT_SIG_NODENAME);
+	if (sig_node < 0)
+		return -1;
+	node = fdt_add_subnode(blob, sig_node, "key-test");
+	if (node < 0)
+		return -1;
+	if (fdt_setprop_u32(blob, node, "rsa,num-bits", tk->bits) ||
+	    fdt_setprop_u32(blob, node, "rsa,n0-inverse", tk->n0inv) ||
+	    fdt_setprop_u64(blob, node, "rsa,exponent", exponent) ||
+	    fdt_setprop(blob, node, "rsa,modulus", tk->modulus,
+			tk->bits / 8) ||
+	    fdt_setprop(blob, node, "rsa,r-squared", tk->rr, tk->bits / 8))
+		return -1;
+
+	return node;
+}
+
+static int verify(void *blob, int node, int bits, const u8 *sig)
+{
+	struct image_region region = { msg, strlen(msg) };
+	struct image_sign_info info;
+	char algo[20];
+	u8 buf[RSA4096_BYTES];
+
+	sprintf(algo, "sha256,rsa%d", bits);
+	memset(&info, 0, sizeof(info));
+	info.keyname = "test";
+	info.fit = blob;
+	info.algo = image_get_sig_algo(algo);
+	info.fdt_blob = blob;
+	info.required_keynode = node;
+	if (!info.algo)
+		return -ENOENT;
+
+	/* rsa_verify() may change the signature in place */
+	memcpy(buf, sig, bits / 8);
+
+	return rsa_verify(&info, &region, 1, buf, bits / 8);
+}
+
+static int run_rsa_test(const struct rsa_test_key *tk, void *blob)
+{
+	u8 bad[RSA4096_BYTES];
+	void *e64_blob;
+	ulong start, msecs;
+	int node, i, ret;
+
+	printf(" testing RSA-%d ...\n", tk->bits);
+	node = make_key_blob(blob, 4096, tk, 65537);
+	errcheck(node >= 0);
+	errcheck(verify(blob, node, tk->bits, tk->sig) == 0);
+
+	/* A changed signature, or one for the other exponent, must fail */
+	memcpy(bad, tk->sig, tk->bits / 8);
+	bad[tk->bits / 16] ^= 0x10;
+	errcheck(verify(blob, node, tk->bits, bad) != 0);
+	errcheck(verify(blob, node, tk->bits, tk->sig_e64) != 0);
+
+	start = get_timer(0);
+	for (i = 0; i < RSA_BENCH_LOOPS; i++)
+		verify(blob, node, tk->bits, tk->sig);
+	msecs = get_timer(start);
+	printf("\texponent 65537: %lu us per signature\n",
+	       msecs * 1000 / RSA_BENCH_LOOPS);
+
+	/* Keys are cached by blob and node, a changed key needs its own blob */
+	e64_blob = blob + 4096;
+	node = make_key_blob(e64_blob, 4096, tk, RSA_E64);
+	errcheck(node >= 0);
+	errcheck(verify(e64_blob, node, tk->bits, tk->sig_e64) == 0);
+	errcheck(verify(e64_blob, node, tk->bits, tk->sig) != 0);
+
+	start = get_timer(0);
+	for (i = 0; i < RSA_BENCH_LOOPS; i++)
+		verify(e64_blob, node, tk->bits, tk->sig_e64);
+	msecs = get_timer(start);
+	printf("\t64-bit exponent: %lu us per signature\n",
+	       msecs * 1000 / RSA_BENCH_LOOPS);
+
+	ret = 0;
+out:
+	return ret;
+}
+
+static int do_test_rsa(cmd_tbl_t *cmdtp, int flag, int argc,
+		       char * const argv[])
+{
+	void *blob;
+	int i, ret = 0;
+
+	blob = malloc(2 * 4096);
+	if (!blob) {
+		puts("Out of memory\n");
+		return 1;
+	}
+
+	for (i = 0; i < ARRAY_SIZE(rsa_test_keys); i++)
+		ret |= run_rsa_test(&rsa_test_keys[i], blob);
+
+	printf("test_rsa %s\n", ret == 0 ? "ok" : "FAILED");
+	free(blob);
+
+	return ret;
+}
+
+U_BOOT_CMD(
+	test_rsa,	1,	1,	do_test_rsa,
+	"Test RSA-2048/4096 signature checks and time them", ""
+);
@@ -0,0 +1,132 @@
+/*
+ * SPI flash update test: 'sf update' with a manifest only writes the erase
+ * blocks whose hash changed, without reading the others back, and keeps
+ * what follows the image in its last block. Needs a sandbox SPI flash with
+ * 4 KiB erase blocks, e.g.
+ *
+ *   dd if=/dev/zero of=sf.bin bs=1M count=2
+ *   ./u-boot --spi_sf 0:0:W25Q16CL:sf.bin -c test_sf_update
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+#include <common.h>
+#include <command.h>
+#include <asm/io.h>
+
+#define TEST_ADDR		0x1000000
+#define TEST_SIZE		0x19800		/* ends in the middle of a block */
+#define TEST_READ		(TEST_ADDR + 0x100000)
+#define TEST_JUNK		(TEST_ADDR + 0x200000)
+
+#define SF_OFFSET		0x10000
+#define SF_MANIFEST		0x100000
+#define SF_BLOCK		0x1000
+
+static int test_sf_run(const char *what, const char *fmt, ulong a, ulong b,
+		       ulong c)
+{
+	char cmd[80];
+
+	sprintf(cmd, fmt, a, b, c);
+	if (run_command(cmd, 0)) {
+		printf("\tFailed: %s: %s\n", what, cmd);
+		return 1;
+	}
+
+	return 0;
+}
+
+static int test_sf_update(const char *what, int manifest)
+{
+	char cmd[80];
+
+	sprintf(cmd, "sf update %x %x %x", TEST_ADDR, SF_OFFSET, TEST_SIZE);
+	if (manifest)
+		sprintf(cmd + strlen(cmd), " %x", SF_MANIFEST);
+	if (run_command(cmd, 0)) {
+		printf("\tFailed: %s update\n", what);
+		return 1;
+	}
+
+	return test_sf_run(what, "sf read %lx %lx %lx", TEST_READ, SF_OFFSET,
+			   TEST_SIZE + SF_BLOCK);
+}
+
+/* Compare 'len' bytes of flash, as read to TEST_READ, with 'expect' */
+static int test_sf_check(const char *what, ulong offs, const u8 *expect,
+			 ulong len)
+{
+	if (memcmp(map_sysmem(TEST_READ + offs, len), expect, len)) {
+		printf("\tFailed: %s, flash data at %#lx\n", what,
+		       SF_OFFSET + offs);
+		return 1;
+	}
+
+	return 0;
+}
+
+static int do_test_sf_update(cmd_tbl_t *cmdtp, int flag, int argc,
+			     char * const argv[])
+{
+	u8 *data = map_sysmem(TEST_ADDR, TEST_SIZE);
+	u8 *junk = map_sysmem(TEST_JUNK, SF_BLOCK);
+	int i, ret = 1;
+
+	if (run_command("sf probe", 0)) {
+		printf("\tFailed: no SPI flash, see test/sf_update.c\n");
+		goto out;
+	}
+
+	for (i = 0; i < TEST_SIZE; i++)
+		data[i] = i ^ (i >> 12);
+	memset(junk, 0x5a, SF_BLOCK);
+
+	/* no manifest yet, junk after the image must stay */
+	if (test_sf_run("setup", "sf erase %lx %lx", SF_MANIFEST, SF_BLOCK, 0) ||
+	    test_sf_run("setup", "sf erase %lx %lx", SF_OFFSET,
+			ROUND(TEST_SIZE, SF_BLOCK), 0) ||
+	    test_sf_run("setup", "sf write %lx %lx %lx", TEST_JUNK,
+			SF_OFFSET + TEST_SIZE, SF_BLOCK / 2) ||
+	    test_sf_update("first", 1) ||
+	    test_sf_check("first", 0, data, TEST_SIZE) ||
+	    test_sf_check("first tail", TEST_SIZE, junk, SF_BLOCK / 2))
+		goto out;
+
+	/*
+	 * Change the flash behind the manifest in block 2, then update
+	 * blocks 5 and the last one: block 2 is trusted to be unchanged and
+	 * is not read back, the others are written.
+	 */
+	data[5 * SF_BLOCK + 7] ^= 0xff;
+	data[TEST_SIZE - 1] ^= 0xff;
+	if (test_sf_run("junk", "sf erase %lx %lx", SF_OFFSET + 2 * SF_BLOCK,
+			SF_BLOCK, 0) ||
+	    test_sf_run("junk", "sf write %lx %lx %lx", TEST_JUNK,
+			SF_OFFSET + 2 * SF_BLOCK, SF_BLOCK) ||
+	    test_sf_update("manifest", 1) ||
+	    test_sf_check("manifest", 0, data, 2 * SF_BLOCK) ||
+	    test_sf_check("manifest skip", 2 * SF_BLOCK, junk, SF_BLOCK) ||
+	    test_sf_check("manifest", 3 * SF_BLOCK, data + 3 * SF_BLOCK,
+			  TEST_SIZE - 3 * SF_BLOCK) ||
+	    test_sf_check("manifest tail", TEST_SIZE, junk, SF_BLOCK / 2))
+		goto out;
+
+	/* without the manifest every block is compared and block 2 fixed */
+	if (test_sf_update("compare", 0) ||
+	    test_sf_check("compare", 0, data, TEST_SIZE) ||
+	    test_sf_check("compare tail", TEST_SIZE, junk, SF_BLOCK / 2))
+		goto out;
+
+	ret = 0;
+out:
+	printf("test_sf_update %s\n", ret == 0 ? "ok" : "FAILED");
+
+	return ret;
+}
+
+U_BOOT_CMD(
+	test_sf_update,	1,	1,	do_test_sf_update,
+	"Update a sandbox SPI flash with 'sf update' and a block manifest",
+	""
+);
@@ -0,0 +1,388 @@
+/*
+ * TFTP test: download through a TFTP server stand-in that sits behind a
+ * fake ethernet device, with a simulated round trip time, and check the
+ * data and the effective throughput for several window sizes. The server
+ * can drop a block once and swap two blocks of a window to exercise the
+ * RFC 7440 windowsize recovery, and deliver its packets with a copy or
+ * zero-copy through recv_pkt()/free_pkt().
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+#include <common.h>
+#include <command.h>
+#include <malloc.h>
+#include <net.h>
+#include <asm/errno.h>
+#include <asm/io.h>
+
+#define TEST_ADDR		0x1000000
+#define TEST_SIZE		(1 << 20)
+#define TEST_BLKSIZE		1468
+#define TEST_RTT_US		1000
+
+#define SERVER_PORT		69
+#define SERVER_TID		2000
+#define SERVER_QUEUE		128
+
+#define TFTP_RRQ		1
+#define TFTP_DATA		3
+#define TFTP_ACK		4
+#define TFTP_OACK		6
+
+static const uchar server_ether[6] = { 0x02, 0x00, 0x00, 0x00, 0x00, 0x01 };
+static const uchar client_ether[6] = { 0x02, 0x00, 0x00, 0x00, 0x00, 0x02 };
+
+struct server_pkt {
+	ulong due;
+	int len;
+	uchar data[PKTSIZE_ALIGN];
+};
+
+struct tftp_server {
+	IPaddr_t ip;
+	uchar *file;
+	ulong size;
+	int blksize;
+	int windowsize;		/* largest window granted, 0 ignores it */
+	int drop;		/* drop this block once */
+	int swap;		/* send this block after the next one, once */
+	/* transfer */
+	int client_port;
+	int window;
+	ulong acks;
+	ulong sent;
+	/* packets on the wire, delivered after TEST_RTT_US */
+	struct server_pkt *queue;
+	int head, tail;
+	int lent;		/* head is handed out by server_recv_pkt() */
+};
+
+static struct tftp_server server;
+
+static struct server_pkt *server_queue(int len)
+{
+	struct server_pkt *pkt = &server.queue[server.tail];
+
+	server.tail = (server.tail + 1) % SERVER_QUEUE;
+	if (server.tail == server.head)
+		panic("tftp server queue overflow");
+
+	pkt->due = timer_get_us() + TEST_RTT_US;
+	pkt->len = ETHER_HDR_SIZE + len;
+	memcpy(pkt->data, client_ether, 6);
+	memcpy(pkt->data + 6, server_ether, 6);
+
+	return pkt;
+}
+
+static uchar *server_udp(int len)
+{
+	struct server_pkt *pkt;
+	struct ip_udp_hdr *ip;
+
+	pkt = server_queue(IP_UDP_HDR_SIZE + len);
+	((struct ethernet_hdr *)pkt->data)->et_protlen = htons(PROT_IP);
+	ip = (struct ip_udp_hdr *)(pkt->data + ETHER_HDR_SIZE);
+	ip->ip_hl_v = 0x45;
+	ip->ip_tos = 0;
+	ip->ip_len = htons(IP_UDP_HDR_SIZE + len);
+	ip->ip_id = 0;
+	ip->ip_off = htons(IP_FLAGS_DFRAG);
+	ip->ip_ttl = 255;
+	ip->ip_p = IPPROTO_UDP;
+	ip->ip_sum = 0;
+	NetCopyIP(&ip->ip_src, &server.ip);
+	NetCopyIP(&ip->ip_dst, &NetOurIP);
+	ip->ip_sum = ~NetCksum((uchar *)ip, IP_HDR_SIZE >> 1);
+	ip->udp_src = htons(SERVER_TID);
+	ip->udp_dst = htons(server.client_port);
+	ip->udp_len = htons(UDP_HDR_SIZE + len);
+	ip->udp_xsum = 0;
+
+	return (uchar *)(ip + 1);
+}
+
+static void server_send_block(ulong block)
+{
+	ulong offset = (block - 1) * server.blksize;
+	int len = min(server.size - offset, (ulong)server.blksize);
+	uchar *pkt = server_udp(4 + len);
+
+	*(__be16 *)pkt = htons(TFTP_DATA);
+	*(__be16 *)(pkt + 2) = htons(block);
+	memcpy(pkt + 4, server.file + offset, len);
+	server.sent++;
+}
+
+/* Send the window after block 'ack', RFC 7440 */
+static void server_send_window(ulong ack)
+{
+	ulong last = server.size / server.blksize + 1;
+	ulong block;
+
+	for (block = ack + 1; block <= ack + server.window && block <= last;
+	     block++) {
+		if (block == server.drop) {
+			server.drop = 0;
+			continue;
+		}
+		if (block == server.swap && block < last &&
+		    block < ack + server.window) {
+			server.swap = 0;
+			server_send_block(block + 1);
+			server_send_block(block);
+			block++;
+			continue;
+		}
+		server_send_block(block);
+	}
+}
+
+static void server_rrq(char *opt, char *end)
+{
+	char *name, *val, *oack;
+	uchar *pkt;
+	int len = 0;
+
+	server.blksize = 512;
+	server.window = 1;
+	server.acks = 0;
+	server.sent = 0;
+
+	oack = malloc(128);
+	if (!oack)
+		return;
+
+	/* filename and mode, then name/value option pairs */
+	opt += strlen(opt) + 1;
+	opt += strlen(opt) + 1;
+	while (opt < end) {
+		name = opt;
+		val = name + strlen(name) + 1;
+		opt = val + strlen(val) + 1;
+
+		if (!strcmp(name, "blksize")) {
+			server.blksize = min(simple_strtoul(val, NULL, 10),
+					     (ulong)TEST_BLKSIZE);
+			len += sprintf(oack + len, "blksize%c%d%c", 0,
+				       server.blksize, 0);
+		} else if (!strcmp(name, "windowsize") && server.windowsize) {
+			server.window = min(simple_strtoul(val, NULL, 10),
+					    (ulong)server.windowsize);
+			len += sprintf(oack + len, "windowsize%c%d%c", 0,
+				       server.window, 0);
+		}
+	}
+
+	pkt = server_udp(2 + len);
+	*(__be16 *)pkt = htons(TFTP_OACK);
+	memcpy(pkt + 2, oack, len);
+	free(oack);
+}
+
+static int server_send(struct eth_device *dev, void *packet, int length)
+{
+	struct ethernet_hdr *et = packet;
+	struct arp_hdr *arp;
+	struct ip_udp_hdr *ip;
+	uchar *pkt;
+
+	switch (ntohs(et->et_protlen)) {
+	case PROT_ARP:
+		arp = (struct arp_hdr *)(et + 1);
+		if (ntohs(arp->ar_op) != ARPOP_REQUEST ||
+		    NetReadIP(&arp->ar_tpa) != server.ip)
+			break;
+		pkt = server_queue(ARP_HDR_SIZE)->data + ETHER_HDR_SIZE;
+		((struct ethernet_hdr *)(pkt - ETHER_HDR_SIZE))->et_protlen =
+			htons(PROT_ARP);
+		memcpy(pkt, arp, ARP_HDR_SIZE);
+		arp = (struct arp_hdr *)pkt;
+		arp->ar_op = htons(ARPOP_REPLY);
+		memcpy(&arp->ar_tha, &arp->ar_sha, ARP_HLEN + ARP_PLEN);
+		memcpy(&arp->ar_sha, server_ether, ARP_HLEN);
+		NetWriteIP(&arp->ar_spa, server.ip);
+		break;
+
+	case PROT_IP:
+		ip = (struct ip_udp_hdr *)(et + 1);
+		if (ip->ip_p != IPPROTO_UDP)
+			break;
+		pkt = (uchar *)(ip + 1);
+		length = ntohs(ip->udp_len) - UDP_HDR_SIZE;
+
+		if (ntohs(ip->udp_dst) == SERVER_PORT &&
+		    ntohs(*(__be16 *)pkt) == TFTP_RRQ) {
+			server.client_port = ntohs(ip->udp_src);
+			server_rrq((char *)pkt + 2, (char *)pkt + length);
+		} else if (ntohs(ip->udp_dst) == SERVER_TID &&
+			   ntohs(*(__be16 *)pkt) == TFTP_ACK) {
+			server.acks++;
+			/* block numbers stay below 64k in this test */
+			server_send_window(ntohs(*(__be16 *)(pkt + 2)));
+		}
+		break;
+	}
+
+	return 0;
+}
+
+/* Copying receive, like most drivers */
+static int server_recv(struct eth_device *dev)
+{
+	struct server_pkt *pkt;
+
+	/* the handlers queue new packets, deliver the due ones only */
+	while (server.head != server.tail) {
+		pkt = &server.queue[server.head];
+		if ((long)(timer_get_us() - pkt->due) < 0)
+			break;
+		server.head = (server.head + 1) % SERVER_QUEUE;
+		memcpy(NetRxPackets[0], pkt->data, pkt->len);
+		NetReceive(NetRxPackets[0], pkt->len);
+	}
+
+	return 0;
+}
+
+/* Zero-copy receive: the stack works on the queued packet itself */
+static int server_recv_pkt(struct eth_device *dev, uchar **packetp)
+{
+	struct server_pkt *pkt = &server.queue[server.head];
+
+	if (server.head == server.tail ||
+	    (long)(timer_get_us() - pkt->due) < 0)
+		return -EAGAIN;
+
+	if (server.lent)
+		panic("tftp server packet handed out twice");
+	server.lent = 1;
+	*packetp = pkt->data;
+
+	return pkt->len;
+}
+
+static int server_free_pkt(struct eth_device *dev, uchar *packet, int length)
+{
+	if (!server.lent || packet != server.queue[server.head].data)
+		panic("tftp server freeing the wrong packet");
+	server.lent = 0;
+	server.head = (server.head + 1) % SERVER_QUEUE;
+
+	return 0;
+}
+
+static int server_init(struct eth_device *dev, bd_t *bis)
+{
+	server.head = server.tail = 0;
+	server.lent = 0;
+
+	return 0;
+}
+
+static void server_halt(struct eth_device *dev)
+{
+}
+
+static int test_tftp_get(const char *what, int windowsize, int drop, int swap)
+{
+	ulong start, us;
+	char cmd[64];
+	int ret;
+
+	server.windowsize = windowsize;
+	server.drop = drop;
+	server.swap = swap;
+	setenv_ulong("tftpwindowsize", windowsize ? windowsize : 16);
+	memset(map_sysmem(TEST_ADDR, TEST_SIZE), 0, TEST_SIZE);
+
+	start = timer_get_us();
+	sprintf(cmd, "tftpboot %x test.bin", TEST_ADDR);
+	ret = run_command(cmd, 0);
+	us = timer_get_us() - start;
+
+	if (ret || getenv_hex("filesize", 0) != TEST_SIZE) {
+		printf("\tFailed: %s download\n", what);
+		return 1;
+	}
+	if (memcmp(map_sysmem(TEST_ADDR, TEST_SIZE), server.file, TEST_SIZE)) {
+		printf("\tFailed: %s data mismatch\n", what);
+		return 1;
+	}
+
+	printf("%s: %lu blocks, %lu ACKs, %lu KiB/s\n", what, server.sent,
+	       server.acks, us ? (ulong)((u64)TEST_SIZE * 1000000 / 1024 / us)
+	       : 0);
+
+	return 0;
+}
+
+static int do_test_tftp(cmd_tbl_t *cmdtp, int flag, int argc,
+			char * const argv[])
+{
+	struct eth_device *dev;
+	int i, ret = 1;
+
+	dev = calloc(1, sizeof(*dev));
+	server.file = malloc(TEST_SIZE);
+	server.queue = malloc(SERVER_QUEUE * sizeof(*server.queue));
+	if (!dev || !server.file || !server.queue)
+		goto out;
+
+	for (i = 0; i < TEST_SIZE; i++)
+		server.file[i] = i ^ (i >> 11);
+	server.size = TEST_SIZE;
+	server.ip = string_to_ip("192.168.1.1");
+
+	strcpy(dev->name, "tftp-sb");
+	memcpy(dev->enetaddr, client_ether, 6);
+	dev->init = server_init;
+	dev->send = server_send;
+	dev->recv = server_recv;
+	dev->halt = server_halt;
+	eth_register(dev);
+
+	setenv("ethact", dev->name);
+	if (!getenv("ethaddr"))
+		setenv("ethaddr", "02:00:00:00:00:02");
+	setenv("ipaddr", "192.168.1.2");
+	setenv("serverip", "192.168.1.1");
+	setenv("tftptimeout", "1000");
+	setenv("autostart", "no");
+
+	/* lock-step first: a server without windowsize ignores the option */
+	if (test_tftp_get("lock-step", 0, 0, 0) ||
+	    test_tftp_get("window 16, copying rx", 16, 0, 0))
+		goto unregister;
+
+	/* the rest with zero-copy receive */
+	dev->recv_pkt = server_recv_pkt;
+	dev->free_pkt = server_free_pkt;
+	if (test_tftp_get("window 16", 16, 0, 0) ||
+	    test_tftp_get("window 16, block lost", 16, 100, 0) ||
+	    test_tftp_get("window 16, window end lost", 16, 96, 0) ||
+	    test_tftp_get("window 16, blocks swapped", 16, 0, 200) ||
+	    test_tftp_get("window 64", 64, 0, 0))
+		goto unregister;
+
+	ret = 0;
+unregister:
+	eth_halt();
+	eth_unregister(dev);
+	setenv("ethact", NULL);
+	setenv("tftpwindowsize", NULL);
+out:
+	printf("test_tftp %s\n", ret == 0 ? "ok" : "FAILED");
+	free(server.queue);
+	free(server.file);
+	free(dev);
+
+	return ret;
+}
+
+U_BOOT_CMD(
+	test_tftp,	1,	1,	do_test_tftp,
+	"Download from a TFTP server stand-in with and without windowsize",
+	""
+);
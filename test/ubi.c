@@ -0,0 +1,268 @@
+/*
+ * UBI attach test: attach a simulated NAND flash by scanning when there is
+ * no fastmap, then through the fastmap U-Boot wrote at that attach, and
+ * count the flash pages read each time
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+#include <common.h>
+#include <command.h>
+#include <malloc.h>
+#include <ubi_uboot.h>
+#include <asm/io.h>
+#include "../drivers/mtd/ubi/ubi.h"
+
+#define NAND_PAGE		2048
+#define NAND_SUBPAGE_SHIFT	2
+#define NAND_PEB		(128 << 10)
+#define NAND_PEBS		2048
+#define NAND_PAGES		(NAND_PEBS * (NAND_PEB / NAND_PAGE))
+
+#define TEST_ADDR		0x1000000
+#define TEST_SIZE		(1 << 20)
+
+struct sim_nand {
+	struct mtd_info mtd;
+	u8 *pages[NAND_PAGES];	/* NULL while erased */
+	ulong reads;		/* pages read */
+};
+
+/* Registered once, "ubi part" keeps referring to it */
+static struct sim_nand *nand;
+
+static int nand_read(struct mtd_info *mtd, loff_t from, size_t len,
+		     size_t *retlen, u_char *buf)
+{
+	ulong page = from / NAND_PAGE;
+	int offs = from % NAND_PAGE;
+	size_t n;
+
+	for (*retlen = 0; *retlen < len; *retlen += n, page++, offs = 0) {
+		n = min_t(size_t, len - *retlen, NAND_PAGE - offs);
+		if (nand->pages[page])
+			memcpy(buf + *retlen, nand->pages[page] + offs, n);
+		else
+			memset(buf + *retlen, 0xff, n);
+		nand->reads++;
+	}
+
+	return 0;
+}
+
+static int nand_write(struct mtd_info *mtd, loff_t to, size_t len,
+		      size_t *retlen, const u_char *buf)
+{
+	ulong page = to / NAND_PAGE;
+	int offs = to % NAND_PAGE;
+	size_t n, i;
+
+	for (*retlen = 0; *retlen < len; *retlen += n, page++, offs = 0) {
+		n = min_t(size_t, len - *retlen, NAND_PAGE - offs);
+		if (!nand->pages[page]) {
+			nand->pages[page] = malloc(NAND_PAGE);
+			if (!nand->pages[page])
+				return -ENOMEM;
+			memset(nand->pages[page], 0xff, NAND_PAGE);
+		}
+		/* programming only clears bits */
+		for (i = 0; i < n; i++)
+			nand->pages[page][offs + i] &= buf[*retlen + i];
+	}
+
+	return 0;
+}
+
+static void nand_erase_pages(ulong page, ulong count)
+{
+	for (; count--; page++) {
+		free(nand->pages[page]);
+		nand->pages[page] = NULL;
+	}
+}
+
+static int nand_erase(struct mtd_info *mtd, struct erase_info *instr)
+{
+	nand_erase_pages(instr->addr / NAND_PAGE, instr->len / NAND_PAGE);
+	instr->state = MTD_ERASE_DONE;
+	mtd_erase_callback(instr);
+
+	return 0;
+}
+
+static int nand_block_isbad(struct mtd_info *mtd, loff_t ofs)
+{
+	return 0;
+}
+
+static int nand_block_markbad(struct mtd_info *mtd, loff_t ofs)
+{
+	return 0;
+}
+
+/* A power cut, nothing is written on the way down */
+static int test_ubi_power_cut(void)
+{
+	struct ubi_device *ubi;
+	int vid_hdr_offset;
+
+	ubi = ubi_get_device(0);
+	if (!ubi)
+		return -ENODEV;
+	ubi->ro_mode = 1;
+	vid_hdr_offset = ubi->vid_hdr_offset;
+	ubi_put_device(ubi);
+
+	return vid_hdr_offset;
+}
+
+static int nand_register(void)
+{
+	struct mtd_info *mtd;
+
+	if (nand) {
+		/* from an earlier run, UBI may still be attached to it */
+		test_ubi_power_cut();
+		nand_erase_pages(0, NAND_PAGES);
+		return 0;
+	}
+
+	nand = calloc(1, sizeof(*nand));
+	if (!nand)
+		return -ENOMEM;
+
+	mtd = &nand->mtd;
+	mtd->name = "nand0";
+	mtd->type = MTD_NANDFLASH;
+	mtd->flags = MTD_CAP_NANDFLASH;
+	mtd->size = (u64)NAND_PEBS * NAND_PEB;
+	mtd->erasesize = NAND_PEB;
+	mtd->writesize = NAND_PAGE;
+	mtd->writebufsize = NAND_PAGE;
+	mtd->oobsize = 64;
+	mtd->subpage_sft = NAND_SUBPAGE_SHIFT;
+	mtd->_read = nand_read;
+	mtd->_write = nand_write;
+	mtd->_erase = nand_erase;
+	mtd->_block_isbad = nand_block_isbad;
+	mtd->_block_markbad = nand_block_markbad;
+
+	return add_mtd_device(mtd);
+}
+
+/* Erase the PEBs of the fastmap, as a UBI without fastmap support would */
+static void test_ubi_wipe_fastmap(int vid_hdr_offset)
+{
+	struct ubi_vid_hdr *vid_hdr;
+	ulong page, vol_id;
+
+	for (page = 0; page < NAND_PAGES; page += NAND_PEB / NAND_PAGE) {
+		if (!nand->pages[page])
+			continue;
+		vid_hdr = (void *)nand->pages[page] + vid_hdr_offset;
+		vol_id = be32_to_cpu(vid_hdr->vol_id);
+		if (be32_to_cpu(vid_hdr->magic) == UBI_VID_HDR_MAGIC &&
+		    (vol_id == UBI_FM_SB_VOLUME_ID ||
+		     vol_id == UBI_FM_DATA_VOLUME_ID))
+			nand_erase_pages(page, NAND_PEB / NAND_PAGE);
+	}
+}
+
+static int test_ubi_attach(const char *what, int wipe_fastmap, ulong *reads)
+{
+	struct ubi_device *ubi;
+	int vid_hdr_offset;
+	char cmd[64];
+
+	vid_hdr_offset = test_ubi_power_cut();
+	if (vid_hdr_offset < 0) {
+		printf("\tFailed: %s no UBI device\n", what);
+		return 1;
+	}
+
+	if (wipe_fastmap)
+		test_ubi_wipe_fastmap(vid_hdr_offset);
+
+	nand->reads = 0;
+	if (run_command("ubi part ubi", 0)) {
+		printf("\tFailed: %s attach\n", what);
+		return 1;
+	}
+	*reads = nand->reads;
+
+	/* whichever way it attached, the next attach can use a fastmap */
+	ubi = ubi_get_device(0);
+	if (!ubi || !ubi->fm) {
+		printf("\tFailed: %s no fastmap written\n", what);
+		if (ubi)
+			ubi_put_device(ubi);
+		return 1;
+	}
+	ubi_put_device(ubi);
+
+	memset(map_sysmem(TEST_ADDR, TEST_SIZE), 0, TEST_SIZE);
+	sprintf(cmd, "ubi read %x test %x", TEST_ADDR, TEST_SIZE);
+	if (run_command(cmd, 0) ||
+	    crc32(0, map_sysmem(TEST_ADDR, TEST_SIZE), TEST_SIZE) !=
+	    crc32(0, map_sysmem(TEST_ADDR + TEST_SIZE, TEST_SIZE), TEST_SIZE)) {
+		printf("\tFailed: %s volume data\n", what);
+		return 1;
+	}
+
+	printf("%s: attached with %lu page reads for %d PEBs\n", what, *reads,
+	       NAND_PEBS);
+
+	return 0;
+}
+
+static int do_test_ubi(cmd_tbl_t *cmdtp, int flag, int argc,
+		       char * const argv[])
+{
+	u8 *data = map_sysmem(TEST_ADDR + TEST_SIZE, TEST_SIZE);
+	ulong scan_reads, fastmap_reads;
+	char cmd[64];
+	int i, ret = 1;
+
+	if (nand_register()) {
+		printf("\tFailed: can't register the NAND\n");
+		goto out;
+	}
+
+	setenv("mtdids", "nand0=nand0");
+	setenv("mtdparts", "mtdparts=nand0:-(ubi)");
+
+	/* format the empty flash with a volume, keep a copy of its data */
+	for (i = 0; i < TEST_SIZE; i++)
+		data[i] = i ^ (i >> 11);
+	sprintf(cmd, "ubi write %x test %x", TEST_ADDR + TEST_SIZE, TEST_SIZE);
+	if (run_command("ubi part ubi", 0) ||
+	    run_command("ubi create test 200000", 0) ||
+	    run_command(cmd, 0)) {
+		printf("\tFailed: can't create the volume\n");
+		goto out;
+	}
+
+	if (test_ubi_attach("no fastmap", 1, &scan_reads) ||
+	    test_ubi_attach("fastmap", 0, &fastmap_reads))
+		goto out;
+
+	/* both headers of a PEB come with one read, the fastmap saves most */
+	if (scan_reads > NAND_PEBS + NAND_PEBS / 16 ||
+	    fastmap_reads > scan_reads / 4) {
+		printf("\tFailed: %lu and %lu page reads\n", scan_reads,
+		       fastmap_reads);
+		goto out;
+	}
+
+	ret = 0;
+out:
+	printf("test_ubi %s\n", ret == 0 ? "ok" : "FAILED");
+
+	return ret;
+}
+
+U_BOOT_CMD(
+	test_ubi,	1,	1,	do_test_ubi,
+	"Attach UBI on a simulated NAND by scanning and by fastmap",
+	""
+);
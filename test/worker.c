@@ -0,0 +1,82 @@
+/*
+ * Worker core test: fan checksum jobs out and compare with inline runs
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+#include <common.h>
+#include <command.h>
+#include <malloc.h>
+#include <worker.h>
+#include <u-boot/crc.h>
+
+#define TEST_JOBS		16
+#define TEST_JOB_SIZE		(1 << 20)
+
+struct test_job {
+	struct worker_job job;
+	u8 *buf;
+	u32 crc;
+};
+
+static void test_job_fn(void *arg)
+{
+	struct test_job *t = arg;
+
+	t->crc = crc32(0, t->buf, TEST_JOB_SIZE);
+}
+
+static int do_test_worker(cmd_tbl_t *cmdtp, int flag, int argc,
+			  char * const argv[])
+{
+	struct test_job jobs[TEST_JOBS];
+	ulong start, inline_ms, worker_ms;
+	u32 expect[TEST_JOBS];
+	int i, nr, ret = 0;
+	u8 *buf;
+
+	buf = malloc(TEST_JOBS * TEST_JOB_SIZE);
+	if (!buf)
+		return CMD_RET_FAILURE;
+	for (i = 0; i < TEST_JOBS * TEST_JOB_SIZE; i++)
+		buf[i] = i ^ (i >> 11);
+
+	start = get_timer(0);
+	for (i = 0; i < TEST_JOBS; i++)
+		expect[i] = crc32(0, buf + i * TEST_JOB_SIZE, TEST_JOB_SIZE);
+	inline_ms = get_timer(start);
+
+	nr = worker_init();
+	printf(" %d worker cores\n", nr);
+
+	start = get_timer(0);
+	for (i = 0; i < TEST_JOBS; i++) {
+		jobs[i].job.fn = test_job_fn;
+		jobs[i].job.arg = &jobs[i];
+		jobs[i].buf = buf + i * TEST_JOB_SIZE;
+		jobs[i].crc = 0;
+		worker_submit(&jobs[i].job);
+	}
+	for (i = 0; i < TEST_JOBS; i++)
+		worker_wait(&jobs[i].job);
+	worker_ms = get_timer(start);
+
+	for (i = 0; i < TEST_JOBS; i++) {
+		if (jobs[i].crc != expect[i]) {
+			printf("\tFailed: job %d crc %08x should be %08x\n",
+			       i, jobs[i].crc, expect[i]);
+			ret = 1;
+		}
+	}
+
+	printf(" inline %lu ms, workers %lu ms\n", inline_ms, worker_ms);
+	printf("test_worker %s\n", ret == 0 ? "ok" : "FAILED");
+	free(buf);
+
+	return ret;
+}
+
+U_BOOT_CMD(
+	test_worker,	1,	1,	do_test_worker,
+	"Run jobs on the worker cores and check the results", ""
+);
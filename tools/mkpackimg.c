@@ -0,0 +1,285 @@
+/*
+ * Create a packimg, the container loaded by common/packimg.c
+ *
+ * The image is written in plain text, encryption with the fuse key is
+ * done on the target.
+ *
+ * SPDX-License-Identifier:	GPL-2.0+
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <libgen.h>
+
+#include "compiler.h"
+#include <u-boot/crc.h>
+#include <u-boot/sha256.h>
+#include <packimg.h>
+
+#define MAX_PACK_ENTRY	8
+
+struct input {
+	const char *file;
+	char name[PACK_NAME_MAX];
+	uint32_t ldaddr;
+	uint8_t *data;
+	uint32_t size;
+};
+
+static void usage(const char *exec_name)
+{
+	fprintf(stderr, "%s [-h] [-1] [-d <digest>] [-a <align>] -o <output> <file>:<ldaddr>[:<name>] ...\n"
+	       "\n"
+	       "This tool packs up to %d files into a packimg, ready to be flashed or encrypted.\n"
+	       "\n"
+	       "\t-1 : write a version 1 image with additive checksums\n"
+	       "\t-d <digest> : per entry digest of a version 2 image, crc32 (default) or sha256\n"
+	       "\t-a <align> : align entries to <align> bytes, default 512\n"
+	       "\n"
+	       "<name> defaults to the base name of <file>\n",
+	       exec_name, MAX_PACK_ENTRY);
+}
+
+static uint8_t *read_file(const char *file, uint32_t *size)
+{
+	uint8_t *buf;
+	FILE *fp;
+	long len;
+
+	fp = fopen(file, "rb");
+	if (!fp) {
+		fprintf(stderr, "Can't open %s: %s\n", file, strerror(errno));
+		return NULL;
+	}
+
+	if (fseek(fp, 0, SEEK_END) || (len = ftell(fp)) < 0 ||
+	    fseek(fp, 0, SEEK_SET)) {
+		fprintf(stderr, "Can't get size of %s: %s\n", file,
+			strerror(errno));
+		fclose(fp);
+		return NULL;
+	}
+
+	buf = malloc(len + 1);
+	if (!buf || fread(buf, 1, len, fp) != len) {
+		fprintf(stderr, "Can't read %s\n", file);
+		free(buf);
+		fclose(fp);
+		return NULL;
+	}
+
+	fclose(fp);
+	*size = len;
+	return buf;
+}
+
+static int parse_input(char *arg, struct input *in)
+{
+	char *addr, *name, *end;
+
+	addr = strchr(arg, ':');
+	if (!addr)
+		return -1;
+	*addr++ = '\0';
+
+	name = strchr(addr, ':');
+	if (name)
+		*name++ = '\0';
+	else
+		name = basename(arg);
+
+	in->file = arg;
+	in->ldaddr = strtoul(addr, &end, 16);
+	if (end == addr || *end)
+		return -1;
+
+	if (strlen(name) >= PACK_NAME_MAX) {
+		fprintf(stderr, "Name %s is too long\n", name);
+		return -1;
+	}
+	strncpy(in->name, name, PACK_NAME_MAX);
+
+	return 0;
+}
+
+static int write_buf(FILE *fp, const void *buf, size_t len)
+{
+	if (len && fwrite(buf, len, 1, fp) != 1)
+		return -1;
+	return 0;
+}
+
+/* Same as calc_crc() in common/packimg.c, over zero padded data */
+static uint32_t calc_sum(const uint8_t *buf, uint32_t size)
+{
+	uint32_t sum = 0, word;
+	uint32_t i;
+
+	for (i = 0; i < size; i += 4) {
+		word = 0;
+		memcpy(&word, buf + i, size - i < 4 ? size - i : 4);
+		sum += le32_to_cpu(word);
+	}
+
+	return sum;
+}
+
+int main(int argc, char **argv)
+{
+	struct input in[MAX_PACK_ENTRY];
+	struct pack_header ph;
+	struct pack_entry pe[MAX_PACK_ENTRY];
+	const char *out_file = NULL;
+	int version = PACK_VERSION, digest = PACK_DIGEST_CRC32;
+	uint32_t align = 512, hdr_size, offset, crc;
+	uint8_t *pad;
+	sha256_context ctx;
+	FILE *fp;
+	int nentry, option, i;
+
+	while ((option = getopt(argc, argv, ":1d:a:o:h")) != -1) {
+		switch (option) {
+		case '1':
+			version = 1;
+			break;
+		case 'd':
+			if (!strcmp(optarg, "crc32")) {
+				digest = PACK_DIGEST_CRC32;
+			} else if (!strcmp(optarg, "sha256")) {
+				digest = PACK_DIGEST_SHA256;
+			} else {
+				fprintf(stderr, "Unknown digest %s\n", optarg);
+				return EXIT_FAILURE;
+			}
+			break;
+		case 'a':
+			align = strtoul(optarg, NULL, 0);
+			if (!align || (align & (align - 1)) || align < 4) {
+				fprintf(stderr, "Bad alignment %s\n", optarg);
+				return EXIT_FAILURE;
+			}
+			break;
+		case 'o':
+			out_file = optarg;
+			break;
+		case 'h':
+			usage(argv[0]);
+			return EXIT_SUCCESS;
+		case ':':
+			fprintf(stderr, "Missing argument for option -%c\n",
+				optopt);
+			usage(argv[0]);
+			return EXIT_FAILURE;
+		default:
+			fprintf(stderr, "Wrong option -%c\n", optopt);
+			usage(argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	nentry = argc - optind;
+	if (!out_file || nentry < 1 || nentry > MAX_PACK_ENTRY) {
+		usage(argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	if (version == 1)
+		hdr_size = PACK_V1_HEADER_SIZE + nentry * PACK_V1_ENTRY_SIZE;
+	else
+		hdr_size = sizeof(ph) + nentry * sizeof(pe[0]);
+	offset = (hdr_size + align - 1) & ~(align - 1);
+
+	memset(pe, 0, sizeof(pe));
+	for (i = 0; i < nentry; i++) {
+		if (parse_input(argv[optind + i], &in[i])) {
+			fprintf(stderr, "Bad entry %s\n", argv[optind + i]);
+			return EXIT_FAILURE;
+		}
+		in[i].data = read_file(in[i].file, &in[i].size);
+		if (!in[i].data)
+			return EXIT_FAILURE;
+
+		pe[i].offset = cpu_to_le32(offset);
+		pe[i].size = cpu_to_le32(in[i].size);
+		pe[i].ldaddr = cpu_to_le32(in[i].ldaddr);
+		memcpy(pe[i].name, in[i].name, PACK_NAME_MAX);
+
+		if (version == 1) {
+			pe[i].crc = cpu_to_le32(calc_sum(in[i].data,
+							 in[i].size));
+		} else if (digest == PACK_DIGEST_CRC32) {
+			crc = cpu_to_be32(crc32(0, in[i].data, in[i].size));
+			memcpy(pe[i].digest, &crc, sizeof(crc));
+		} else {
+			sha256_starts(&ctx);
+			sha256_update(&ctx, in[i].data, in[i].size);
+			sha256_finish(&ctx, pe[i].digest);
+		}
+
+		offset += (in[i].size + align - 1) & ~(align - 1);
+	}
+
+	memset(&ph, 0, sizeof(ph));
+	ph.nentry = cpu_to_le32(nentry);
+	if (version == 1) {
+		ph.magic = cpu_to_le32(PACK_MAGIC);
+		/* version 1 entries have no digest */
+		for (i = 0; i < nentry; i++)
+			memmove((uint8_t *)pe + i * PACK_V1_ENTRY_SIZE, &pe[i],
+				PACK_V1_ENTRY_SIZE);
+		ph.crc = cpu_to_le32(calc_sum((uint8_t *)pe,
+					      nentry * PACK_V1_ENTRY_SIZE));
+	} else {
+		ph.magic = cpu_to_le32(PACK_MAGIC_V2);
+		ph.version = cpu_to_le16(PACK_VERSION);
+		ph.digest = cpu_to_le16(digest);
+		crc = crc32(0, (uint8_t *)&ph, sizeof(ph));
+		crc = crc32(crc, (uint8_t *)pe, nentry * sizeof(pe[0]));
+		ph.crc = cpu_to_le32(crc);
+	}
+
+	fp = fopen(out_file, "wb");
+	if (!fp) {
+		fprintf(stderr, "Can't open %s: %s\n", out_file,
+			strerror(errno));
+		return EXIT_FAILURE;
+	}
+
+	pad = calloc(1, align);
+	if (!pad) {
+		fprintf(stderr, "Can't allocate %u bytes\n", align);
+		return EXIT_FAILURE;
+	}
+
+	/* version 1 header is 12 bytes, entries follow right after it */
+	if (write_buf(fp, &ph, version == 1 ? PACK_V1_HEADER_SIZE : sizeof(ph)) ||
+	    write_buf(fp, pe, hdr_size - (version == 1 ? PACK_V1_HEADER_SIZE :
+					  sizeof(ph))) ||
+	    write_buf(fp, pad, (-hdr_size) & (align - 1)))
+		goto write_err;
+
+	for (i = 0; i < nentry; i++) {
+		if (write_buf(fp, in[i].data, in[i].size) ||
+		    write_buf(fp, pad, (-in[i].size) & (align - 1)))
+			goto write_err;
+		free(in[i].data);
+	}
+
+	free(pad);
+	if (fclose(fp)) {
+		fprintf(stderr, "Can't close %s: %s\n", out_file,
+			strerror(errno));
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+
+write_err:
+	fprintf(stderr, "Can't write %s: %s\n", out_file, strerror(errno));
+	fclose(fp);
+	return EXIT_FAILURE;
+}